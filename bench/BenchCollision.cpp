@@ -0,0 +1,382 @@
+/**
+ * @file BenchCollision.cpp
+ *
+ * Times the collision Broadphases against each other on
+ * worlds of random boxes, their area and ray queries, and the
+ * Narrowphase at each SimdLevel, then runs the integration
+ * benchmarks. Build with `make Benchmarks` and run
+ * build/Release/Benchmarks.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <ECS/Roc_ECS.hpp>
+
+/** Defined in BenchIntegration.cpp */
+void BenchIntegration();
+
+namespace
+{
+    /** Boxes of 8-32 units scattered so each touches a few others */
+    std::vector<BroadphaseProxy> MakeWorld(std::size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        double extent = 12.0 * std::sqrt(static_cast<double>(count)) * 2.0;
+        std::uniform_real_distribution<double> position(0.0, extent);
+        std::uniform_real_distribution<double> size(8.0, 32.0);
+        std::vector<BroadphaseProxy> proxies(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            proxies[i].entity = static_cast<Entity>(i);
+            proxies[i].bounds.minX = position(rng);
+            proxies[i].bounds.minY = position(rng);
+            proxies[i].bounds.maxX = proxies[i].bounds.minX + size(rng);
+            proxies[i].bounds.maxY = proxies[i].bounds.minY + size(rng);
+        }
+        return proxies;
+    }
+
+    /** Like MakeWorld(), plus a few long walls across the whole world */
+    std::vector<BroadphaseProxy> MakeWalledWorld(std::size_t count, unsigned seed)
+    {
+        std::vector<BroadphaseProxy> proxies = MakeWorld(count, seed);
+        double extent = 12.0 * std::sqrt(static_cast<double>(count)) * 2.0;
+        for (std::size_t i = 0; i < count / 100; i++)
+        {
+            AABB& wall = proxies[i * 100].bounds;
+            bool horizontal = i % 2 == 0;
+            wall.minX = horizontal ? 0.0 : wall.minX;
+            wall.maxX = horizontal ? extent : wall.minX + 16.0;
+            wall.minY = horizontal ? wall.minY : 0.0;
+            wall.maxY = horizontal ? wall.minY + 16.0 : extent;
+        }
+        return proxies;
+    }
+
+    /** Moves every collider a little, the way most objects move from one frame to the next */
+    void Drift(std::vector<BroadphaseProxy>& proxies, int frame)
+    {
+        for (std::size_t i = 0; i < proxies.size(); i++)
+        {
+            double dx = ((i + frame) % 7 == 0) ? 3.0 : 0.5;
+            double dy = (i % 2 == 0) ? 0.25 : -0.25;
+            proxies[i].bounds = {proxies[i].bounds.minX + dx, proxies[i].bounds.minY + dy,
+                proxies[i].bounds.maxX + dx, proxies[i].bounds.maxY + dy};
+        }
+    }
+
+    /**
+     * Runs Update() + FindPairs() `frames` times and prints the
+     * mean time per frame. With `drift`, the colliders move
+     * between frames (outside the timing).
+    */
+    void Time(const char* name, Broadphase& broadphase, std::vector<BroadphaseProxy> proxies, int frames, bool drift = false)
+    {
+        std::vector<BroadphasePair> pairs;
+        std::size_t hits = 0;
+        std::chrono::steady_clock::duration total{0};
+        for (int frame = 0; frame < frames; frame++)
+        {
+            if (drift)
+            {
+                Drift(proxies, frame);
+            }
+            auto start = std::chrono::steady_clock::now();
+            pairs.clear();
+            broadphase.Update(proxies);
+            broadphase.FindPairs(pairs);
+            hits = 0;
+            for (const BroadphasePair& pair : pairs)
+            {
+                hits += proxies[pair.first].bounds.Overlaps(proxies[pair.second].bounds);
+            }
+            total += std::chrono::steady_clock::now() - start;
+        }
+        double ms = std::chrono::duration<double, std::milli>(total).count() / frames;
+        std::printf("  %-17s %9.3f ms/frame  %8zu candidates  %7zu overlaps\n", name, ms, pairs.size(), hits);
+    }
+
+    /**
+     * Like Time(), but only `proxies` goes through the Broadphase,
+     * and each one looks up the `statics` it hits in a StaticIndex
+     * built once up front.
+    */
+    void TimeWithStatics(const char* name, Broadphase& broadphase, std::vector<BroadphaseProxy> proxies,
+        const std::vector<BroadphaseProxy>& statics, int frames)
+    {
+        StaticIndex index;
+        index.Build(statics);
+        std::vector<BroadphasePair> pairs;
+        std::chrono::steady_clock::duration total{0};
+        for (int frame = 0; frame < frames; frame++)
+        {
+            Drift(proxies, frame);
+            auto start = std::chrono::steady_clock::now();
+            pairs.clear();
+            broadphase.Update(proxies);
+            broadphase.FindPairs(pairs);
+            std::uint32_t moving = static_cast<std::uint32_t>(proxies.size());
+            for (std::uint32_t i = 0; i < moving; i++)
+            {
+                index.Query(proxies[i].bounds, proxies[i].filter,
+                    [&](std::uint32_t s) { pairs.push_back({i, moving + s}); });
+            }
+            total += std::chrono::steady_clock::now() - start;
+        }
+        double ms = std::chrono::duration<double, std::milli>(total).count() / frames;
+        std::printf("  %-17s %9.3f ms/frame  %8zu candidates\n", name, ms, pairs.size());
+    }
+
+    /**
+     * Updates the Broadphase once, then times looking up the
+     * colliders overlapping each of `boxes` and crossing each of
+     * `rays`, printing the mean time per lookup.
+    */
+    void TimeQueries(const char* name, Broadphase& broadphase, const std::vector<BroadphaseProxy>& proxies,
+        const std::vector<AABB>& boxes, const std::vector<Ray>& rays)
+    {
+        broadphase.Update(proxies);
+        std::vector<std::uint32_t> found;
+        std::size_t overlaps = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const AABB& box : boxes)
+        {
+            found.clear();
+            broadphase.Query(box, CollisionFilter(), found);
+            for (std::uint32_t proxy : found)
+            {
+                overlaps += proxies[proxy].bounds.Overlaps(box);
+            }
+        }
+        double boxUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / boxes.size();
+
+        std::size_t crossed = 0;
+        start = std::chrono::steady_clock::now();
+        for (const Ray& ray : rays)
+        {
+            found.clear();
+            broadphase.QueryRay(ray, CollisionFilter(), found);
+            for (std::uint32_t proxy : found)
+            {
+                double distance;
+                int axis;
+                crossed += RayHitsBox(ray, proxies[proxy].bounds, distance, axis);
+            }
+        }
+        double rayUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / rays.size();
+        std::printf("  %-17s %9.3f us/box %6zu overlaps  %9.3f us/ray %6zu crossings\n",
+            name, boxUs, overlaps, rayUs, crossed);
+    }
+
+    /**
+     * Times the pair search and the exact tests split across a
+     * ThreadPool of `workers` threads, as the CollisionSystem
+     * runs them.
+    */
+    void TimeParallel(std::size_t workers, const std::vector<BroadphaseProxy>& proxies, int frames)
+    {
+        ThreadPool pool(workers);
+        SpatialHashBroadphase hash(32.0);
+        Narrowphase narrowphase;
+        std::vector<BroadphasePair> pairs;
+        std::vector<Contact> contacts;
+        std::vector<std::vector<Contact>> buffers;
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            pairs.clear();
+            contacts.clear();
+            hash.Update(proxies);
+            hash.ParallelFindPairs(pool, pairs);
+            std::sort(pairs.begin(), pairs.end());
+            narrowphase.SetBounds(proxies);
+            ParallelCollect(pool, pairs.size(), CollisionSystem::PAIRS_PER_TASK, buffers, contacts,
+                [&](std::size_t begin, std::size_t end, std::vector<Contact>& found)
+                {
+                    std::vector<std::uint32_t> scratch;
+                    narrowphase.Run(pairs, begin, end, found, scratch);
+                });
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+        std::printf("  %zu workers         %9.3f ms/frame  %8zu candidates  %7zu overlaps\n",
+            workers, ms, pairs.size(), contacts.size());
+    }
+
+    /** Runs the Narrowphase over the same candidate pairs `frames` times at one SimdLevel */
+    void TimeNarrowphase(const char* name, SimdLevel level, const std::vector<BroadphaseProxy>& proxies,
+        const std::vector<BroadphasePair>& pairs, int frames)
+    {
+        Narrowphase narrowphase;
+        narrowphase.SetSimdLevel(level);
+        std::vector<Contact> contacts;
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            contacts.clear();
+            narrowphase.SetBounds(proxies);
+            narrowphase.Run(pairs, contacts);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+        std::printf("  %-17s %9.3f ms/frame  %8zu candidates  %7zu overlaps\n", name, ms, pairs.size(), contacts.size());
+    }
+}
+
+int main()
+{
+    for (std::size_t count : {1000, 5000, 20000})
+    {
+        std::vector<BroadphaseProxy> proxies = MakeWorld(count, 42);
+        int frames = count > 5000 ? 5 : 20;
+        std::printf("%zu colliders\n", count);
+
+        BruteForceBroadphase brute;
+        Time("brute force", brute, proxies, count > 5000 ? 1 : frames);
+
+        SpatialHashBroadphase hash(32.0);
+        Time("spatial hash", hash, proxies, frames);
+
+        // The first frame builds the tree; the rest find the scene unchanged
+        AABBTreeBroadphase tree;
+        Time("tree (build)", tree, proxies, 1);
+        Time("tree (static)", tree, proxies, frames);
+
+        // A tenth of the colliders jump further than the tree's margin
+        for (std::size_t i = 0; i < count; i += 10)
+        {
+            proxies[i].bounds.minX += 10.0;
+            proxies[i].bounds.maxX += 10.0;
+        }
+        Time("tree (10% moved)", tree, proxies, 1);
+
+        // Everything drifting a little each frame
+        std::printf("%zu colliders, all moving\n", count);
+        Time("spatial hash", hash, proxies, frames, true);
+        Time("tree", tree, proxies, frames, true);
+        SweepAndPruneBroadphase sap;
+        Time("sap (build)", sap, proxies, 1);
+        Time("sap", sap, proxies, frames, true);
+    }
+
+    // A side-scroller's level: a long strip a few screens high
+    std::size_t count = 20000;
+    std::vector<BroadphaseProxy> strip = MakeWorld(count, 42);
+    for (BroadphaseProxy& proxy : strip)
+    {
+        double width = proxy.bounds.maxX - proxy.bounds.minX;
+        double height = proxy.bounds.maxY - proxy.bounds.minY;
+        proxy.bounds.minX *= 25.0;
+        proxy.bounds.maxX = proxy.bounds.minX + width;
+        proxy.bounds.minY /= 25.0;
+        proxy.bounds.maxY = proxy.bounds.minY + height;
+    }
+    std::printf("%zu colliders along a strip, all moving\n", count);
+    SpatialHashBroadphase stripHash(32.0);
+    Time("spatial hash", stripHash, strip, 5, true);
+    SweepAndPruneBroadphase stripSap;
+    Time("sap (build)", stripSap, strip, 1);
+    Time("sap", stripSap, strip, 5, true);
+    SweepAndPruneBroadphase stripSapX(SweepAxes::X);
+    Time("sap (build, x)", stripSapX, strip, 1);
+    Time("sap (x)", stripSapX, strip, 5, true);
+
+
+    std::vector<BroadphaseProxy> walled = MakeWalledWorld(count, 42);
+    std::printf("%zu colliders, %zu of them walls across the world\n", count, count / 100);
+    SpatialHashBroadphase hash(32.0);
+    Time("spatial hash", hash, walled, 5);
+    AABBTreeBroadphase tree;
+    Time("tree (build)", tree, walled, 1);
+    Time("tree (static)", tree, walled, 5);
+
+    // Bullets and walls: neither collides with its own kind, only with the other
+    std::vector<BroadphaseProxy> layered = MakeWorld(count, 42);
+    std::printf("%zu colliders, unfiltered\n", count);
+    SpatialHashBroadphase unfilteredHash(32.0);
+    Time("spatial hash", unfilteredHash, layered, 5);
+    SweepAndPruneBroadphase unfilteredSap;
+    Time("sap", unfilteredSap, layered, 5);
+    for (std::size_t i = 0; i < layered.size(); i++)
+    {
+        layered[i].filter.layers = i % 2 == 0 ? 1u : 2u;
+        layered[i].filter.mask = i % 2 == 0 ? 2u : 1u;
+    }
+    std::printf("%zu colliders, half bullets, half walls\n", count);
+    SpatialHashBroadphase layeredHash(32.0);
+    Time("spatial hash", layeredHash, layered, 5);
+    AABBTreeBroadphase layeredTree;
+    Time("tree (build)", layeredTree, layered, 1);
+    SweepAndPruneBroadphase layeredSap;
+    Time("sap", layeredSap, layered, 5);
+
+    // A large level that stands still, with a few hundred things moving through it
+    std::vector<BroadphaseProxy> level = MakeWorld(count, 42);
+    std::vector<BroadphaseProxy> movers(level.end() - 500, level.end());
+    level.resize(count - 500);
+    std::printf("%zu colliders, %zu of them moving\n", count, movers.size());
+    std::vector<BroadphaseProxy> everything = level;
+    everything.insert(everything.end(), movers.begin(), movers.end());
+    SpatialHashBroadphase allHash(32.0);
+    Time("hash (all)", allHash, everything, 5, true);
+    SpatialHashBroadphase movingHash(32.0);
+    TimeWithStatics("hash + static", movingHash, movers, level, 5);
+    auto buildStart = std::chrono::steady_clock::now();
+    StaticIndex levelIndex;
+    levelIndex.Build(level);
+    std::printf("  %-17s %9.3f ms, once\n", "static build",
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count());
+
+    std::vector<BroadphaseProxy> world = MakeWorld(count, 42);
+
+    // Screen-sized areas and line-of-sight rays of a few hundred units
+    std::vector<AABB> areas;
+    std::vector<Ray> sights;
+    std::mt19937 rng(7);
+    double extent = 12.0 * std::sqrt(static_cast<double>(count)) * 2.0;
+    std::uniform_real_distribution<double> position(0.0, extent);
+    std::uniform_real_distribution<double> angle(0.0, 6.283);
+    for (int i = 0; i < 1000; i++)
+    {
+        double x = position(rng);
+        double y = position(rng);
+        double a = angle(rng);
+        areas.push_back({x, y, x + 64.0, y + 64.0});
+        sights.push_back({x, y, std::cos(a), std::sin(a), 300.0});
+    }
+    std::printf("%zu colliders, %zu area and ray queries\n", count, areas.size());
+    BruteForceBroadphase queryBrute;
+    TimeQueries("brute force", queryBrute, world, areas, sights);
+    SpatialHashBroadphase queryHash(32.0);
+    TimeQueries("spatial hash", queryHash, world, areas, sights);
+    AABBTreeBroadphase queryTree;
+    TimeQueries("tree", queryTree, world, areas, sights);
+    SweepAndPruneBroadphase querySap;
+    TimeQueries("sap", querySap, world, areas, sights);
+
+    // Coarse cells hand the narrowphase plenty of candidates to reject
+    SpatialHashBroadphase coarse(256.0);
+    std::vector<BroadphasePair> candidates;
+    coarse.Update(world);
+    coarse.FindPairs(candidates);
+    std::sort(candidates.begin(), candidates.end());
+    std::printf("%zu colliders, hash and narrowphase on %u hardware threads\n", count, std::thread::hardware_concurrency());
+    for (std::size_t workers : {0, 1, 3, 7})
+    {
+        TimeParallel(workers, world, 10);
+    }
+
+    std::printf("%zu colliders, narrowphase only\n", count);
+    TimeNarrowphase("scalar", SimdLevel::Scalar, world, candidates, 20);
+    TimeNarrowphase("sse2", SimdLevel::SSE2, world, candidates, 20);
+    TimeNarrowphase("avx2", SimdLevel::AVX2, world, candidates, 20);
+
+    BenchIntegration();
+    return 0;
+}
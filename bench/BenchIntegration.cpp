@@ -0,0 +1,73 @@
+/**
+ * @file BenchIntegration.cpp
+ *
+ * Times the IntegrationSystem's batch kernels on packed arrays
+ * of bodies, and a step through the Coordinator against the
+ * usual GetComponent() loop. Run from main() in BenchCollision.cpp.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <ECS/Roc_ECS.hpp>
+
+namespace
+{
+    /** Runs `step` `steps` times and prints the mean time per step. */
+    template<typename F>
+    void TimeSteps(const char* name, std::size_t bodies, int steps, F&& step)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < steps; i++)
+        {
+            step();
+        }
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / steps;
+        std::printf("  %-17s %9.3f us/step  %8zu bodies\n", name, us, bodies);
+    }
+}
+
+void BenchIntegration()
+{
+    // Packed arrays, as the archetype tables hand them to the kernels
+    std::size_t count = 50000;
+    std::vector<Transform> transforms(count);
+    std::vector<Velocity> velocities(count);
+    std::vector<Gravity> gravities(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        velocities[i].x = 0.01 * (i % 100);
+    }
+    std::printf("%zu bodies, integration kernels\n", count);
+    const double dt = IntegrationSystem::DEFAULT_TIMESTEP;
+    TimeSteps("gravity + move", count, 200, [&]()
+    {
+        IntegrationSystem::ApplyGravity(velocities.data(), gravities.data(), count, dt);
+        IntegrationSystem::ApplyVelocity(transforms.data(), velocities.data(), count, dt);
+    });
+
+    // Through the Coordinator, which holds at most MAX_ENTITIES
+    Coordinator* c = Coordinator::Get();
+    c->Init();
+    c->RegisterComponent<Transform>();
+    c->RegisterComponent<Velocity>();
+    c->RegisterComponent<Gravity>();
+    auto system = c->RegisterSystem<IntegrationSystem>();
+    c->SetSystemSignature<IntegrationSystem>(system->GetSignature());
+    std::size_t entities = c->CreateEntities(MAX_ENTITIES - 1, Transform(), Velocity(), Gravity()).size();
+    std::printf("%zu bodies, through the Coordinator\n", entities);
+    TimeSteps("IntegrationSystem", entities, 200, [&]() { system->Step(); });
+    TimeSteps("GetComponent loop", entities, 200, [&]()
+    {
+        for (Entity e : system->mEntities)
+        {
+            Transform& t = c->GetComponent<Transform>(e);
+            Velocity& v = c->GetComponent<Velocity>(e);
+            v.y -= c->GetComponent<Gravity>(e).gravity * dt;
+            t.x += v.x * dt;
+            t.y += v.y * dt;
+        }
+    });
+    Coordinator::DeleteCoordinator();
+}
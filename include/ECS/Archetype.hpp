@@ -0,0 +1,217 @@
+#ifndef _ROC_ARCHETYPE_H_
+#define _ROC_ARCHETYPE_H_
+
+/**
+ * @file Archetype.hpp
+ * 
+ * This file defines the Archetype class, the table type
+ * used by the ArchetypeManager storage backend, along with
+ * the ComponentInfo it needs to handle Components as raw
+ * bytes.
+*/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "Entity.hpp"
+#include "Component.hpp"
+
+/**
+ * @struct ComponentInfo
+ * 
+ * Everything an Archetype needs to know to store a
+ * Component subclass in an untyped column.
+*/
+struct ComponentInfo
+{
+	/** sizeof() the subclass, or 0 if the subclass isn't registered. */
+	std::size_t size = 0;
+
+	/** alignof() the subclass. */
+	std::size_t align = 0;
+
+	/** Move-constructs an instance at `dst` out of the instance at `src`. */
+	void (*moveConstruct)(void* dst, void* src) = nullptr;
+
+	/** Calls the destructor of the instance at `object`. */
+	void (*destroy)(void* object) = nullptr;
+
+	/** Calls the destructor of `count` consecutive instances starting at `first`. */
+	void (*destroyRange)(void* first, std::size_t count) = nullptr;
+
+	/**
+	 * @tparam T The subclass of Component to describe.
+	 * @returns The ComponentInfo of T.
+	*/
+	template<typename T>
+	static ComponentInfo Of()
+	{
+		ComponentInfo info;
+		info.size = sizeof(T);
+		info.align = alignof(T);
+		info.moveConstruct = [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); };
+		info.destroy = [](void* object) { static_cast<T*>(object)->~T(); };
+		info.destroyRange = [](void* first, std::size_t count) { std::destroy_n(static_cast<T*>(first), count); };
+		return info;
+	}
+};
+
+/**
+ * @class Archetype
+ * 
+ * A table holding every Entity with one exact Signature.
+ * Rows are stored in fixed-size chunks; inside a chunk each
+ * Component type (and the Entity IDs) gets its own column,
+ * so iterating a set of Components touches a few contiguous
+ * arrays per chunk no matter how many types the table has.
+ * 
+ * Rows stay dense: removing a row moves the last row into
+ * its place.
+*/
+class Archetype
+{
+public:
+	/** The target size of a chunk, in bytes. */
+	static constexpr std::size_t CHUNK_BYTES = 16 * 1024;
+
+	/** The alignment of every column inside a chunk. */
+	static constexpr std::size_t COLUMN_ALIGN = 64;
+
+	/**
+	 * Creates an empty table.
+	 * 
+	 * @param signature The Signature of every Entity in the table.
+	 * @param infos The ComponentInfo of every registered type,
+	 * indexed by ComponentType.
+	*/
+	Archetype(Signature signature, const std::vector<ComponentInfo>& infos);
+	~Archetype();
+
+	Archetype(const Archetype&) = delete;
+	Archetype& operator=(const Archetype&) = delete;
+
+	const Signature& GetSignature() const { return mSignature; }
+
+	/** @returns True if the table has a column for the type. */
+	bool Has(ComponentType type) const { return mColumnOf[type] != NO_COLUMN; }
+
+	/** @returns The number of rows in the table. */
+	std::size_t Size() const { return mSize; }
+
+	/** @returns The number of rows a chunk can hold. */
+	std::size_t ChunkCapacity() const { return mChunkCapacity; }
+
+	/** @returns The number of chunks holding at least one row. */
+	std::size_t ChunkCount() const { return (mSize + mChunkCapacity - 1) / mChunkCapacity; }
+
+	/** @returns The number of rows in a chunk. */
+	std::size_t RowsInChunk(std::size_t chunk) const
+	{
+		std::size_t start = chunk * mChunkCapacity;
+		return mSize - start < mChunkCapacity ? mSize - start : mChunkCapacity;
+	}
+
+	/** @returns The Entity column of a chunk. */
+	Entity* Entities(std::size_t chunk)
+	{
+		return reinterpret_cast<Entity*>(mChunks[chunk].get());
+	}
+
+	/** @returns The start of a Component column in a chunk. The table must have the type. */
+	void* Column(std::size_t chunk, ComponentType type)
+	{
+		return reinterpret_cast<unsigned char*>(mChunks[chunk].get()) + mColumns[mColumnOf[type]].offset;
+	}
+
+	/** @returns The Component of a type in a row. The table must have the type. */
+	void* Get(std::size_t row, ComponentType type)
+	{
+		const ColumnInfo& column = mColumns[mColumnOf[type]];
+		return reinterpret_cast<unsigned char*>(mChunks[row / mChunkCapacity].get())
+			+ column.offset + (row % mChunkCapacity) * column.info->size;
+	}
+
+	/** @returns The Entity stored in a row. */
+	Entity EntityAt(std::size_t row)
+	{
+		return Entities(row / mChunkCapacity)[row % mChunkCapacity];
+	}
+
+	/**
+	 * Appends a row for an Entity. The Components of the row are
+	 * left unconstructed - the caller has to construct every one.
+	 * 
+	 * @returns The index of the new row.
+	*/
+	std::size_t AllocateRow(Entity entity);
+
+	/**
+	 * Destroys the Components of a row, then moves the last row
+	 * into it to keep the table dense.
+	 * 
+	 * @returns The Entity that now occupies `row`, or
+	 * MAX_ENTITIES if `row` was the last row.
+	*/
+	Entity RemoveRow(std::size_t row);
+
+	/**
+	 * Moves a row into another table: Components both tables
+	 * have are moved over, the rest are destroyed, and the row
+	 * is removed from this table. Components only `destination`
+	 * has are left unconstructed.
+	 * 
+	 * @param row The row to move.
+	 * @param destination The table to move the row to.
+	 * @param moved Set to the Entity that now occupies `row` in
+	 * this table, or MAX_ENTITIES if there is none.
+	 * 
+	 * @returns The row of the Entity in `destination`.
+	*/
+	std::size_t MoveRow(std::size_t row, Archetype& destination, Entity& moved);
+
+	/** Destroys every row, keeping the allocated chunks. */
+	void Clear();
+
+	/** Cached neighbor tables, indexed by the ComponentType added. */
+	std::vector<Archetype*> mAddEdges;
+
+	/** Cached neighbor tables, indexed by the ComponentType removed. */
+	std::vector<Archetype*> mRemoveEdges;
+
+private:
+	static constexpr std::int16_t NO_COLUMN = -1;
+
+	struct ColumnInfo
+	{
+		ComponentType type;
+		std::size_t offset;
+		const ComponentInfo* info;
+	};
+
+	struct alignas(COLUMN_ALIGN) Block
+	{
+		unsigned char bytes[COLUMN_ALIGN];
+	};
+
+	void DestroyRow(std::size_t row);
+
+	Signature mSignature;
+
+	/** The Component columns, in ComponentType order. */
+	std::vector<ColumnInfo> mColumns;
+
+	/** Map from ComponentType to an index in mColumns. */
+	std::array<std::int16_t, MAX_COMPONENTS> mColumnOf;
+
+	std::size_t mChunkCapacity = 0;
+	std::size_t mChunkBlocks = 0;
+	std::size_t mSize = 0;
+	std::vector<std::unique_ptr<Block[]>> mChunks;
+};
+
+#endif
@@ -0,0 +1,617 @@
+#ifndef _ROC_ARCHETYPE_MANAGER_H_
+#define _ROC_ARCHETYPE_MANAGER_H_
+
+/**
+ * @file ArchetypeManager.hpp
+ * 
+ * This file defines the ArchetypeManager class, an
+ * alternative component storage backend that groups
+ * Entities by Signature, and the ArchetypeView used to
+ * iterate it.
+ * 
+ * The Coordinator uses it in place of the ComponentManager
+ * when ROCKET_ARCHETYPE_STORAGE is defined (premake's
+ * `--archetype-storage` option).
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+#include "Archetype.hpp"
+#include "ComponentRegistry.hpp"
+#include "EntitySet.hpp"
+#include "ThreadPool.hpp"
+
+
+/**
+ * @class ArchetypeView
+ * 
+ * The ArchetypeManager's counterpart of ComponentView. It
+ * visits every table whose Signature contains all of Ts, and
+ * walks each chunk's columns side by side.
+ * 
+ * @note Adding or removing Components (or destroying Entities)
+ * while iterating is not supported.
+ * 
+ * @tparam Ts The subclasses of Component to view.
+*/
+template<typename... Ts>
+class ArchetypeView
+{
+public:
+	/**
+	 * @param archetypes Every table of the ArchetypeManager.
+	 * @param mask The Signature bits of the viewed Components.
+	 * @param valid False if any of Ts isn't registered.
+	*/
+	ArchetypeView(const std::vector<std::unique_ptr<Archetype>>* archetypes, Signature mask, bool valid)
+		: mArchetypes(archetypes), mMask(mask), mValid(valid) {}
+
+	/** @copydoc ComponentView::ForEach() */
+	template<typename F>
+	void ForEach(F&& func)
+	{
+		ForEachChunk([&func](std::size_t rows, const Entity* entities, Ts*... columns)
+		{
+			for (std::size_t row = 0; row < rows; row++)
+			{
+				func(entities[row], columns[row]...);
+			}
+		});
+	}
+
+	/**
+	 * @copydoc ComponentView::ParallelForEach()
+	 * 
+	 * Each table chunk is split on its own, so a task never
+	 * spans two chunks.
+	*/
+	template<typename F>
+	void ParallelForEach(ThreadPool& pool, F&& func, std::size_t grain = DEFAULT_GRAIN_SIZE)
+	{
+		if (!mValid)
+		{
+			return;
+		}
+
+		struct Range
+		{
+			Archetype* archetype;
+			std::size_t chunk;
+			std::size_t begin;
+			std::size_t end;
+		};
+
+		std::size_t rowsPerRange = AlignGrain(grain, CacheLineElements<Entity, Ts...>());
+		std::vector<Range> ranges;
+		for (const auto& archetype : *mArchetypes)
+		{
+			if ((archetype->GetSignature() & mMask) != mMask)
+			{
+				continue;
+			}
+
+			for (std::size_t chunk = 0; chunk < archetype->ChunkCount(); chunk++)
+			{
+				std::size_t rows = archetype->RowsInChunk(chunk);
+				for (std::size_t begin = 0; begin < rows; begin += rowsPerRange)
+				{
+					ranges.push_back({archetype.get(), chunk, begin, std::min(begin + rowsPerRange, rows)});
+				}
+			}
+		}
+
+		ParallelFor(pool, ranges.size(), 1, [&](std::size_t first, std::size_t last)
+		{
+			for (std::size_t i = first; i < last; i++)
+			{
+				const Range& range = ranges[i];
+				const Entity* entities = range.archetype->Entities(range.chunk);
+				std::tuple<Ts*...> columns(static_cast<Ts*>(range.archetype->Column(range.chunk, ComponentFamily<Ts>()))...);
+				for (std::size_t row = range.begin; row < range.end; row++)
+				{
+					func(entities[row], std::get<Ts*>(columns)[row]...);
+				}
+			}
+		});
+	}
+
+	/**
+	 * Calls `func(rows, entities, columns...)` once per chunk
+	 * holding matching Entities, with a pointer to the start of
+	 * each column, for code that wants to process whole columns.
+	 * 
+	 * @param func A callable taking the number of rows, the
+	 * Entity column, and a pointer to each column of Ts.
+	*/
+	template<typename F>
+	void ForEachChunk(F&& func)
+	{
+		if (!mValid)
+		{
+			return;
+		}
+
+		for (const auto& archetype : *mArchetypes)
+		{
+			if ((archetype->GetSignature() & mMask) != mMask)
+			{
+				continue;
+			}
+
+			for (std::size_t chunk = 0; chunk < archetype->ChunkCount(); chunk++)
+			{
+				func(archetype->RowsInChunk(chunk), archetype->Entities(chunk),
+					static_cast<Ts*>(archetype->Column(chunk, ComponentFamily<Ts>()))...);
+			}
+		}
+	}
+
+	/** @returns The number of Entities in the view. */
+	std::size_t SizeHint() const
+	{
+		std::size_t size = 0;
+		if (mValid)
+		{
+			for (const auto& archetype : *mArchetypes)
+			{
+				if ((archetype->GetSignature() & mMask) == mMask)
+				{
+					size += archetype->Size();
+				}
+			}
+		}
+		return size;
+	}
+
+private:
+	const std::vector<std::unique_ptr<Archetype>>* mArchetypes;
+	Signature mMask;
+	bool mValid;
+};
+
+
+/**
+ * @class ArchetypeManager
+ * 
+ * A component storage backend with the same interface as the
+ * ComponentManager, but which stores Components in Archetype
+ * tables: every Entity lives in the table of its Signature,
+ * and adding or removing a Component moves it to the table
+ * of its new Signature. Entities with no Components live in
+ * no table.
+*/
+class ArchetypeManager : public ComponentRegistry
+{
+public:
+	using ComponentRegistry::GetComponentType;
+
+	/** @copydoc ComponentManager::AddComponent(Entity) */
+	template<typename T>
+	bool AddComponent(Entity entity)
+	{
+		if (!IsRegistered(ComponentFamily<T>()))
+		{
+			SPDLOG_WARN("Couldn't get an Archetype column for {}", T::name());
+			return false;
+		}
+		return Insert<T>(entity, T());
+	}
+
+	/** @copydoc ComponentManager::AddComponent(Entity, T) */
+	template<typename T>
+	bool AddComponent(Entity entity, T component)
+	{
+		if (!IsRegistered(ComponentFamily<T>()))
+		{
+			throw std::runtime_error("Attempted to add an unregistered Component!");
+		}
+		return Insert<T>(entity, std::move(component));
+	}
+
+	/**
+	 * @copydoc ComponentManager::AddComponents()
+	 * 
+	 * Entities without Components yet go straight into the table
+	 * of the full batch Signature, with no moves in between.
+	*/
+	template<typename... Ts>
+	bool AddComponents(const Entity* entities, std::size_t count, const Ts&... prototypes)
+	{
+		if (!(IsRegistered(ComponentFamily<Ts>()) && ...))
+		{
+			throw std::runtime_error("Attempted to add an unregistered Component!");
+		}
+		if constexpr (sizeof...(Ts) == 0)
+		{
+			return true;
+		}
+		else
+		{
+			Signature signature;
+			(signature.set(ComponentFamily<Ts>()), ...);
+			Archetype* destination = FindOrCreate(signature);
+
+			bool added = true;
+			for (std::size_t i = 0; i < count; i++)
+			{
+				Entity entity = entities[i];
+				std::uint32_t index = EntityIndex(entity);
+				if (index >= mRecords.size())
+				{
+					mRecords.resize(index + 1);
+				}
+
+				EntityRecord& record = mRecords[index];
+				if (record.archetype != nullptr)
+				{
+					// Already stored somewhere, so take the one-at-a-time path
+					added = (Insert<Ts>(entity, prototypes) && ...) && added;
+					continue;
+				}
+
+				record.entity = entity;
+				record.archetype = destination;
+				record.row = destination->AllocateRow(entity);
+				(new (destination->Get(record.row, ComponentFamily<Ts>())) Ts(prototypes), ...);
+			}
+			return added;
+		}
+	}
+
+	/** @copydoc ComponentManager::RegisterComponent() */
+	template<typename T>
+	bool RegisterComponent()
+	{
+		ComponentType type = ComponentFamily<T>();
+
+		if (type >= MAX_COMPONENTS)
+		{
+			SPDLOG_ERROR("Attempting to register more than MAX_COMPONENTS ComponentTypes.");
+			return false;
+		}
+
+		if (alignof(T) > Archetype::COLUMN_ALIGN)
+		{
+			SPDLOG_ERROR("Component {} is aligned past what an Archetype column supports.", T::name());
+			return false;
+		}
+
+		// Tables keep pointers into mInfos, so it never grows past this
+		if (mInfos.empty())
+		{
+			mInfos.resize(MAX_COMPONENTS);
+		}
+
+		if (!RegisterComponentName(T::name(), type,
+			[=](Entity e){ return this->AddComponent<T>(e); },
+			[=](Entity e){ return (Component*)&this->GetComponent<T>(e); },
+			&T::Properties()))
+		{
+			return false;
+		}
+
+		mInfos[type] = ComponentInfo::Of<T>();
+		return true;
+	}
+
+	/** @copydoc ComponentManager::GetComponentType() */
+	template<typename T>
+	ComponentType GetComponentType()
+	{
+		ComponentType type = ComponentFamily<T>();
+
+		if (!IsRegistered(type))
+		{
+			SPDLOG_ERROR("Attempted to access ComponentType before registering.");
+			return MAX_COMPONENTS;
+		}
+		return type;
+	}
+
+	/** @copydoc ComponentManager::RemoveComponent() */
+	template<typename T>
+	bool RemoveComponent(Entity entity)
+	{
+		ComponentType type = ComponentFamily<T>();
+		if (!IsRegistered(type))
+		{
+			throw std::runtime_error("Attempted to remove an unregistered Component!");
+		}
+
+		EntityRecord* record = Find(entity);
+		if (record == nullptr || !record->archetype->Has(type))
+		{
+			SPDLOG_ERROR("Could not find the entity in any Archetype with the Component.");
+			return false;
+		}
+
+		Archetype* destination = RemoveEdge(record->archetype, type);
+		MoveEntity(entity, *record, destination);
+		return true;
+	}
+
+	/** @copydoc ComponentManager::GetComponent() */
+	template<typename T>
+	T& GetComponent(Entity entity)
+	{
+		ComponentType type = ComponentFamily<T>();
+		if (!IsRegistered(type))
+		{
+			throw std::runtime_error("Attempted to get data from a Component that hasn't been registered!");
+		}
+
+		EntityRecord* record = Find(entity);
+		if (record == nullptr || !record->archetype->Has(type))
+		{
+			SPDLOG_ERROR("Cannot find entity in any Archetype with the Component.");
+			throw std::runtime_error("Attempted to get data from an entity that does not exist.");
+		}
+		return *static_cast<T*>(record->archetype->Get(record->row, type));
+	}
+
+	/**
+	 * Orders a set of Entities by where they are stored (table
+	 * by table, row by row), so iterating the set walks memory
+	 * front to back.
+	 * 
+	 * @tparam T Unused by this backend, since an Entity's
+	 * Components all share one row.
+	 * @param entities The set to reorder.
+	 * 
+	 * @returns False if T hasn't been registered, true otherwise.
+	*/
+	template<typename T>
+	bool SortByComponent(EntitySet& entities)
+	{
+		if (!IsRegistered(ComponentFamily<T>()))
+		{
+			return false;
+		}
+
+		std::unordered_map<const Archetype*, std::size_t> order;
+		for (std::size_t i = 0; i < mArchetypes.size(); i++)
+		{
+			order[mArchetypes[i].get()] = i;
+		}
+
+		entities.SortByKey([&](Entity e)
+		{
+			EntityRecord* record = Find(e);
+			return record == nullptr
+				? std::make_pair(SIZE_MAX, SIZE_MAX)
+				: std::make_pair(order[record->archetype], record->row);
+		});
+		return true;
+	}
+
+	/**
+	 * Creates an ArchetypeView over every Entity that owns all
+	 * of the Components in Ts.
+	 * 
+	 * @tparam Ts The subclasses of Component to view.
+	 * @param signatures Unused by this backend; the tables
+	 * already know their Signature.
+	 * 
+	 * @returns The view, which is empty if any of Ts isn't registered.
+	*/
+	template<typename... Ts>
+	ArchetypeView<Ts...> View(const Signature* signatures)
+	{
+		(void)signatures;
+		bool valid = (IsRegistered(ComponentFamily<Ts>()) && ...);
+
+		Signature mask;
+		(mask.set(ComponentFamily<Ts>() % MAX_COMPONENTS), ...);
+		return ArchetypeView<Ts...>(&mArchetypes, mask, valid);
+	}
+
+	/** @copydoc ComponentManager::TryGetComponent() */
+	template<typename T>
+	T* TryGetComponent(Entity entity)
+	{
+		ComponentType type = ComponentFamily<T>();
+		EntityRecord* record = Find(entity);
+		if (!IsRegistered(type) || record == nullptr || !record->archetype->Has(type))
+		{
+			return nullptr;
+		}
+		return static_cast<T*>(record->archetype->Get(record->row, type));
+	}
+
+	/** @copydoc ComponentManager::EntityDestroyed() */
+	void EntityDestroyed(Entity entity)
+	{
+		EntityRecord* record = Find(entity);
+		if (record != nullptr)
+		{
+			MoveEntity(entity, *record, nullptr);
+		}
+	}
+
+	/** @copydoc ComponentManager::EntitiesDestroyed() */
+	void EntitiesDestroyed(const Entity* entities, std::size_t count)
+	{
+		for (std::size_t i = 0; i < count; i++)
+		{
+			EntityDestroyed(entities[i]);
+		}
+	}
+
+	/** @copydoc ComponentManager::Clear() */
+	void Clear()
+	{
+		// Tables and their edges are kept, so refilling doesn't allocate
+		for (auto const& archetype : mArchetypes)
+		{
+			archetype->Clear();
+		}
+		mRecords.clear();
+	}
+
+private:
+	struct EntityRecord
+	{
+		/** The table the Entity lives in, or nullptr if it has no Components. */
+		Archetype* archetype = nullptr;
+		std::size_t row = 0;
+		/** The full handle stored here, to tell stale handles apart. */
+		Entity entity = MAX_ENTITIES;
+	};
+
+	bool IsRegistered(ComponentType type) const
+	{
+		return type < mInfos.size() && mInfos[type].size != 0;
+	}
+
+	/** @returns The record of an Entity living in a table, or nullptr. */
+	EntityRecord* Find(Entity entity)
+	{
+		std::uint32_t index = EntityIndex(entity);
+		if (index >= mRecords.size() || mRecords[index].archetype == nullptr
+			|| mRecords[index].entity != entity)
+		{
+			return nullptr;
+		}
+		return &mRecords[index];
+	}
+
+	template<typename T>
+	bool Insert(Entity entity, T component)
+	{
+		ComponentType type = ComponentFamily<T>();
+		std::uint32_t index = EntityIndex(entity);
+		if (index >= mRecords.size())
+		{
+			mRecords.resize(index + 1);
+		}
+
+		// Any generation of the index counts, since there is one record per index
+		EntityRecord& record = mRecords[index];
+		if (record.archetype != nullptr && (record.entity != entity || record.archetype->Has(type)))
+		{
+			SPDLOG_ERROR("Attempting to add another duplicate component to entity.");
+			return false;
+		}
+		record.entity = entity;
+
+		Archetype* destination = AddEdge(record.archetype, type);
+		MoveEntity(entity, record, destination);
+		new (destination->Get(record.row, type)) T(std::move(component));
+		return true;
+	}
+
+	/**
+	 * Moves an Entity (and the Components it keeps) from its
+	 * current table to another, updating the record of any
+	 * Entity displaced along the way.
+	 * 
+	 * @param destination The new table, or nullptr to drop
+	 * every Component of the Entity.
+	*/
+	void MoveEntity(Entity entity, EntityRecord& record, Archetype* destination)
+	{
+		Archetype* source = record.archetype;
+		std::size_t oldRow = record.row;
+		Entity moved = MAX_ENTITIES;
+
+		if (source != nullptr && destination != nullptr)
+		{
+			record.row = source->MoveRow(oldRow, *destination, moved);
+		}
+		else if (source != nullptr)
+		{
+			moved = source->RemoveRow(oldRow);
+		}
+		else if (destination != nullptr)
+		{
+			record.row = destination->AllocateRow(entity);
+		}
+
+		// The Entity that was last in the old table now fills the old row
+		if (moved != MAX_ENTITIES)
+		{
+			mRecords[EntityIndex(moved)].row = oldRow;
+		}
+		record.archetype = destination;
+	}
+
+	/** @returns The table of `from`'s Signature plus `type`. */
+	Archetype* AddEdge(Archetype* from, ComponentType type)
+	{
+		if (from == nullptr)
+		{
+			Signature signature;
+			signature.set(type);
+			return FindOrCreate(signature);
+		}
+
+		if (from->mAddEdges.empty())
+		{
+			from->mAddEdges.resize(MAX_COMPONENTS, nullptr);
+		}
+		if (from->mAddEdges[type] == nullptr)
+		{
+			Signature signature = from->GetSignature();
+			signature.set(type);
+			from->mAddEdges[type] = FindOrCreate(signature);
+		}
+		return from->mAddEdges[type];
+	}
+
+	/** @returns The table of `from`'s Signature minus `type`, or nullptr if that is empty. */
+	Archetype* RemoveEdge(Archetype* from, ComponentType type)
+	{
+		Signature signature = from->GetSignature();
+		signature.reset(type);
+		if (signature.none())
+		{
+			return nullptr;
+		}
+
+		if (from->mRemoveEdges.empty())
+		{
+			from->mRemoveEdges.resize(MAX_COMPONENTS, nullptr);
+		}
+		if (from->mRemoveEdges[type] == nullptr)
+		{
+			from->mRemoveEdges[type] = FindOrCreate(signature);
+		}
+		return from->mRemoveEdges[type];
+	}
+
+	Archetype* FindOrCreate(Signature signature)
+	{
+		auto it = mArchetypeBySignature.find(signature);
+		if (it != mArchetypeBySignature.end())
+		{
+			return it->second;
+		}
+
+		mArchetypes.push_back(std::make_unique<Archetype>(signature, mInfos));
+		mArchetypeBySignature[signature] = mArchetypes.back().get();
+		return mArchetypes.back().get();
+	}
+
+	/** The ComponentInfo of every type, indexed by ComponentType (size 0 if unregistered) */
+	std::vector<ComponentInfo> mInfos{};
+
+	/** Every table, in creation order */
+	std::vector<std::unique_ptr<Archetype>> mArchetypes{};
+
+	/** Map from Signature to its table */
+	std::unordered_map<Signature, Archetype*> mArchetypeBySignature{};
+
+	/** Where each Entity is stored, indexed by EntityIndex() */
+	std::vector<EntityRecord> mRecords{};
+};
+
+#endif
@@ -0,0 +1,288 @@
+#ifndef _ROC_COMMAND_BUFFER_H_
+#define _ROC_COMMAND_BUFFER_H_
+
+/**
+ * @file CommandBuffer.hpp
+ *
+ * This file defines the CommandBuffer class, which records
+ * structural changes (creating and destroying Entities, adding
+ * and removing Components) so they can be made later, at a
+ * point where nothing is iterating the ECS.
+*/
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Coordinator.hpp"
+
+/**
+ * @class CommandBuffer
+ *
+ * Records structural changes instead of making them. Systems
+ * can record into a buffer while iterating Entities or
+ * Components, without invalidating anything they iterate,
+ * and a buffer can be recorded into from several threads at
+ * once. Nothing happens until Coordinator::ApplyCommands().
+ *
+ * Entities made with CreateEntity() don't exist yet, so they
+ * are handed out as placeholder handles which can be used in
+ * any later command of the same buffer.
+ *
+ * Creations are applied first, so placeholders resolve, and
+ * destructions last. Additions and removals in between are
+ * applied in the order they were recorded, so removing a
+ * Component and then adding it back leaves the Entity with
+ * it. Runs of consecutive commands of the same kind and
+ * Component type are applied together.
+*/
+class CommandBuffer
+{
+public:
+	CommandBuffer() = default;
+	CommandBuffer(const CommandBuffer&) = delete;
+	CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+	/**
+	 * Records the creation of an unnamed Entity.
+	 *
+	 * @returns A placeholder handle for the Entity, or
+	 * MAX_ENTITIES if the buffer has run out of placeholders.
+	*/
+	Entity CreateEntity()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mCreateCount >= MAX_PLACEHOLDERS)
+		{
+			SPDLOG_ERROR("Recorded too many Entity creations in one CommandBuffer.");
+			return MAX_ENTITIES;
+		}
+		return MakeEntity(FIRST_PLACEHOLDER + mCreateCount++, 0);
+	}
+
+	/**
+	 * Records the destruction of an Entity.
+	 *
+	 * @param entity A living Entity or a placeholder from this buffer.
+	*/
+	void DestroyEntity(Entity entity)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mDestroys.push_back(entity);
+	}
+
+	/**
+	 * Records adding a Component to an Entity.
+	 *
+	 * @tparam T The subclass of Component to add.
+	 * @param entity A living Entity or a placeholder from this buffer.
+	 * @param component The Component to add, which the buffer keeps
+	 * until it is applied.
+	*/
+	template<typename T>
+	void AddComponent(Entity entity, T component)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		GetQueue<T>().mAdds.emplace_back(entity, std::move(component));
+		Record(ComponentFamily<T>(), true);
+	}
+
+	/**
+	 * Records removing a Component from an Entity.
+	 *
+	 * @tparam T The subclass of Component to remove.
+	 * @param entity A living Entity or a placeholder from this buffer.
+	*/
+	template<typename T>
+	void RemoveComponent(Entity entity)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		GetQueue<T>().mRemoves.push_back(entity);
+		Record(ComponentFamily<T>(), false);
+	}
+
+	/** @returns True if no commands have been recorded. */
+	bool Empty() const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mCreateCount != 0 || !mDestroys.empty())
+		{
+			return false;
+		}
+		for (auto const& queue : mQueues)
+		{
+			if (queue != nullptr && !queue->Empty())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** Throws away every recorded command without applying it. */
+	void Clear()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		ClearUnlocked();
+	}
+
+	/**
+	 * @returns True if the handle is a placeholder made by
+	 * CreateEntity() rather than a real Entity.
+	*/
+	static bool IsPlaceholder(Entity entity)
+	{
+		return EntityGeneration(entity) == 0 && EntityIndex(entity) >= FIRST_PLACEHOLDER;
+	}
+
+private:
+	friend class Coordinator;
+
+	/** Placeholders use the indices past MAX_ENTITIES, which no real Entity has. */
+	static constexpr std::uint32_t FIRST_PLACEHOLDER = MAX_ENTITIES + 1;
+	static constexpr std::uint32_t MAX_PLACEHOLDERS = ENTITY_INDEX_MASK + 1 - FIRST_PLACEHOLDER;
+
+	/** The recorded additions and removals of one Component type. */
+	class IComponentQueue
+	{
+	public:
+		virtual ~IComponentQueue() = default;
+		/** Applies the additions [begin, end), in order. */
+		virtual void ApplyAdds(Coordinator& coordinator, std::size_t begin, std::size_t end,
+			const std::vector<Entity>& created, std::vector<Entity>& touched) = 0;
+
+		/** Applies the removals [begin, end), in order. */
+		virtual void ApplyRemoves(Coordinator& coordinator, std::size_t begin, std::size_t end,
+			const std::vector<Entity>& created, std::vector<Entity>& touched) = 0;
+		virtual bool Empty() const = 0;
+		virtual void Clear() = 0;
+	};
+
+	template<typename T>
+	class ComponentQueue : public IComponentQueue
+	{
+	public:
+		void ApplyAdds(Coordinator& coordinator, std::size_t begin, std::size_t end,
+			const std::vector<Entity>& created, std::vector<Entity>& touched) override
+		{
+			for (std::size_t i = begin; i < end; i++)
+			{
+				auto& [recorded, component] = mAdds[i];
+				Entity entity = Resolve(recorded, created);
+				if (coordinator.AddComponentUnsynced<T>(entity, std::move(component)))
+				{
+					touched.push_back(entity);
+				}
+			}
+		}
+
+		void ApplyRemoves(Coordinator& coordinator, std::size_t begin, std::size_t end,
+			const std::vector<Entity>& created, std::vector<Entity>& touched) override
+		{
+			for (std::size_t i = begin; i < end; i++)
+			{
+				Entity entity = Resolve(mRemoves[i], created);
+				if (coordinator.RemoveComponentUnsynced<T>(entity))
+				{
+					touched.push_back(entity);
+				}
+			}
+		}
+
+		bool Empty() const override { return mAdds.empty() && mRemoves.empty(); }
+
+		void Clear() override
+		{
+			mAdds.clear();
+			mRemoves.clear();
+		}
+
+		std::vector<std::pair<Entity, T>> mAdds;
+		std::vector<Entity> mRemoves;
+	};
+
+	/**
+	 * Maps a placeholder to the Entity created for it (or
+	 * MAX_ENTITIES if none was), and any other handle to itself.
+	*/
+	static Entity Resolve(Entity entity, const std::vector<Entity>& created)
+	{
+		if (!IsPlaceholder(entity))
+		{
+			return entity;
+		}
+		std::size_t placeholder = EntityIndex(entity) - FIRST_PLACEHOLDER;
+		return placeholder < created.size() ? created[placeholder] : MAX_ENTITIES;
+	}
+
+	/**
+	 * Consecutive additions (or removals) of one Component
+	 * type, which take up the next `count` entries of that
+	 * type's queue.
+	*/
+	struct Run
+	{
+		ComponentType type;
+		bool add;
+		std::size_t count;
+	};
+
+	/** Notes one more addition or removal, extending the last Run if it's the same kind. */
+	void Record(ComponentType type, bool add)
+	{
+		if (!mRuns.empty() && mRuns.back().type == type && mRuns.back().add == add)
+		{
+			mRuns.back().count++;
+			return;
+		}
+		mRuns.push_back({type, add, 1});
+	}
+
+	template<typename T>
+	ComponentQueue<T>& GetQueue()
+	{
+		ComponentType type = ComponentFamily<T>();
+		if (type >= mQueues.size())
+		{
+			mQueues.resize(type + 1);
+		}
+		if (mQueues[type] == nullptr)
+		{
+			mQueues[type] = std::make_unique<ComponentQueue<T>>();
+		}
+		return static_cast<ComponentQueue<T>&>(*mQueues[type]);
+	}
+
+	void ClearUnlocked()
+	{
+		mCreateCount = 0;
+		mDestroys.clear();
+		mRuns.clear();
+		for (auto const& queue : mQueues)
+		{
+			if (queue != nullptr)
+			{
+				queue->Clear();
+			}
+		}
+	}
+
+	/** Guards every member below, so any thread may record. */
+	mutable std::mutex mMutex;
+
+	/** The number of placeholders handed out. */
+	std::uint32_t mCreateCount = 0;
+
+	/** The recorded destructions, in order. */
+	std::vector<Entity> mDestroys;
+
+	/** The recorded additions and removals, indexed by ComponentType */
+	std::vector<std::unique_ptr<IComponentQueue>> mQueues;
+
+	/** The order the additions and removals were recorded in. */
+	std::vector<Run> mRuns;
+};
+
+#endif
@@ -12,23 +12,22 @@
  * @author Tim Bishop
 */
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <bitset>
 
 #include <any>
-#include <map>
-#include <functional>
+#include <string>
+#include <typeinfo>
+#include <vector>
 
 #include <boost/preprocessor.hpp>
 
 // z, data, elem
 #define PRINT_TO_SETTER(z, data, elem) BOOST_PP_IF(BOOST_PP_TUPLE_ELEM(0, elem),\
-void BOOST_PP_CAT(__set_, BOOST_PP_TUPLE_ELEM(3, elem))(Property p)\
-{BOOST_PP_TUPLE_ELEM(3, elem) = std::any_cast<BOOST_PP_TUPLE_ELEM(2, elem)>(p); }, \
-)
-
-#define PRINT_TO_COPYSTATEMENT(z, data, elem) BOOST_PP_IF(BOOST_PP_TUPLE_ELEM(0, elem),\
-BOOST_PP_TUPLE_ELEM(3, elem) = cpy.BOOST_PP_TUPLE_ELEM(3, elem);, \
+static void BOOST_PP_CAT(__set_, BOOST_PP_TUPLE_ELEM(3, elem))(Component& c, const Property& p)\
+{static_cast<data&>(c).BOOST_PP_TUPLE_ELEM(3, elem) = std::any_cast<BOOST_PP_TUPLE_ELEM(2, elem)>(p); }, \
 )
 
 #define PRINT_TO_PROPERTY_PT1(z, data, elem) BOOST_PP_IF(  BOOST_PP_TUPLE_ELEM( 0 , elem ),\
@@ -40,12 +39,14 @@ BOOST_PP_TUPLE_ELEM(1, elem)\
 
 #define PRINT_TO_PROPERTY(z, data, elem) BOOST_PP_EXPAND(BOOST_PP_TUPLE_REM()PRINT_TO_PROPERTY_PT1(z, data, elem))
 
-#define LAMBDA(elem) _setters[BOOST_PP_STRINGIZE(BOOST_PP_TUPLE_ELEM(3, elem))] = [=](Property p){\
-BOOST_PP_CAT(__set_, BOOST_PP_TUPLE_ELEM(3, elem))(p); };
+// Offsets are measured on a probe instance, since offsetof() isn't
+// guaranteed to work on Components (they aren't standard-layout).
+#define DESCRIPTOR(cname, elem) PropertyDescriptor{ BOOST_PP_STRINGIZE(BOOST_PP_TUPLE_ELEM(3, elem)),\
+static_cast<std::size_t>(reinterpret_cast<const char*>(&probe.BOOST_PP_TUPLE_ELEM(3, elem)) - reinterpret_cast<const char*>(&probe)),\
+&typeid(BOOST_PP_TUPLE_ELEM(2, elem)), &cname::BOOST_PP_CAT(__set_, BOOST_PP_TUPLE_ELEM(3, elem)) },
 
-#define PRINT_TO_LAMBDA(z, data, elem) BOOST_PP_IF(BOOST_PP_TUPLE_ELEM(0, elem),\
-LAMBDA(elem), \
-)
+#define PRINT_TO_DESCRIPTOR(z, data, elem) BOOST_PP_IF(BOOST_PP_TUPLE_ELEM(0, elem),\
+DESCRIPTOR, BOOST_PP_TUPLE_EAT(2))(data, elem)
 
 #define ROCKET_PROPERTY(qualifier, type, name) (1, qualifier, type, name)
 #define ROCKET_PROPERTY_DEFVAL(qualifier, type, name, defval) (1, qualifier, type, name, defval)
@@ -56,22 +57,19 @@ LAMBDA(elem), \
 #define ROCKET_COMPONENT(cname, ...) class cname : public Component {\
 public: \
 static std::string name() { return #cname; }\
-BOOST_PP_SEQ_FOR_EACH(PRINT_TO_SETTER, _, BOOST_PP_VARIADIC_SEQ_TO_SEQ(__VA_ARGS__)) \
+BOOST_PP_SEQ_FOR_EACH(PRINT_TO_SETTER, cname, BOOST_PP_VARIADIC_SEQ_TO_SEQ(__VA_ARGS__)) \
 BOOST_PP_SEQ_FOR_EACH(PRINT_TO_PROPERTY, _, BOOST_PP_VARIADIC_SEQ_TO_SEQ(__VA_ARGS__)) \
 \
-public: cname() {\
-    BOOST_PP_SEQ_FOR_EACH(PRINT_TO_LAMBDA, _, BOOST_PP_VARIADIC_SEQ_TO_SEQ(__VA_ARGS__)) \
+public: static const PropertyTable& Properties() {\
+    static cname probe;\
+    static const PropertyTable table = {\
+        BOOST_PP_SEQ_FOR_EACH(PRINT_TO_DESCRIPTOR, cname, BOOST_PP_VARIADIC_SEQ_TO_SEQ(__VA_ARGS__)) \
+    };\
+    return table;\
 }\
 \
-public: cname(const cname & cpy) {\
-    BOOST_PP_SEQ_FOR_EACH(PRINT_TO_COPYSTATEMENT, _, BOOST_PP_VARIADIC_SEQ_TO_SEQ(__VA_ARGS__)) \
-    BOOST_PP_SEQ_FOR_EACH(PRINT_TO_LAMBDA, _, BOOST_PP_VARIADIC_SEQ_TO_SEQ(__VA_ARGS__)) \
-} \
-\
-public: cname & operator=(const cname & cpy) {\
-    BOOST_PP_SEQ_FOR_EACH(PRINT_TO_COPYSTATEMENT, _, BOOST_PP_VARIADIC_SEQ_TO_SEQ(__VA_ARGS__)) \
-    BOOST_PP_SEQ_FOR_EACH(PRINT_TO_LAMBDA, _, BOOST_PP_VARIADIC_SEQ_TO_SEQ(__VA_ARGS__)) \
-    return *this;\
+public: bool SetProperty(const std::string& property, const Property& value) {\
+    return ApplyProperty(Properties(), *this, property, value);\
 }\
 }
 
@@ -85,12 +83,44 @@ const ComponentType MAX_COMPONENTS = 256;
 
 using Signature = std::bitset<MAX_COMPONENTS>;
 
+/**
+ * Hands out the next unused component family ID. Only
+ * meant to be called by ComponentFamily().
+*/
+inline ComponentType NextComponentFamily()
+{
+    static std::atomic<ComponentType> next{0};
+    return next++;
+}
+
+/**
+ * Returns the ID of a Component subclass, assigned the
+ * first time the subclass is used and constant afterwards.
+ * The ComponentManager uses it both as the index of the
+ * subclass' ComponentArray and as its bit in a Signature,
+ * so typed lookups never have to go through T::name().
+ * 
+ * @tparam T The subclass of Component.
+*/
+template<typename T>
+ComponentType ComponentFamily()
+{
+    static const ComponentType id = NextComponentFamily();
+    return id;
+}
+
 /**
  * @class Component
  * 
  * A quick base class, just so that any components
  * created all implement certain Constructors and have
  * a public "isNull" boolean.
+ * 
+ * Components hold no per-instance bookkeeping, so any
+ * subclass made only of trivially copyable properties
+ * is itself trivially copyable. Setting properties by
+ * name goes through the per-type PropertyTable that
+ * ROCKET_COMPONENT generates instead.
 */
 class Component
 {
@@ -98,17 +128,6 @@ private:
     bool mIsNull;
 
 public:
-    /**
-     * A map of setter functions for any RocketProperties
-     * inside a subclass.
-     * 
-     * @note This map is only public to work with LoadScene().
-     * 
-     * @todo Make this class have a friend function of LoadScene()
-     * and make _setters protected.
-    */
-    std::map<std::string, std::function<void(Property)>> _setters;
-
     /**
      * Default constructor
      * 
@@ -121,9 +140,64 @@ public:
     bool isNull() {return mIsNull;}
 
     /**
-     * A virtual destructor function, not defined explicitly
-     * as a destructor so we have more control over when a
+     * A destructor-like hook, not defined explicitly as a
+     * destructor so we have more control over when a
      * Component (or subclass of it) should be destroyed.
+     * 
+     * @note This is not virtual, so that Components stay
+     * plain data. Subclasses hide it with their own version.
     */
-    virtual void DestroyComponent() {}
+    void DestroyComponent() {}
 };
+
+/**
+ * @struct PropertyDescriptor
+ * 
+ * Describes one RocketProperty of a Component subclass.
+ * One table of these is shared by every instance of
+ * the subclass.
+*/
+struct PropertyDescriptor
+{
+    /** The name of the property, as written in the class. */
+    const char* name;
+
+    /** The byte offset of the property inside the Component. */
+    std::size_t offset;
+
+    /** The declared type of the property. */
+    const std::type_info* type;
+
+    /** Sets the property on a Component from a Property holding `type`. */
+    void (*setter)(Component&, const Property&);
+};
+
+/** The static reflection table of a Component subclass. */
+using PropertyTable = std::vector<PropertyDescriptor>;
+
+/**
+ * Searches a PropertyTable for a property by name.
+ * 
+ * @param table The table of the Component subclass.
+ * @param property The name of the property.
+ * 
+ * @returns The descriptor of the property, or nullptr
+ * if the table has no property of that name.
+*/
+const PropertyDescriptor* FindProperty(const PropertyTable& table, const std::string& property);
+
+/**
+ * Sets a property on a Component through its subclass'
+ * PropertyTable. Used by text-driven code such as LoadScene().
+ * 
+ * @param table The table of the Component's subclass.
+ * @param component The Component to modify.
+ * @param property The name of the property.
+ * @param value The new value, holding the property's exact type.
+ * 
+ * @throws std::bad_any_cast if `value` holds the wrong type.
+ * 
+ * @returns True if the property was set, false if the
+ * table has no property of that name.
+*/
+bool ApplyProperty(const PropertyTable& table, Component& component, const std::string& property, const Property& value);
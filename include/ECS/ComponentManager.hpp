@@ -19,11 +19,15 @@
 */
 
 #include <memory>
-#include <functional>
 #include <string>
+#include <tuple>
+#include <vector>
 #include <spdlog/spdlog.h>
 
+#include "ComponentRegistry.hpp"
+#include "EntitySet.hpp"
 #include "IComponentArray.hpp"
+#include "View.hpp"
 
 
 /**
@@ -34,9 +38,11 @@
  * facilitate the Coordinator retrieving, creating, and
  * erasing Component objects.
 */
-class ComponentManager
+class ComponentManager : public ComponentRegistry
 {
 public:
+	using ComponentRegistry::GetComponentType;
+
 	/**
 	 * This method does exactly what one would expect:
 	 * it adds a new Component of type T to the Entity
@@ -52,7 +58,7 @@ public:
 	bool AddComponent(Entity entity)
 	{
 		// Add a component to the array for an entity
-        std::shared_ptr<ComponentArray<T>> ptr = GetComponentArray<T>();
+        ComponentArray<T>* ptr = GetComponentArray<T>();
         if (ptr == nullptr) {SPDLOG_WARN("Couldn't get a ComponentArray for {}", T::name()); return false;}
 		return ptr->InsertData(entity, T());
 	}
@@ -76,9 +82,37 @@ public:
 	bool AddComponent(Entity entity, T component)
 	{
 		// Add a component to the array for an entity
-        std::shared_ptr<ComponentArray<T>> ptr = GetComponentArray<T>();
+        ComponentArray<T>* ptr = GetComponentArray<T>();
         if (ptr == nullptr) { throw std::runtime_error("Attempted to add to a nonexistent ComponentArray!"); }
-		return ptr->InsertData(entity, component);
+		return ptr->InsertData(entity, std::move(component));
+	}
+
+	/**
+	 * Attaches a copy of each prototype Component to every
+	 * Entity in a batch, one ComponentArray at a time.
+	 * 
+	 * @tparam Ts The subclasses of Component to attach.
+	 * @param entities The Entities to attach them to, none of
+	 * which may have any of Ts yet.
+	 * @param count The number of Entities in `entities`.
+	 * @param prototypes The Components to copy to every Entity.
+	 * 
+	 * @return True if every Component was added, false otherwise.
+	*/
+	template<typename... Ts>
+	bool AddComponents(const Entity* entities, std::size_t count, const Ts&... prototypes)
+	{
+		if constexpr (sizeof...(Ts) == 0)
+		{
+			return true;
+		}
+		else
+		{
+			std::tuple<ComponentArray<Ts>*...> arrays(GetComponentArray<Ts>()...);
+			bool registered = ((std::get<ComponentArray<Ts>*>(arrays) != nullptr) && ...);
+			if (!registered) { throw std::runtime_error("Attempted to add to a nonexistent ComponentArray!"); }
+			return (std::get<ComponentArray<Ts>*>(arrays)->InsertBatch(entities, count, prototypes) && ...);
+		}
 	}
 
 	/**
@@ -101,50 +135,30 @@ public:
 	bool RegisterComponent()
 	{
 		std::string typeName = T::name();
+		ComponentType type = ComponentFamily<T>();
 
-		if (mComponentTypes.find(typeName) != mComponentTypes.end())
+		if (type >= MAX_COMPONENTS)
+		{
+			SPDLOG_ERROR("Attempting to register more than MAX_COMPONENTS ComponentTypes.");
+			return false;
+		}
+
+		// Add this component type to the name-based lookups
+		if (!RegisterComponentName(typeName, type,
+			[=](Entity e){ return this->AddComponent<T>(e); },
+			[=](Entity e){ return (Component*)this->GetComponentPtr<T>(e); },
+			&T::Properties()))
         {
-            SPDLOG_ERROR("Attempting to register ComponentType twice.");
             return false;
         }
 
-		// Add this component type to the component type map
-		mComponentTypes.insert({typeName, mNextComponentType});
-
-		// Create a ComponentArray pointer and add it to the component arrays map
-		mComponentArrays.insert({typeName, std::make_shared<ComponentArray<T>>()});
-
-		mCreateCompFuncs[typeName] = [=](Entity e){ return this->AddComponent<T>(e); };
-
-		mAccessCompFuncs[typeName] = [=](Entity e){ return (Component*)this->GetComponentPtr<T>(e); };
-
-		// Increment the value so that the next component registered will be different
-		++mNextComponentType;
-        return true;
-	}
-
-	/**
-	 * This function is used in LoadScene() exclusively
-	 * to instantiate a Component subclass based on its name.
-	 * This should not be used in normal code.
-	 * 
-	 * @todo Perhaps add LoadScene() as a friend function, and
-	 * make this function private? (Or similar in the Coordinator?)
-	 * 
-	 * @param e The entity to add the new Component to.
-	 * @param typeName The string representation of the Component.
-	 * 
-	 * @returns True if the Component was added successfully, false
-	 * if it was not.
-	*/
-	bool AddComponentToEntityFromText(Entity e, const std::string& typeName)
-	{
-		if (mCreateCompFuncs.find(typeName) == mCreateCompFuncs.end())
+		// Create a ComponentArray pointer and put it in the slot of its type
+		if (type >= mComponentArrays.size())
 		{
-			throw std::runtime_error(std::string("Could not find component ") + typeName);
+			mComponentArrays.resize(type + 1);
 		}
-
-		return mCreateCompFuncs[typeName](e);
+		mComponentArrays[type] = std::make_shared<ComponentArray<T>>();
+        return true;
 	}
 
 	/**
@@ -160,40 +174,16 @@ public:
 	template<typename T>
 	ComponentType GetComponentType()
 	{
-		std::string typeName = T::name();
-
-		if (mComponentTypes.find(typeName) == mComponentTypes.end())
-        {
-            SPDLOG_ERROR("Attempted to access ComponentType before registering.");
-            return MAX_COMPONENTS;
-        }
+		ComponentType type = ComponentFamily<T>();
 
-		// Return this component's type - used for creating signatures
-		return mComponentTypes[typeName];
-	}
-
-	/**
-	 * Similar to GetComponentType(), but used exclusively
-	 * for the string representation of the class. Used in
-	 * LoadScene().
-	 * 
-	 * @param typeName The string representation of the Component
-	 * subclass.
-	 * 
-	 * @returns MAX_COMPONENTS if the Component was not
-	 * already registered, or the ComponentType corresponding
-	 * to it if it has been.
-	*/
-	ComponentType GetComponentType(const std::string& typeName)
-	{
-		if (mComponentTypes.find(typeName) == mComponentTypes.end())
+		if (type >= mComponentArrays.size() || mComponentArrays[type] == nullptr)
         {
             SPDLOG_ERROR("Attempted to access ComponentType before registering.");
             return MAX_COMPONENTS;
         }
 
 		// Return this component's type - used for creating signatures
-		return mComponentTypes[typeName];
+		return type;
 	}
 
 	/**
@@ -209,7 +199,7 @@ public:
 	bool RemoveComponent(Entity entity)
 	{
 		// Remove a component from the array for an entity
-        std::shared_ptr<ComponentArray<T>> ptr = GetComponentArray<T>();
+        ComponentArray<T>* ptr = GetComponentArray<T>();
         if (ptr == nullptr) { throw std::runtime_error("Attempted to remove pointer from nonexistent ComponentArray!"); }
 		return ptr->RemoveData(entity);
 	}
@@ -227,7 +217,7 @@ public:
 	T& GetComponent(Entity entity)
 	{
 		// Get a reference to a component from the array for an entity
-        std::shared_ptr<ComponentArray<T>> ptr = GetComponentArray<T>();
+        ComponentArray<T>* ptr = GetComponentArray<T>();
         /** @todo AGAIN PLEASE FIX, I HATE ASSERTS IN REAL CODE */
         if (ptr == nullptr)
 		{
@@ -237,24 +227,66 @@ public:
 	}
 
 	/**
-	 * A method called exclusively in LoadScene(), this method
-	 * returns a Component pointer to the Component subclass
-	 * of type `typename` at index `entity`.
+	 * Returns the T attached to the given Entity, or nullptr if
+	 * it has none. Unlike GetComponent(), a missing Component,
+	 * an unregistered T or a stale Entity handle is not an
+	 * error here: nothing is thrown or logged.
 	 * 
-	 * @param typeName A string representation of the subclass of Component.
+	 * @tparam T The subclass of Component to search for.
 	 * @param entity The entity to get the Component of.
 	 * 
-	 * @returns A pointer to a Component object somewhere in the
-	 * ComponentArray objects, or nullptr if the type doesn't exist.
+	 * @returns A pointer to the entity's component, or nullptr.
 	*/
-	Component* GetComponentAbstract(const std::string& typeName, Entity entity)
+	template<typename T>
+	T* TryGetComponent(Entity entity)
 	{
-		if (mAccessCompFuncs.find(typeName) == mAccessCompFuncs.end())
-        {
-            SPDLOG_ERROR("Attempted to access Component before registering.");
-            return nullptr;
-        }
-		return mAccessCompFuncs.at(typeName)(entity);
+		ComponentType type = ComponentFamily<T>();
+		if (type >= mComponentArrays.size() || mComponentArrays[type] == nullptr)
+		{
+			return nullptr;
+		}
+		return static_cast<ComponentArray<T>*>(mComponentArrays[type].get())->TryGetData(entity);
+	}
+
+	/**
+	 * Orders a set of Entities by the position of their T
+	 * Component in its packed ComponentArray, so iterating the
+	 * set reads the Components front to back.
+	 * 
+	 * @tparam T The subclass of Component to order by.
+	 * @param entities The set to reorder.
+	 * 
+	 * @returns False if T hasn't been registered, true otherwise.
+	*/
+	template<typename T>
+	bool SortByComponent(EntitySet& entities)
+	{
+		ComponentArray<T>* ptr = GetComponentArray<T>();
+		if (ptr == nullptr)
+		{
+			return false;
+		}
+		entities.SortBy(ptr->Entities());
+		return true;
+	}
+
+	/**
+	 * Creates a ComponentView over every Entity that owns all
+	 * of the Components in Ts.
+	 * 
+	 * @tparam Ts The subclasses of Component to view.
+	 * @param signatures The Signature of every Entity, indexed by EntityIndex().
+	 * 
+	 * @returns The view, which is empty if any of Ts isn't registered.
+	*/
+	template<typename... Ts>
+	ComponentView<Ts...> View(const Signature* signatures)
+	{
+		// An unregistered type makes the view empty, so its bit only
+		// needs to stay in range
+		Signature mask;
+		(mask.set(ComponentFamily<Ts>() % MAX_COMPONENTS), ...);
+		return ComponentView<Ts...>(std::make_tuple(GetComponentArray<Ts>()...), signatures, mask);
 	}
 
 	/**
@@ -269,49 +301,71 @@ public:
 	{
 		// Notify each component array that an entity has been destroyed
 		// If it has a component for that entity, it will remove it
-		for (auto const& pair : mComponentArrays)
+		for (auto const& component : mComponentArrays)
 		{
-			auto const& component = pair.second;
-
-			component->EntityDestroyed(entity);
+			if (component != nullptr)
+			{
+				component->EntityDestroyed(entity);
+			}
 		}
 	}
 
-private:
-	/** Map from type string pointer to a component type */
-	std::unordered_map<std::string, ComponentType> mComponentTypes{};
-
-	/** Map from type string pointer to a component array */
-	std::unordered_map<std::string, std::shared_ptr<IComponentArray>> mComponentArrays{};
-
-	/** Map from string name of Components to their Adder function */
-	std::unordered_map<std::string, std::function<bool(Entity)>> mCreateCompFuncs{};
+	/**
+	 * Removes the Components of a batch of destroyed Entities,
+	 * visiting each ComponentArray once for the whole batch.
+	 * 
+	 * @param entities The entities that were just destroyed.
+	 * @param count The number of Entities in `entities`.
+	*/
+	void EntitiesDestroyed(const Entity* entities, std::size_t count)
+	{
+		for (auto const& component : mComponentArrays)
+		{
+			if (component != nullptr)
+			{
+				component->EntitiesDestroyed(entities, count);
+			}
+		}
+	}
 
-	/** Map from string name of Components to a function returning a pointer to a Component */
-	std::unordered_map<std::string, std::function<Component*(Entity)>> mAccessCompFuncs{};
+	/**
+	 * Removes every Component of every Entity, emptying each
+	 * ComponentArray in one go instead of Entity by Entity.
+	*/
+	void Clear()
+	{
+		for (auto const& component : mComponentArrays)
+		{
+			if (component != nullptr)
+			{
+				component->Clear();
+			}
+		}
+	}
 
-	/** The component type to be assigned to the next registered component - starting at 0 */
-	ComponentType mNextComponentType{};
+private:
+	/** The component arrays, indexed by component type (nullptr if unregistered) */
+	std::vector<std::shared_ptr<IComponentArray>> mComponentArrays{};
 
 	/**
 	 * Convenience function to get the statically casted pointer to the ComponentArray of type T.
 	 * 
 	 * @tparam T The subclass of Component.
-	 * @return A shared_ptr to the ComponentArray containing the class
+	 * @return A pointer to the ComponentArray containing the class
 	 * of Component defined in T, or nullptr if it doesn't exist.
 	 */
 	template<typename T>
-	std::shared_ptr<ComponentArray<T>> GetComponentArray()
+	ComponentArray<T>* GetComponentArray()
 	{
-		std::string typeName = T::name();
+		ComponentType type = ComponentFamily<T>();
 
-		if (mComponentTypes.find(typeName) == mComponentTypes.end())
+		if (type >= mComponentArrays.size() || mComponentArrays[type] == nullptr)
         {
             SPDLOG_ERROR("Attempted to access nonexistent ComponentArray.");
             return nullptr;
         }
 
-		return std::static_pointer_cast<ComponentArray<T>>(mComponentArrays[typeName]);
+		return static_cast<ComponentArray<T>*>(mComponentArrays[type].get());
 	}
 
 	/**
@@ -325,11 +379,7 @@ private:
 	template<typename T>
 	T* GetComponentPtr(Entity e)
 	{
-		std::string typeName = T::name();
-
-		std::shared_ptr<ComponentArray<T>> c_ar = GetComponentArray<T>();
-
-		return &(c_ar.get()->GetData(e));
+		return &(GetComponentArray<T>()->GetData(e));
 	}
 };
 
@@ -0,0 +1,195 @@
+#ifndef _ROC_COMPONENT_REGISTRY_H_
+#define _ROC_COMPONENT_REGISTRY_H_
+
+/**
+ * @file ComponentRegistry.hpp
+ * 
+ * This file defines the ComponentRegistry class, which holds
+ * the name-based lookups shared by every component storage
+ * backend (ComponentManager and ArchetypeManager).
+*/
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <spdlog/spdlog.h>
+
+#include "Entity.hpp"
+#include "Component.hpp"
+
+
+/**
+ * @class ComponentRegistry
+ * 
+ * The text-driven half of a component storage backend. It
+ * maps the string names of registered Component subclasses
+ * to their ComponentType, PropertyTable, and functions to
+ * create and access them, so LoadScene() can work without
+ * knowing about types at compile time. Typed access never
+ * goes through here.
+*/
+class ComponentRegistry
+{
+public:
+	/**
+	 * This function is used in LoadScene() exclusively
+	 * to instantiate a Component subclass based on its name.
+	 * This should not be used in normal code.
+	 * 
+	 * @todo Perhaps add LoadScene() as a friend function, and
+	 * make this function private? (Or similar in the Coordinator?)
+	 * 
+	 * @param e The entity to add the new Component to.
+	 * @param typeName The string representation of the Component.
+	 * 
+	 * @returns True if the Component was added successfully, false
+	 * if it was not.
+	*/
+	bool AddComponentToEntityFromText(Entity e, const std::string& typeName)
+	{
+		if (mCreateCompFuncs.find(typeName) == mCreateCompFuncs.end())
+		{
+			throw std::runtime_error(std::string("Could not find component ") + typeName);
+		}
+
+		return mCreateCompFuncs[typeName](e);
+	}
+
+	/**
+	 * Similar to GetComponentType(), but used exclusively
+	 * for the string representation of the class. Used in
+	 * LoadScene().
+	 * 
+	 * @param typeName The string representation of the Component
+	 * subclass.
+	 * 
+	 * @returns MAX_COMPONENTS if the Component was not
+	 * already registered, or the ComponentType corresponding
+	 * to it if it has been.
+	*/
+	ComponentType GetComponentType(const std::string& typeName)
+	{
+		if (mComponentTypes.find(typeName) == mComponentTypes.end())
+        {
+            SPDLOG_ERROR("Attempted to access ComponentType before registering.");
+            return MAX_COMPONENTS;
+        }
+
+		// Return this component's type - used for creating signatures
+		return mComponentTypes[typeName];
+	}
+
+	/**
+	 * A method called exclusively in LoadScene(), this method
+	 * returns a Component pointer to the Component subclass
+	 * of type `typename` at index `entity`.
+	 * 
+	 * @param typeName A string representation of the subclass of Component.
+	 * @param entity The entity to get the Component of.
+	 * 
+	 * @returns A pointer to a Component object somewhere in the
+	 * ComponentArray objects, or nullptr if the type doesn't exist.
+	*/
+	Component* GetComponentAbstract(const std::string& typeName, Entity entity)
+	{
+		if (mAccessCompFuncs.find(typeName) == mAccessCompFuncs.end())
+        {
+            SPDLOG_ERROR("Attempted to access Component before registering.");
+            return nullptr;
+        }
+		return mAccessCompFuncs.at(typeName)(entity);
+	}
+
+	/**
+	 * Returns the static PropertyTable of a Component subclass
+	 * based on its name. Used in LoadScene().
+	 * 
+	 * @param typeName The string representation of the Component
+	 * subclass.
+	 * 
+	 * @returns A pointer to the subclass' PropertyTable, or nullptr
+	 * if the type hasn't been registered.
+	*/
+	const PropertyTable* GetComponentProperties(const std::string& typeName)
+	{
+		if (mPropertyTables.find(typeName) == mPropertyTables.end())
+		{
+			SPDLOG_ERROR("Attempted to access Component properties before registering.");
+			return nullptr;
+		}
+		return mPropertyTables.at(typeName);
+	}
+
+	/**
+	 * Sets a property of an Entity's Component, with both the
+	 * Component subclass and the property given by name. Used
+	 * in LoadScene().
+	 * 
+	 * @param e The entity whose Component should be modified.
+	 * @param typeName The string representation of the Component subclass.
+	 * @param property The name of the property to set.
+	 * @param value The new value of the property.
+	 * 
+	 * @returns True if the property was set, false if the type
+	 * or property doesn't exist.
+	*/
+	bool SetComponentPropertyFromText(Entity e, const std::string& typeName, const std::string& property, const Property& value)
+	{
+		const PropertyTable* table = GetComponentProperties(typeName);
+		if (table == nullptr)
+		{
+			return false;
+		}
+
+		if (!ApplyProperty(*table, *mAccessCompFuncs.at(typeName)(e), property, value))
+		{
+			SPDLOG_ERROR("Component {} has no property named {}", typeName, property);
+			return false;
+		}
+		return true;
+	}
+
+protected:
+	/**
+	 * Records the name-based lookups of a Component subclass.
+	 * Called by the backends' RegisterComponent().
+	 * 
+	 * @param typeName The string representation of the subclass.
+	 * @param type The ComponentType of the subclass.
+	 * @param create A function adding a default subclass instance to an Entity.
+	 * @param access A function returning an Entity's instance of the subclass.
+	 * @param properties The static PropertyTable of the subclass.
+	 * 
+	 * @returns False if a subclass of that name was already registered.
+	*/
+	bool RegisterComponentName(const std::string& typeName, ComponentType type,
+		std::function<bool(Entity)> create, std::function<Component*(Entity)> access,
+		const PropertyTable* properties)
+	{
+		if (mComponentTypes.find(typeName) != mComponentTypes.end())
+        {
+            SPDLOG_ERROR("Attempting to register ComponentType twice.");
+            return false;
+        }
+
+		mComponentTypes.insert({typeName, type});
+		mCreateCompFuncs[typeName] = create;
+		mAccessCompFuncs[typeName] = access;
+		mPropertyTables[typeName] = properties;
+		return true;
+	}
+
+	/** Map from type string to a component type, for the text-driven paths */
+	std::unordered_map<std::string, ComponentType> mComponentTypes{};
+
+	/** Map from string name of Components to their Adder function */
+	std::unordered_map<std::string, std::function<bool(Entity)>> mCreateCompFuncs{};
+
+	/** Map from string name of Components to a function returning a pointer to a Component */
+	std::unordered_map<std::string, std::function<Component*(Entity)>> mAccessCompFuncs{};
+
+	/** Map from string name of Components to their static PropertyTable */
+	std::unordered_map<std::string, const PropertyTable*> mPropertyTables{};
+};
+
+#endif
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "../Coordinator.hpp"
-#include <vector>
 
 const int COLLISION_LEFT = 1;
 const int COLLISION_TOP = 2;
@@ -14,14 +13,29 @@ struct Collision
     Entity ent_collided;
 };
 
-bool CheckCollision(Collision& c, int position);
+bool CheckCollision(const Collision& c, int position);
 
 void AddCollision(Collision& c, int position);
 
+/**
+ * A box collider, offset from its Entity's Transform.
+ *
+ * `layer` has a bit set for each collision layer the collider
+ * is on (normally just one; layer 0 by default), and `mask` a
+ * bit for each layer it can touch (all of them by default).
+ * Two colliders only collide if each is on a layer the other's
+ * mask has; see also CollisionSystem::SetLayersInteract().
+ *
+ * Set `isStatic` on colliders that never move, like walls and
+ * platforms: they are only tested against moving colliders,
+ * never against each other.
+*/
 ROCKET_COMPONENT(RectangleCollider,
     ROCKET_PROPERTY_DEFVAL(public, double, offsetX, 0)
     ROCKET_PROPERTY_DEFVAL(public, double, offsetY, 0)
     ROCKET_PROPERTY(public, double, width)
     ROCKET_PROPERTY(public, double, height)
-    ROCKET_RAW(public: std::vector<Collision> collisions;)
+    ROCKET_PROPERTY_DEFVAL(public, std::uint32_t, layer, 1)
+    ROCKET_PROPERTY_DEFVAL(public, std::uint32_t, mask, 0xFFFFFFFF)
+    ROCKET_PROPERTY_DEFVAL(public, bool, isStatic, false)
 );
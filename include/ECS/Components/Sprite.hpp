@@ -26,7 +26,7 @@ ROCKET_COMPONENT(Sprite,
     ROCKET_PROPERTY_DEFVAL(public, double, height, 0.0)
 
     ROCKET_RAW(public: void SetOutputData(double thisx, double thisy);)
-    ROCKET_RAW(public: void DestroyComponent() override;)
+    ROCKET_RAW(public: void DestroyComponent();)
 
     ROCKET_PROPERTY_DEFVAL(private, unsigned int, VBO, 0)
     
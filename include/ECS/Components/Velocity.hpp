@@ -0,0 +1,16 @@
+#ifndef _ROC_VELOCITY_COMPONENT_H_
+#define _ROC_VELOCITY_COMPONENT_H_
+
+#include "../Component.hpp"
+
+/**
+ * How fast an Entity's Transform moves, in world units per
+ * second, as applied by the IntegrationSystem. Positive y is
+ * up, so Gravity pulls `y` down.
+*/
+ROCKET_COMPONENT(Velocity,
+    ROCKET_PROPERTY_DEFVAL(public, double, x, 0)
+    ROCKET_PROPERTY_DEFVAL(public, double, y, 0)
+);
+
+#endif
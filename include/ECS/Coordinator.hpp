@@ -16,6 +16,18 @@
 #include "ComponentManager.hpp"
 #include "SystemManager.hpp"
 
+class CommandBuffer;
+
+#ifdef ROCKET_ARCHETYPE_STORAGE
+#include "ArchetypeManager.hpp"
+
+/** The component storage backend used by the Coordinator. */
+using ComponentStorage = ArchetypeManager;
+#else
+/** The component storage backend used by the Coordinator. */
+using ComponentStorage = ComponentManager;
+#endif
+
 
 /**
  * @class Coordinator
@@ -72,7 +84,7 @@ public:
 	void Init()
 	{
 		// Create pointers to each manager
-		mComponentManager = std::make_unique<ComponentManager>();
+		mComponentManager = std::make_unique<ComponentStorage>();
 		mEntityManager = std::make_unique<EntityManager>();
 		mSystemManager = std::make_unique<SystemManager>();
 	}
@@ -102,39 +114,130 @@ public:
 		return mEntityManager->GetEntity(name);
 	}
 
+	/**
+	 * @copydoc EntityManager::IsAlive()
+	*/
+	bool IsAlive(Entity entity) const
+	{
+		return mEntityManager->IsAlive(entity);
+	}
+
 	void DestroyEntity(const std::string& name)
 	{
 		Entity e = mEntityManager->GetEntity(name);
+		Signature signature = mEntityManager->GetSignature(e);
 		if (mEntityManager->DestroyEntity(name))
 		{
 			mComponentManager->EntityDestroyed(e);
 
-			mSystemManager->EntityDestroyed(e);
+			mSystemManager->EntityDestroyed(e, signature);
 		}
 	}
 
-	void DestroyAllEntities()
+	/**
+	 * Creates `count` unnamed Entities at once, each starting
+	 * with a copy of every prototype Component. IDs are handed
+	 * out, Components stored and Systems updated in bulk, so
+	 * this is much cheaper than creating the Entities one by one.
+	 * 
+	 * ```
+	 * auto bullets = cd->CreateEntities(2000, Transform(), RectangleCollider());
+	 * ```
+	 * 
+	 * @tparam Ts The subclasses of Component to attach.
+	 * @param count The number of Entities to create.
+	 * @param prototypes The Components to copy to every Entity.
+	 * 
+	 * @returns The new Entities, or an empty vector if there
+	 * isn't room for all of them.
+	*/
+	template<typename... Ts>
+	std::vector<Entity> CreateEntities(std::size_t count, const Ts&... prototypes)
 	{
-		if (mEntityManager->mEntities.empty())
-            return;
+		Signature signature;
+		for (ComponentType type : {mComponentManager->GetComponentType<Ts>()..., MAX_COMPONENTS})
+		{
+			if (type != MAX_COMPONENTS)
+			{
+				signature.set(type);
+			}
+		}
+		if (signature.count() != sizeof...(Ts))
+		{
+			throw std::runtime_error("Attempted to add to a nonexistent ComponentArray!");
+		}
 
-        std::map<std::string, Entity>::iterator before = mEntityManager->mEntities.begin();
-        std::map<std::string, Entity>::iterator after = mEntityManager->mEntities.begin();
-        after++;
+		std::vector<Entity> entities = mEntityManager->CreateEntities(count);
+		if (entities.empty())
+		{
+			return entities;
+		}
 
-        while (before != mEntityManager->mEntities.end())
-        {
-			mComponentManager->EntityDestroyed(before->second);
-			mSystemManager->EntityDestroyed(before->second);
-            mEntityManager->mSignatures[before->second].reset();
-            mEntityManager->mAvailableEntities.push(before->second);
-            mEntityManager->mEntities.erase(before);
-            before = after;
-            if (after != mEntityManager->mEntities.end())
-                after++;
-        }
+		mComponentManager->AddComponents(entities.data(), entities.size(), prototypes...);
+		for (Entity entity : entities)
+		{
+			mEntityManager->mSignatures[EntityIndex(entity)] = signature;
+		}
+
+		mSystemManager->EntitiesCreated(entities.data(), entities.size(), signature);
+		return entities;
 	}
 
+	/**
+	 * Destroys a batch of Entities. Every ComponentArray and
+	 * System is visited once for the whole batch rather than
+	 * once per Entity. Stale and repeated handles are skipped.
+	 * 
+	 * @param entities The Entities to destroy.
+	 * @param count The number of handles in `entities`.
+	*/
+	void DestroyEntities(const Entity* entities, std::size_t count)
+	{
+		std::vector<Entity> destroyed = mEntityManager->DestroyEntities(entities, count);
+		if (destroyed.empty())
+		{
+			return;
+		}
+
+		mComponentManager->EntitiesDestroyed(destroyed.data(), destroyed.size());
+		mSystemManager->EntitiesDestroyed(destroyed.data(), destroyed.size());
+	}
+
+	/**
+	 * @copydoc Coordinator::DestroyEntities(const Entity*, std::size_t)
+	*/
+	void DestroyEntities(const std::vector<Entity>& entities)
+	{
+		DestroyEntities(entities.data(), entities.size());
+	}
+
+	/**
+	 * Destroys every Entity at once. Each ComponentArray, System
+	 * and table of the EntityManager is emptied in one go, so the
+	 * cost doesn't grow with components times systems per Entity.
+	*/
+	void DestroyAllEntities()
+	{
+		mComponentManager->Clear();
+		mSystemManager->Clear();
+		mEntityManager->DestroyAllEntities();
+	}
+
+
+	/**
+	 * Applies, then clears, every command recorded in a
+	 * CommandBuffer (see CommandBuffer for the order they are
+	 * applied in). This is the sync point for deferred structural
+	 * changes, so don't call it while iterating the ECS.
+	 * 
+	 * Entities are created and destroyed in batches, and each
+	 * Entity whose Components changed has its System membership
+	 * re-evaluated once, however many commands touched it.
+	 * 
+	 * @param buffer The buffer to apply.
+	*/
+	void ApplyCommands(CommandBuffer& buffer);
+
 
 	/* COMPONENT METHODS */
 
@@ -159,21 +262,35 @@ public:
 	 * @param component The Component to add to the Entity
 	 * 
 	 * @returns True if the entity was successfully added,
-	 * false if it was not.
+	 * false if it was not (including when the Entity isn't alive).
 	*/
 	template<typename T>
     bool AddComponent(Entity entity, T component)
 	{
-		if (!mComponentManager->AddComponent<T>(entity, component))
+		ComponentType type = mComponentManager->GetComponentType<T>();
+		if (type == MAX_COMPONENTS)
+		{
+			throw std::runtime_error("Attempted to add to a nonexistent ComponentArray!");
+		}
+
+		// Stale handles share an index with a living (or freed) Entity,
+		// so they must never reach the storage
+		if (!mEntityManager->IsAlive(entity))
+		{
+			SPDLOG_ERROR("Attempted to add a Component to an Entity that isn't alive.");
+			return false;
+		}
+
+		if (!mComponentManager->AddComponent<T>(entity, std::move(component)))
         {
             return false;
         }
 
 		auto signature = mEntityManager->GetSignature(entity);
-		signature.set(mComponentManager->GetComponentType<T>(), true);
+		signature.set(type, true);
 		mEntityManager->SetSignature(entity, signature);
 
-		mSystemManager->EntitySignatureChanged(entity, signature);
+		mSystemManager->EntitySignatureChanged(entity, signature, type);
         return true;
 	}
 
@@ -187,17 +304,24 @@ public:
 	*/
 	void AddComponentToEntityFromText(Entity e, const std::string& typeName)
 	{
+		if (!mEntityManager->IsAlive(e))
+		{
+			SPDLOG_ERROR("Attempted to add a Component to an Entity that isn't alive.");
+			return;
+		}
+
 		if (!mComponentManager->AddComponentToEntityFromText(e, typeName))
 		{
 			SPDLOG_ERROR("Could not load component {}", typeName);
 			return;
 		}
 
+		ComponentType type = mComponentManager->GetComponentType(typeName);
 		auto signature = mEntityManager->GetSignature(e);
-		signature.set(mComponentManager->GetComponentType(typeName), true);
+		signature.set(type, true);
 		mEntityManager->SetSignature(e, signature);
 
-		mSystemManager->EntitySignatureChanged(e, signature);
+		mSystemManager->EntitySignatureChanged(e, signature, type);
 	}
 
 	/**
@@ -221,11 +345,12 @@ public:
             return false;
         }
 
+		ComponentType type = mComponentManager->GetComponentType<T>();
 		auto signature = mEntityManager->GetSignature(entity);
-		signature.set(mComponentManager->GetComponentType<T>(), false);
+		signature.set(type, false);
 		mEntityManager->SetSignature(entity, signature);
 
-		mSystemManager->EntitySignatureChanged(entity, signature);
+		mSystemManager->EntitySignatureChanged(entity, signature, type);
         return true;
 	}
 
@@ -238,6 +363,67 @@ public:
 		return mComponentManager->GetComponent<T>(entity);
 	}
 
+	/**
+	 * @copydoc ComponentManager::TryGetComponent()
+	*/
+	template<typename T>
+	T* TryGetComponent(Entity entity)
+	{
+		return mComponentManager->TryGetComponent<T>(entity);
+	}
+
+	/**
+	 * Creates a ComponentView over every Entity owning all of
+	 * the Components in Ts, for iterating them without calling
+	 * GetComponent() per Entity:
+	 * 
+	 * ```
+	 * cd->View<Transform, RectangleCollider>().ForEach(
+	 *     [](Entity e, Transform& t, RectangleCollider& c) { ... });
+	 * ```
+	 * 
+	 * @tparam Ts The subclasses of Component to view.
+	 * 
+	 * @returns The view (a ComponentView, or an ArchetypeView with
+	 * ROCKET_ARCHETYPE_STORAGE), which is empty if any of Ts isn't
+	 * registered.
+	*/
+	template<typename... Ts>
+	auto View()
+	{
+		return mComponentManager->View<Ts...>(mEntityManager->mSignatures.data());
+	}
+
+	/**
+	 * Runs `func` for every Entity owning all of the Components
+	 * in Ts, like View<Ts...>().ForEach(func), but split into
+	 * chunks spread over the Coordinator's ThreadPool.
+	 * 
+	 * @note `func` runs on several threads at once, so it must
+	 * only touch the Entity and Components it is given (and
+	 * record structural changes in a CommandBuffer).
+	 * 
+	 * @tparam Ts The subclasses of Component to visit.
+	 * @param func A callable taking an Entity followed by a
+	 * reference to each Component in Ts.
+	 * @param grain The number of Entities per chunk, rounded up
+	 * to whole cache lines. Chunks don't depend on thread count.
+	*/
+	template<typename... Ts, typename F>
+	void ParallelForEach(F&& func, std::size_t grain = DEFAULT_GRAIN_SIZE)
+	{
+		View<Ts...>().ParallelForEach(GetThreadPool(), std::forward<F>(func), grain);
+	}
+
+	/**
+	 * @copydoc ComponentManager::SortByComponent()
+	*/
+	template<typename T>
+	bool SortByComponent(EntitySet& entities)
+	{
+		return mComponentManager->SortByComponent<T>(entities);
+	}
+
 	/**
 	 * @copydoc ComponentManager::GetComponentAbstract()
 	*/
@@ -246,6 +432,22 @@ public:
 		return mComponentManager->GetComponentAbstract(typeName, entity);
 	}
 
+	/**
+	 * @copydoc ComponentManager::GetComponentProperties()
+	*/
+	const PropertyTable* GetComponentProperties(const std::string& typeName)
+	{
+		return mComponentManager->GetComponentProperties(typeName);
+	}
+
+	/**
+	 * @copydoc ComponentManager::SetComponentPropertyFromText()
+	*/
+	bool SetComponentPropertyFromText(Entity e, const std::string& typeName, const std::string& property, const Property& value)
+	{
+		return mComponentManager->SetComponentPropertyFromText(e, typeName, property, value);
+	}
+
 	/**
 	 * @copydoc ComponentManager::GetComponentType()
 	*/
@@ -286,13 +488,142 @@ public:
 		return mSystemManager->SetSignature<T>(signature);
 	}
 
+	/**
+	 * @copydoc SystemManager::AddSystemOrdering()
+	*/
+	template<typename Before, typename After>
+	bool AddSystemOrdering()
+	{
+		return mSystemManager->AddSystemOrdering<Before, After>();
+	}
+
+	/**
+	 * Runs the Update() of every registered System once, on the
+	 * Coordinator's ThreadPool. Systems whose declared accesses
+	 * (System::GetAccess()) don't conflict, and that aren't
+	 * ordered by AddSystemOrdering(), run at the same time.
+	 * Structural changes made during the frame should go through
+	 * a CommandBuffer applied after this returns.
+	*/
+	void RunSystems()
+	{
+		mSystemManager->RunSystems(&GetThreadPool());
+	}
+
+	/**
+	 * @copydoc SystemManager::GetFrameTimings()
+	*/
+	const FrameTimings& GetFrameTimings() const
+	{
+		return mSystemManager->GetFrameTimings();
+	}
+
+	/**
+	 * @copydoc SystemManager::GetSystemTime()
+	*/
+	template<typename T>
+	std::chrono::nanoseconds GetSystemTime()
+	{
+		return mSystemManager->GetSystemTime<T>();
+	}
+
+	/**
+	 * @copydoc SystemManager::SystemDependsOn()
+	*/
+	template<typename After, typename Before>
+	bool SystemDependsOn()
+	{
+		return mSystemManager->SystemDependsOn<After, Before>();
+	}
+
+
+	/* THREADING METHODS */
+
+
+	/**
+	 * Returns the ThreadPool the Coordinator runs parallel work
+	 * on, starting it (with ThreadPool::DefaultWorkerCount()
+	 * workers) the first time it is needed.
+	 * 
+	 * @returns The Coordinator's ThreadPool.
+	*/
+	ThreadPool& GetThreadPool()
+	{
+		if (mThreadPool == nullptr)
+		{
+			mThreadPool = std::make_unique<ThreadPool>(ThreadPool::DefaultWorkerCount());
+		}
+		return *mThreadPool;
+	}
+
+	/**
+	 * Replaces the Coordinator's ThreadPool with one of the
+	 * given size. Don't call this while parallel work is running.
+	 * 
+	 * @param workers The number of worker threads; 0 runs
+	 * everything on the calling thread.
+	*/
+	void SetWorkerCount(std::size_t workers)
+	{
+		mThreadPool = std::make_unique<ThreadPool>(workers);
+	}
+
 protected:
 	/** Pointer to the instantiated Coordinator singleton */
 	static Coordinator* mCoordinatorPtr;
 
 private:
-	std::unique_ptr<ComponentManager> mComponentManager;
+	friend class CommandBuffer;
+
+	/**
+	 * Adds a Component and sets its Signature bit, leaving System
+	 * membership to the caller. Fails (without throwing) for dead
+	 * Entities and unregistered Components.
+	*/
+	template<typename T>
+	bool AddComponentUnsynced(Entity entity, T component)
+	{
+		ComponentType type = mComponentManager->GetComponentType<T>();
+		if (type == MAX_COMPONENTS || !mEntityManager->IsAlive(entity))
+		{
+			SPDLOG_ERROR("Could not add a deferred Component to an Entity.");
+			return false;
+		}
+
+		if (!mComponentManager->AddComponent<T>(entity, std::move(component)))
+		{
+			return false;
+		}
+		mEntityManager->mSignatures[EntityIndex(entity)].set(type, true);
+		return true;
+	}
+
+	/**
+	 * Removes a Component and clears its Signature bit, leaving
+	 * System membership to the caller. Fails (without throwing)
+	 * for dead Entities and unregistered Components.
+	*/
+	template<typename T>
+	bool RemoveComponentUnsynced(Entity entity)
+	{
+		ComponentType type = mComponentManager->GetComponentType<T>();
+		if (type == MAX_COMPONENTS || !mEntityManager->IsAlive(entity))
+		{
+			SPDLOG_ERROR("Could not remove a deferred Component from an Entity.");
+			return false;
+		}
+
+		if (!mComponentManager->RemoveComponent<T>(entity))
+		{
+			return false;
+		}
+		mEntityManager->mSignatures[EntityIndex(entity)].set(type, false);
+		return true;
+	}
+
+	std::unique_ptr<ComponentStorage> mComponentManager;
 	std::unique_ptr<EntityManager> mEntityManager;
 	std::unique_ptr<SystemManager> mSystemManager;
+	std::unique_ptr<ThreadPool> mThreadPool;
 };
 
@@ -17,7 +17,46 @@
 
 #include <cstdint>
 
+/**
+ * An Entity handle. The low ENTITY_INDEX_BITS bits are the
+ * Entity's index (its slot in every per-Entity array), and the
+ * high bits are the generation of that slot, which changes each
+ * time the slot is freed. A handle kept after its Entity was
+ * destroyed therefore never matches whatever reuses the slot.
+ * 
+ * A handle whose generation is 0 is equal to its index, so the
+ * first Entity created in each slot still reads as 0, 1, 2...
+*/
 using Entity = std::uint32_t;
 
+/** The number of bits of an Entity handle holding its index. */
+const std::uint32_t ENTITY_INDEX_BITS = 20;
+
+/** The mask selecting the index bits of an Entity handle. */
+const Entity ENTITY_INDEX_MASK = (Entity(1) << ENTITY_INDEX_BITS) - 1;
+
+/** The mask selecting a generation once shifted down (generations wrap). */
+const std::uint32_t ENTITY_GENERATION_MASK = (std::uint32_t(1) << (32 - ENTITY_INDEX_BITS)) - 1;
+
 /** The maximum number of entities allowed in the scene. */
 const Entity MAX_ENTITIES = 5000;
+
+static_assert(MAX_ENTITIES <= ENTITY_INDEX_MASK, "MAX_ENTITIES must fit in the index bits of an Entity");
+
+/** @returns The index (slot) part of an Entity handle. */
+inline std::uint32_t EntityIndex(Entity entity)
+{
+    return entity & ENTITY_INDEX_MASK;
+}
+
+/** @returns The generation part of an Entity handle. */
+inline std::uint32_t EntityGeneration(Entity entity)
+{
+    return entity >> ENTITY_INDEX_BITS;
+}
+
+/** @returns The Entity handle of a slot at a given generation. */
+inline Entity MakeEntity(std::uint32_t index, std::uint32_t generation)
+{
+    return ((generation & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS) | index;
+}
@@ -1,9 +1,11 @@
 #pragma once
 
-#include <queue>
+#include <algorithm>
 #include <array>
 #include <map>
+#include <numeric>
 #include <string>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 
@@ -15,25 +17,73 @@ class EntityManager
     friend class Coordinator;
 
 private:
-    std::queue<Entity> mAvailableEntities;
+    // Free Entity indices (not handles), reused in FIFO order: a ring
+    // buffer popped at mAvailableHead and pushed at mAvailableTail
+    std::array<std::uint32_t, MAX_ENTITIES> mAvailableEntities;
+    std::uint32_t mAvailableHead = 0;
+    std::uint32_t mAvailableTail = 0;
     std::uint32_t mLivingCount = 0;
+    // Indexed by EntityIndex()
     std::array<Signature, MAX_ENTITIES> mSignatures;
+    // The current generation of each index, bumped when it is freed
+    std::array<std::uint32_t, MAX_ENTITIES> mGenerations{};
+    // Whether each index currently belongs to a living Entity
+    std::array<bool, MAX_ENTITIES> mAlive{};
     std::map<std::string, Entity> mEntities;
+    // The name of each index in mEntities, or mEntities.end() if unnamed
+    std::vector<std::map<std::string, Entity>::iterator> mNames;
 
-public:
-    EntityManager()
+    /**
+     * Frees an Entity's index: clears its Signature and name, and
+     * bumps its generation so every existing handle to it goes stale.
+    */
+    void FreeIndex(Entity entity)
     {
-        for (Entity e = 0; e < MAX_ENTITIES; e++)
+        std::uint32_t index = EntityIndex(entity);
+        if (mNames[index] != mEntities.end())
         {
-            mAvailableEntities.push(e);
+            mEntities.erase(mNames[index]);
+            mNames[index] = mEntities.end();
         }
+        mSignatures[index].reset();
+        mGenerations[index] = (mGenerations[index] + 1) & ENTITY_GENERATION_MASK;
+        mAlive[index] = false;
+        PushAvailable(index);
+    }
+
+    void PushAvailable(std::uint32_t index)
+    {
+        mAvailableEntities[mAvailableTail] = index;
+        mAvailableTail = (mAvailableTail + 1) % MAX_ENTITIES;
+    }
+
+    std::uint32_t PopAvailable()
+    {
+        std::uint32_t index = mAvailableEntities[mAvailableHead];
+        mAvailableHead = (mAvailableHead + 1) % MAX_ENTITIES;
+        return index;
+    }
+
+    /** Makes every index free again, in order. */
+    void ResetAvailable()
+    {
+        std::iota(mAvailableEntities.begin(), mAvailableEntities.end(), 0);
+        mAvailableHead = 0;
+        mAvailableTail = 0;
+    }
+
+public:
+    EntityManager()
+        : mNames(MAX_ENTITIES, mEntities.end())
+    {
+        ResetAvailable();
     }
 
     /**
      * Creates an Entity with a unique ID. If there are
      * too many entities in existence, returns MAX_ENTITIES.
      * 
-     * @returns On Error - MAX_ENTITIES, else the new Entity ID.
+     * @returns On Error - MAX_ENTITIES, else the new Entity handle.
     */
     Entity CreateEntity(const std::string& ent_name)
     {
@@ -42,16 +92,105 @@ public:
 	        SPDLOG_ERROR("Tried to instantiate an entity past the Entity limit.");
             return MAX_ENTITIES;
         }
-        Entity id = mAvailableEntities.front();
-        mAvailableEntities.pop();
+        std::uint32_t index = PopAvailable();
 
-        mEntities.emplace(ent_name, id);
+        Entity id = MakeEntity(index, mGenerations[index]);
+        mAlive[index] = true;
+        auto [it, inserted] = mEntities.emplace(ent_name, id);
+        if (inserted)
+        {
+            mNames[index] = it;
+        }
 
         mLivingCount++;
 
         return id;
     }
 
+    /**
+     * Creates `count` unnamed Entities at once. Either all of
+     * them are created, or (if that would pass the Entity limit)
+     * none are.
+     * 
+     * @returns The new Entity handles, or an empty vector on error.
+    */
+    std::vector<Entity> CreateEntities(std::size_t count)
+    {
+        std::vector<Entity> entities;
+        if (count > MAX_ENTITIES - mLivingCount)
+        {
+	        SPDLOG_ERROR("Tried to instantiate {} entities past the Entity limit.", count);
+            return entities;
+        }
+
+        entities.reserve(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            std::uint32_t index = PopAvailable();
+
+            mAlive[index] = true;
+            entities.push_back(MakeEntity(index, mGenerations[index]));
+        }
+
+        mLivingCount += static_cast<std::uint32_t>(count);
+        return entities;
+    }
+
+    /**
+     * Destroys every living Entity in a list of handles, skipping
+     * stale and repeated ones.
+     * 
+     * @param entities The Entities to destroy.
+     * @param count The number of handles in `entities`.
+     * 
+     * @returns The Entities that were actually destroyed.
+    */
+    std::vector<Entity> DestroyEntities(const Entity* entities, std::size_t count)
+    {
+        std::vector<Entity> destroyed;
+        destroyed.reserve(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (IsAlive(entities[i]))
+            {
+                FreeIndex(entities[i]);
+                destroyed.push_back(entities[i]);
+            }
+        }
+
+        mLivingCount -= static_cast<std::uint32_t>(destroyed.size());
+        return destroyed;
+    }
+
+    /** @returns The handle of every living Entity, in index order. */
+    std::vector<Entity> LivingEntities() const
+    {
+        std::vector<Entity> entities;
+        entities.reserve(mLivingCount);
+        for (std::uint32_t index = 0; index < MAX_ENTITIES; index++)
+        {
+            if (mAlive[index])
+            {
+                entities.push_back(MakeEntity(index, mGenerations[index]));
+            }
+        }
+        return entities;
+    }
+
+    /**
+     * Checks whether a handle refers to a living Entity. Handles
+     * kept past their Entity's destruction fail this check, even
+     * once the index has been reused.
+     * 
+     * @returns True if the Entity is alive, false otherwise.
+    */
+    bool IsAlive(Entity entity) const
+    {
+        std::uint32_t index = EntityIndex(entity);
+        return index < MAX_ENTITIES && mAlive[index]
+            && mGenerations[index] == EntityGeneration(entity);
+    }
+
     Entity GetEntity(const std::string& ent_name)
     {
         std::map<std::string, Entity>::iterator it;
@@ -66,7 +205,7 @@ public:
     /**
      * Takes an entity's ID and destroys the signatures
      * associated with it, as well as adding the Entity's
-     * ID back to the ID queue.
+     * ID back to the free list.
      * 
      * @returns false if entity is out of range, true otherwise.
     */
@@ -79,31 +218,33 @@ public:
             return false;
         }
 
-        mSignatures[it->second].reset();
-        mAvailableEntities.push(it->second);
-        mEntities.erase(it);
+        FreeIndex(it->second);
         mLivingCount--;
         return true;
     }
 
+    /**
+     * Destroys every Entity at once: names, Signatures and the
+     * free list are reset wholesale, and every living index has
+     * its generation bumped so no old handle stays valid.
+    */
     void DestroyAllEntities()
     {
-        if (mEntities.empty())
-            return;
-
-        std::map<std::string, Entity>::iterator before = mEntities.begin();
-        std::map<std::string, Entity>::iterator after = mEntities.begin();
-        after++;
-
-        while (before != mEntities.end())
+        for (std::uint32_t index = 0; index < MAX_ENTITIES; index++)
         {
-            mSignatures[before->second].reset();
-            mAvailableEntities.push(before->second);
-            mEntities.erase(before);
-            before = after;
-            if (after != mEntities.end())
-                after++;
+            if (mAlive[index])
+            {
+                mSignatures[index].reset();
+                mGenerations[index] = (mGenerations[index] + 1) & ENTITY_GENERATION_MASK;
+                mAlive[index] = false;
+            }
         }
+
+        mEntities.clear();
+        std::fill(mNames.begin(), mNames.end(), mEntities.end());
+
+        ResetAvailable();
+        mLivingCount = 0;
     }
 
     /**
@@ -113,13 +254,13 @@ public:
     */
     bool SetSignature(Entity entity, Signature signature)
     {
-        if (entity >= MAX_ENTITIES)
+        if (EntityIndex(entity) >= MAX_ENTITIES)
         {
 	        SPDLOG_ERROR("Entity ID supplied to SetSignature is out of range.");
             return false;
         }
 
-        mSignatures[entity] = signature;
+        mSignatures[EntityIndex(entity)] = signature;
         return true;
     }
 
@@ -130,13 +271,13 @@ public:
     */
     Signature GetSignature(Entity entity)
     {
-        if (entity >= MAX_ENTITIES)
+        if (EntityIndex(entity) >= MAX_ENTITIES)
         {
 	        SPDLOG_ERROR("Entity ID supplied to GetSignature is out of range.");
             return Signature(0);
         }
 
-        return mSignatures[entity];
+        return mSignatures[EntityIndex(entity)];
     }
 };
 
@@ -0,0 +1,124 @@
+#ifndef _ROC_ENTITY_SET_H_
+#define _ROC_ENTITY_SET_H_
+
+/**
+ * @file EntitySet.hpp
+ *
+ * This file defines the EntitySet class, the container
+ * holding the Entities a System affects.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Entity.hpp"
+#include "SparseSet.hpp"
+
+/**
+ * @class EntitySet
+ *
+ * A set of Entities with O(1) insert, erase and lookup that
+ * iterates over one contiguous array. It keeps the
+ * std::set-style interface that System::mEntities has always
+ * had, but it is backed by a SparseSet, so iteration doesn't
+ * chase pointers and membership churn doesn't allocate once
+ * the set has grown (or been reserved) to its working size.
+ *
+ * @note Erasing moves the last Entity into the erased slot,
+ * so iteration order isn't insertion order. Use SortBy() to
+ * put the Entities back in a useful order.
+*/
+class EntitySet
+{
+public:
+	using const_iterator = std::vector<Entity>::const_iterator;
+
+	/**
+	 * Adds an Entity to the set.
+	 *
+	 * @returns True if the Entity was added, false if it was
+	 * already in the set.
+	*/
+	bool insert(Entity entity)
+	{
+		if (mSet.Contains(entity))
+		{
+			return false;
+		}
+		mSet.Insert(entity);
+		return true;
+	}
+
+	/**
+	 * Removes an Entity from the set.
+	 *
+	 * @returns The number of Entities removed (0 or 1).
+	*/
+	std::size_t erase(Entity entity)
+	{
+		if (!mSet.Contains(entity))
+		{
+			return 0;
+		}
+		mSet.Remove(entity);
+		return 1;
+	}
+
+	/** @returns 1 if the Entity is in the set, 0 otherwise. */
+	std::size_t count(Entity entity) const { return mSet.Contains(entity) ? 1 : 0; }
+
+	/** @returns True if the Entity is in the set. */
+	bool contains(Entity entity) const { return mSet.Contains(entity); }
+
+	/** @copydoc SparseSet::Clear() */
+	void clear() { mSet.Clear(); }
+
+	/** @copydoc SparseSet::Reserve() */
+	void reserve(std::size_t capacity) { mSet.Reserve(capacity); }
+
+	std::size_t size() const { return mSet.Size(); }
+	bool empty() const { return mSet.Empty(); }
+
+	/** @returns A pointer to the contiguous array of Entities. */
+	const Entity* data() const { return mSet.Data(); }
+
+	/** @returns The Entity at the given position in the array. */
+	Entity operator[](std::size_t index) const { return mSet[index]; }
+
+	const_iterator begin() const { return mSet.begin(); }
+	const_iterator end() const { return mSet.end(); }
+
+	/**
+	 * Orders the set by each Entity's position in another
+	 * SparseSet, usually the one behind a ComponentArray, so
+	 * that iterating the set walks that array front to back.
+	 * Entities missing from `order` go last.
+	 *
+	 * @param order The set to take the ordering from.
+	*/
+	void SortBy(const SparseSet& order)
+	{
+		SortByKey([&order](Entity e)
+		{
+			return order.Contains(e) ? order.IndexOf(e) : SIZE_MAX;
+		});
+	}
+
+	/**
+	 * Orders the set by a key computed for each Entity.
+	 *
+	 * @param key A callable mapping an Entity to a value
+	 * comparable with `<`.
+	*/
+	template<typename Key>
+	void SortByKey(Key key)
+	{
+		mSet.Sort([&key](Entity a, Entity b) { return key(a) < key(b); });
+	}
+
+private:
+	SparseSet mSet;
+};
+
+#endif
@@ -1,70 +1,125 @@
 #ifndef _ROC_ICOMPONENT_ARRAY_H_
 #define _ROC_ICOMPONENT_ARRAY_H_
 
-#include <array>
-#include <unordered_map>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 
 #include "Entity.hpp"
 #include "Component.hpp"
+#include "SparseSet.hpp"
 
 class IComponentArray
 {
 public:
 	virtual ~IComponentArray() = default;
 	virtual void EntityDestroyed(Entity entity) = 0;
+	virtual void EntitiesDestroyed(const Entity* entities, size_t count) = 0;
+	virtual void Clear() = 0;
 };
 
 template<typename T>
 class ComponentArray : public IComponentArray
 {
 public:
+	/** The number of components stored in one page of the packed array. */
+	static constexpr size_t PAGE_SIZE = 256;
+
+	ComponentArray() = default;
+	ComponentArray(const ComponentArray&) = delete;
+	ComponentArray& operator=(const ComponentArray&) = delete;
+
+	~ComponentArray()
+	{
+		DestroyAll();
+	}
+
 	bool InsertData(Entity entity, T component)
 	{
-		if (mEntityToIndexMap.find(entity) != mEntityToIndexMap.end())
+		// Any generation of the index counts, since the sparse set
+		// holds one entry per index
+		if (mEntitySet.ContainsIndex(entity))
         {
             SPDLOG_ERROR("Attempting to add another duplicate component to entity.");
             return false;
         }
 
-		// Put new entry at end and update the maps
-		size_t newIndex = mSize;
-		mEntityToIndexMap[entity] = newIndex;
-		mIndexToEntityMap[newIndex] = entity;
-		mComponentArray[newIndex] = component;
-		++mSize;
+		// Make sure the page for the new entry exists before touching the set
+		size_t newIndex = mEntitySet.Size();
+		if (newIndex / PAGE_SIZE >= mPages.size())
+		{
+			mPages.emplace_back(new Page);
+		}
+
+		// Put new entry at end, parallel to the entity in the dense set
+		mEntitySet.Insert(entity);
+		new (Slot(newIndex)) T(std::move(component));
         return true;
 	}
 
+	/**
+	 * Attaches a copy of one component to each of a batch of
+	 * entities, allocating every page the batch needs up front.
+	 * Nothing is inserted if any of the entities already has one.
+	*/
+	bool InsertBatch(const Entity* entities, size_t count, const T& prototype)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			if (mEntitySet.ContainsIndex(entities[i]))
+			{
+				SPDLOG_ERROR("Attempting to add another duplicate component to entity.");
+				return false;
+			}
+		}
+
+		size_t newIndex = mEntitySet.Size();
+		while ((newIndex + count + PAGE_SIZE - 1) / PAGE_SIZE > mPages.size())
+		{
+			mPages.emplace_back(new Page);
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			mEntitySet.Insert(entities[i]);
+			new (Slot(newIndex + i)) T(prototype);
+		}
+		return true;
+	}
+
 	bool RemoveData(Entity entity)
 	{
-		if (mEntityToIndexMap.find(entity) == mEntityToIndexMap.end())
+		if (!mEntitySet.Contains(entity))
         {
             SPDLOG_ERROR("Could not find the entity in the index map.");
             return false;
         }
 
-		// Copy element at end into deleted element's place to maintain density
-		size_t indexOfRemovedEntity = mEntityToIndexMap[entity];
-		size_t indexOfLastElement = mSize - 1;
-		mComponentArray[indexOfRemovedEntity] = mComponentArray[indexOfLastElement];
-
-		// Update map to point to moved spot
-		Entity entityOfLastElement = mIndexToEntityMap[indexOfLastElement];
-		mEntityToIndexMap[entityOfLastElement] = indexOfRemovedEntity;
-		mIndexToEntityMap[indexOfRemovedEntity] = entityOfLastElement;
-
-		mEntityToIndexMap.erase(entity);
-		mIndexToEntityMap.erase(indexOfLastElement);
+		// Move element at end into deleted element's place to maintain density
+		size_t indexOfLastElement = mEntitySet.Size() - 1;
+		size_t indexOfRemovedEntity = mEntitySet.Remove(entity);
+		if (indexOfRemovedEntity != indexOfLastElement)
+		{
+			*Slot(indexOfRemovedEntity) = std::move(*Slot(indexOfLastElement));
+		}
+		Slot(indexOfLastElement)->~T();
 
-		--mSize;
+		// Give back trailing pages, keeping one spare so churn at a
+		// page boundary doesn't allocate every time
+		size_t pagesInUse = (mEntitySet.Size() + PAGE_SIZE - 1) / PAGE_SIZE;
+		while (mPages.size() > pagesInUse + 1)
+		{
+			mPages.pop_back();
+		}
         return true;
 	}
 
 	T& GetData(Entity entity)
 	{
-		if (mEntityToIndexMap.find(entity) == mEntityToIndexMap.end())
+		if (!mEntitySet.Contains(entity))
         {
             /** @todo PLEASE FIX THIS, I HATE THIS CODE */
 			SPDLOG_ERROR("Cannot find entity in index map.");
@@ -72,33 +127,102 @@ public:
         }
 
 		// Return a reference to the entity's component
-		return mComponentArray[mEntityToIndexMap[entity]];
+		return *Slot(mEntitySet.IndexOf(entity));
+	}
+
+	/**
+	 * Returns the entity's component, or nullptr if it has none
+	 * (or the handle is stale), without logging.
+	*/
+	T* TryGetData(Entity entity)
+	{
+		return mEntitySet.Contains(entity) ? Slot(mEntitySet.IndexOf(entity)) : nullptr;
 	}
 
 	void EntityDestroyed(Entity entity) override
 	{
-		if (mEntityToIndexMap.find(entity) != mEntityToIndexMap.end())
+		if (mEntitySet.Contains(entity))
 		{
 			// Remove the entity's component if it existed
 			RemoveData(entity);
 		}
 	}
 
+	void EntitiesDestroyed(const Entity* entities, size_t count) override
+	{
+		for (size_t i = 0; i < count && !mEntitySet.Empty(); i++)
+		{
+			if (mEntitySet.Contains(entities[i]))
+			{
+				RemoveData(entities[i]);
+			}
+		}
+	}
+
+	/**
+	 * Removes every component at once: one destructor pass over
+	 * the packed pages (nothing at all for trivially destructible
+	 * components), then the entity set is emptied. One page is
+	 * kept for refilling.
+	*/
+	void Clear() override
+	{
+		DestroyAll();
+		mEntitySet.Clear();
+		if (mPages.size() > 1)
+		{
+			mPages.resize(1);
+		}
+	}
+
+	/**
+	 * Returns the component at a position in the packed array,
+	 * without any checks.
+	 *
+	 * @param index A position below Size().
+	*/
+	T& At(size_t index) { return *Slot(index); }
+
+	/** @returns The number of components in the array. */
+	size_t Size() const { return mEntitySet.Size(); }
+
+	/**
+	 * @returns The set of entities owning a component, in
+	 * the same order as the packed components.
+	*/
+	const SparseSet& Entities() const { return mEntitySet; }
+
 private:
-	// The packed array of components (of generic type T),
-	// set to a specified maximum amount, matching the maximum number
-	// of entities allowed to exist simultaneously, so that each entity
-	// has a unique spot.
-	std::array<T, MAX_ENTITIES> mComponentArray;
+	// A fixed-size block of raw, suitably aligned memory for PAGE_SIZE
+	// components. Components are only constructed in the slots that
+	// are in use.
+	struct alignas(alignof(T) > 64 ? alignof(T) : 64) Page
+	{
+		unsigned char bytes[sizeof(T) * PAGE_SIZE];
+	};
+
+	T* Slot(size_t index)
+	{
+		return reinterpret_cast<T*>(mPages[index / PAGE_SIZE]->bytes) + index % PAGE_SIZE;
+	}
 
-	// Map from an entity ID to an array index.
-	std::unordered_map<Entity, size_t> mEntityToIndexMap;
+	// Destroys every live component, a page at a time
+	void DestroyAll()
+	{
+		for (size_t first = 0; first < mEntitySet.Size(); first += PAGE_SIZE)
+		{
+			std::destroy_n(Slot(first), std::min(PAGE_SIZE, mEntitySet.Size() - first));
+		}
+	}
 
-	// Map from an array index to an entity ID.
-	std::unordered_map<size_t, Entity> mIndexToEntityMap;
+	// The packed array of components (of generic type T), split into
+	// pages that are allocated as the array grows, so memory scales
+	// with the number of components actually attached.
+	std::vector<std::unique_ptr<Page>> mPages;
 
-	// Total size of valid entries in the array.
-	size_t mSize;
+	// Sparse set mapping entity IDs to array indices, whose dense
+	// side runs parallel to the packed components.
+	SparseSet mEntitySet;
 };
 
 #endif
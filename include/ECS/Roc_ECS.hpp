@@ -16,19 +16,33 @@
 #include "Component.hpp"
 #include "EntityManager.hpp"
 #include "ComponentManager.hpp"
+#include "ArchetypeManager.hpp"
+#include "ThreadPool.hpp"
+#include "SystemScheduler.hpp"
 #include "SystemManager.hpp"
 #include "Coordinator.hpp"
+#include "CommandBuffer.hpp"
 
 // Components
 
 #include "Components/Transform.hpp"
 #include "Components/Gravity.hpp"
+#include "Components/Velocity.hpp"
 #include "Components/Sprite.hpp"
 #include "Components/RectangleCollider.hpp"
 
 // Systems
 
 #include "Systems/RenderSpriteSys.hpp"
+#include "Systems/Broadphase.hpp"
+#include "Systems/PairSet.hpp"
+#include "Systems/SpatialHash.hpp"
+#include "Systems/AABBTree.hpp"
+#include "Systems/SweepAndPrune.hpp"
+#include "Systems/StaticIndex.hpp"
+#include "Systems/Narrowphase.hpp"
+#include "Systems/ContactBuffer.hpp"
 #include "Systems/CollisionSystem.hpp"
+#include "Systems/IntegrationSystem.hpp"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,234 @@
+#ifndef _ROC_SPARSE_SET_H_
+#define _ROC_SPARSE_SET_H_
+
+/**
+ * @file SparseSet.hpp
+ *
+ * This file defines the SparseSet class, the index structure
+ * behind every ComponentArray. It maps an Entity to a slot in
+ * a densely packed array (and back) with plain array indexing,
+ * so no hashing happens on any lookup, insertion or removal.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "Entity.hpp"
+
+/**
+ * @class SparseSet
+ *
+ * A paged sparse set of Entities. The sparse side is an array
+ * of pages indexed by EntityIndex(), allocated only when an Entity in
+ * that page is first inserted. Each sparse entry holds the
+ * position of the Entity inside the dense array, which in turn
+ * is kept parallel to whatever packed data the owner stores.
+ *
+ * Removal swaps the last dense element into the removed slot,
+ * so owners of parallel arrays should mirror that swap.
+ *
+ * The dense array holds full Entity handles, so a stale handle
+ * (same index, older generation) is never reported as contained.
+*/
+class SparseSet
+{
+public:
+	/** The number of sparse entries held by one page (a power of two). */
+	static constexpr std::size_t PAGE_SIZE = 1024;
+
+	/** The value stored in a sparse entry whose Entity is not in the set. */
+	static constexpr std::uint32_t INVALID_INDEX = UINT32_MAX;
+
+	/**
+	 * Checks whether the Entity is in the set.
+	 *
+	 * @param entity The Entity to search for.
+	 *
+	 * @returns True if the Entity is in the set, false otherwise.
+	*/
+	bool Contains(Entity entity) const
+	{
+		std::uint32_t index = EntityIndex(entity);
+		std::size_t page = index / PAGE_SIZE;
+		if (page >= mSparse.size() || mSparse[page] == nullptr)
+		{
+			return false;
+		}
+
+		std::uint32_t dense = mSparse[page][index % PAGE_SIZE];
+		return dense != INVALID_INDEX && mDense[dense] == entity;
+	}
+
+	/**
+	 * Checks whether any generation of the Entity's index is in
+	 * the set.
+	 *
+	 * @param entity An Entity handle of the index to search for.
+	 *
+	 * @returns True if the set holds an Entity with that index.
+	*/
+	bool ContainsIndex(Entity entity) const
+	{
+		std::uint32_t index = EntityIndex(entity);
+		std::size_t page = index / PAGE_SIZE;
+		return page < mSparse.size() && mSparse[page] != nullptr
+			&& mSparse[page][index % PAGE_SIZE] != INVALID_INDEX;
+	}
+
+	/**
+	 * Returns the dense position of an Entity. The Entity
+	 * must be in the set - check with Contains() first.
+	 *
+	 * @param entity The Entity to look up.
+	 *
+	 * @returns The index of the Entity in the dense array.
+	*/
+	std::size_t IndexOf(Entity entity) const
+	{
+		return Entry(entity);
+	}
+
+	/**
+	 * Appends an Entity to the end of the dense array. No
+	 * Entity with the same index may already be in the set.
+	 *
+	 * @param entity The Entity to insert.
+	 *
+	 * @returns The dense index the Entity was placed at.
+	*/
+	std::size_t Insert(Entity entity)
+	{
+		std::size_t index = mDense.size();
+		SparseEntry(entity) = static_cast<std::uint32_t>(index);
+		mDense.push_back(entity);
+		return index;
+	}
+
+	/**
+	 * Removes an Entity by moving the last dense element into
+	 * its slot. The Entity must be in the set.
+	 *
+	 * @param entity The Entity to remove.
+	 *
+	 * @returns The dense index the Entity used to occupy, which
+	 * now holds what was previously the last element.
+	*/
+	std::size_t Remove(Entity entity)
+	{
+		std::size_t index = IndexOf(entity);
+		Entity last = mDense.back();
+
+		mDense[index] = last;
+		Entry(last) = static_cast<std::uint32_t>(index);
+
+		Entry(entity) = INVALID_INDEX;
+		mDense.pop_back();
+		return index;
+	}
+
+	/**
+	 * Removes every Entity from the set. Sparse pages are kept
+	 * (with their entries invalidated) so refilling the set
+	 * doesn't allocate.
+	*/
+	void Clear()
+	{
+		for (Entity entity : mDense)
+		{
+			Entry(entity) = INVALID_INDEX;
+		}
+		mDense.clear();
+	}
+
+	/**
+	 * Reorders the dense array and updates the sparse entries
+	 * to match.
+	 *
+	 * @param compare A strict weak ordering on Entities.
+	*/
+	template<typename Compare>
+	void Sort(Compare compare)
+	{
+		std::sort(mDense.begin(), mDense.end(), compare);
+		for (std::size_t i = 0; i < mDense.size(); i++)
+		{
+			Entry(mDense[i]) = static_cast<std::uint32_t>(i);
+		}
+	}
+
+	/**
+	 * Allocates room for `capacity` Entities up front, so
+	 * inserting that many never allocates.
+	 *
+	 * @param capacity The number of Entities to make room for.
+	*/
+	void Reserve(std::size_t capacity)
+	{
+		mDense.reserve(capacity);
+		for (std::uint32_t index = 0; index < capacity; index += PAGE_SIZE)
+		{
+			SparseEntry(index);
+		}
+	}
+
+	/** @returns The number of Entities in the set. */
+	std::size_t Size() const { return mDense.size(); }
+
+	/** @returns True if the set holds no Entities. */
+	bool Empty() const { return mDense.empty(); }
+
+	/** @returns A pointer to the dense array of Entities. */
+	const Entity* Data() const { return mDense.data(); }
+
+	/** @returns The Entity at the given dense index. */
+	Entity operator[](std::size_t index) const { return mDense[index]; }
+
+	std::vector<Entity>::const_iterator begin() const { return mDense.begin(); }
+	std::vector<Entity>::const_iterator end() const { return mDense.end(); }
+
+private:
+	/** Returns the sparse entry of an Entity whose page exists. */
+	std::uint32_t& Entry(Entity entity)
+	{
+		std::uint32_t index = EntityIndex(entity);
+		return mSparse[index / PAGE_SIZE][index % PAGE_SIZE];
+	}
+
+	std::uint32_t Entry(Entity entity) const
+	{
+		std::uint32_t index = EntityIndex(entity);
+		return mSparse[index / PAGE_SIZE][index % PAGE_SIZE];
+	}
+
+	/**
+	 * Returns the sparse entry of an Entity, allocating its page
+	 * (with every entry invalid) if this is the first time an
+	 * Entity in that page has been seen.
+	*/
+	std::uint32_t& SparseEntry(Entity entity)
+	{
+		std::uint32_t index = EntityIndex(entity);
+		std::size_t page = index / PAGE_SIZE;
+		if (page >= mSparse.size())
+		{
+			mSparse.resize(page + 1);
+		}
+		if (mSparse[page] == nullptr)
+		{
+			mSparse[page] = std::make_unique<std::uint32_t[]>(PAGE_SIZE);
+			std::fill_n(mSparse[page].get(), PAGE_SIZE, INVALID_INDEX);
+		}
+		return mSparse[page][index % PAGE_SIZE];
+	}
+
+	/** Pages of dense indices, indexed by EntityIndex(). */
+	std::vector<std::unique_ptr<std::uint32_t[]>> mSparse;
+
+	/** The packed array of Entities in the set. */
+	std::vector<Entity> mDense;
+};
+
+#endif
@@ -15,9 +15,61 @@
  * @author Tim Bishop
 */
 
-#include <set>
+#include <atomic>
+#include <cstddef>
 #include "Component.hpp"
 #include "Entity.hpp"
+#include "EntitySet.hpp"
+
+/**
+ * Hands out the next unused system family ID. Only
+ * meant to be called by SystemFamily().
+*/
+inline std::size_t NextSystemFamily()
+{
+	static std::atomic<std::size_t> next{0};
+	return next++;
+}
+
+/**
+ * Returns the ID of a System subclass, assigned the first
+ * time the subclass is used. The SystemManager uses it to
+ * find the subclass' slot without going through typeid().
+ * 
+ * @tparam T The subclass of System.
+*/
+template<typename T>
+std::size_t SystemFamily()
+{
+	static const std::size_t id = NextSystemFamily();
+	return id;
+}
+
+/**
+ * @struct SystemAccess
+ * 
+ * The Components a System reads and writes in its Update().
+ * Two Systems whose accesses conflict never run at the same
+ * time under Coordinator::RunSystems().
+*/
+struct SystemAccess
+{
+	/** The Components only read. */
+	Signature reads;
+
+	/** The Components written (and possibly read). */
+	Signature writes;
+
+	/**
+	 * @returns True if either access writes something the
+	 * other reads or writes.
+	*/
+	bool ConflictsWith(const SystemAccess& other) const
+	{
+		return (writes & (other.reads | other.writes)).any()
+			|| (other.writes & reads).any();
+	}
+};
 
 /**
  * @class System
@@ -28,8 +80,33 @@
 class System
 {
 public:
+	virtual ~System() = default;
+
 	/** A set of Entities that are affected by the System */
-	std::set<Entity> mEntities;
+	EntitySet mEntities;
+
+	/**
+	 * The System's work for one frame, as run by
+	 * Coordinator::RunSystems(). It may run on any thread, at
+	 * the same time as Systems it doesn't conflict with, so it
+	 * should only touch the Components GetAccess() declares and
+	 * record structural changes in a CommandBuffer.
+	*/
+	virtual void Update() {}
+
+	/**
+	 * Declares the Components Update() reads and writes. The
+	 * default claims to write every Component, so a System that
+	 * doesn't override this never runs alongside another.
+	 * 
+	 * @returns The SystemAccess of the System.
+	*/
+	virtual SystemAccess GetAccess()
+	{
+		SystemAccess access;
+		access.writes.set();
+		return access;
+	}
 
 	/**
 	 * A virtual function returning the signature of
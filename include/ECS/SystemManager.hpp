@@ -1,23 +1,38 @@
 #ifndef _ROC_SYSTEM_MANAGER_H_
 #define _ROC_SYSTEM_MANAGER_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
-#include <unordered_map>
+#include <vector>
 #include <spdlog/spdlog.h>
 
 #include "Entity.hpp"
 #include "Component.hpp"
 #include "System.hpp"
+#include "SystemScheduler.hpp"
 
+/**
+ * @class SystemManager
+ * 
+ * This class keeps every registered System and their
+ * Signatures, and keeps the System objects' sets of
+ * Entities up to date as Entity signatures change.
+ * 
+ * Alongside the dense list of Systems it keeps a reverse
+ * index from each component bit to the Systems whose
+ * Signature contains it, so a structural change only
+ * touches the Systems that could be affected by it.
+*/
 class SystemManager
 {
 public:
 	template<typename T>
 	std::shared_ptr<T> RegisterSystem()
 	{
-		const char* typeName = typeid(T).name();
+		std::size_t family = SystemFamily<T>();
 
-		if (mSystems.find(typeName) != mSystems.end())
+		if (family < mSystemIndices.size() && mSystemIndices[family] != INVALID_SYSTEM)
         {
             SPDLOG_ERROR("Attempting to register System twice.");
             return nullptr;
@@ -25,80 +40,345 @@ public:
 
 		// Create a pointer to the system and return it so it can be used externally
 		auto system = std::make_shared<T>();
-		mSystems.insert({typeName, system});
+		system->mEntities.reserve(MAX_ENTITIES);
+		if (family >= mSystemIndices.size())
+		{
+			mSystemIndices.resize(family + 1, INVALID_SYSTEM);
+		}
+		mSystemIndices[family] = mSystems.size();
+		mSystems.push_back(system);
+
+		// Systems start with an empty signature, which every entity matches
+		mSignatures.emplace_back();
+		mWildcardSystems.push_back(mSystemIndices[family]);
+		mScheduler.Invalidate();
 		return system;
 	}
 
     template<typename T>
     std::shared_ptr<T> GetSystem()
     {
-        const char* typeName = typeid(T).name();
+        std::size_t index = GetSystemIndex<T>();
 
-        if (mSystems.find(typeName) == mSystems.end())
+        if (index == INVALID_SYSTEM)
         {
             SPDLOG_ERROR("Requested System is not registered yet!");
             return nullptr;
         }
 
-        return std::static_pointer_cast<T>(mSystems.at(typeName));
+        return std::static_pointer_cast<T>(mSystems[index]);
     }
 
+	/**
+	 * Sets the Signature of a registered System, replacing
+	 * any Signature it had before, and files the System under
+	 * each component bit of the new Signature.
+	 * 
+	 * @note Entities already in the System are not re-evaluated.
+	 * 
+	 * @tparam T The System subclass.
+	 * @param signature The new Signature of the System.
+	 * 
+	 * @returns False if the System isn't registered, true otherwise.
+	*/
 	template<typename T>
 	bool SetSignature(Signature signature)
 	{
-		const char* typeName = typeid(T).name();
+		std::size_t index = GetSystemIndex<T>();
 
-		if (mSystems.find(typeName) == mSystems.end())
+		if (index == INVALID_SYSTEM)
         {
             SPDLOG_ERROR("Attempted to use System before registering it!");
             return false;
         }
 
-		// Set the signature for this system
-		mSignatures.insert({typeName, signature});
+		Unindex(index);
+		mSignatures[index] = signature;
+		Index(index);
         return true;
 	}
 
-	void EntityDestroyed(Entity entity)
+	/**
+	 * Requires System Before to finish its Update() before
+	 * System After starts its own in RunSystems().
+	 * 
+	 * @tparam Before The System to run first.
+	 * @tparam After The System to run second.
+	 * 
+	 * @returns False if either System isn't registered or the
+	 * ordering contradicts earlier ones, true otherwise.
+	*/
+	template<typename Before, typename After>
+	bool AddSystemOrdering()
+	{
+		std::size_t before = GetSystemIndex<Before>();
+		std::size_t after = GetSystemIndex<After>();
+
+		if (before == INVALID_SYSTEM || after == INVALID_SYSTEM)
+		{
+			SPDLOG_ERROR("Attempted to order a System before registering it!");
+			return false;
+		}
+		return mScheduler.AddOrdering(before, after);
+	}
+
+	/**
+	 * Runs the Update() of every System once, through the
+	 * SystemScheduler.
+	 * 
+	 * @param pool The pool to run them on, or nullptr for the
+	 * calling thread.
+	*/
+	void RunSystems(ThreadPool* pool)
+	{
+		mScheduler.Run(mSystems, pool);
+	}
+
+	/** @copydoc SystemScheduler::GetFrameTimings() */
+	const FrameTimings& GetFrameTimings() const
+	{
+		return mScheduler.GetFrameTimings();
+	}
+
+	/**
+	 * @tparam T The System subclass.
+	 * 
+	 * @returns How long T's Update() took in the last
+	 * RunSystems(), or zero if it didn't run.
+	*/
+	template<typename T>
+	std::chrono::nanoseconds GetSystemTime()
+	{
+		std::size_t index = GetSystemIndex<T>();
+		const FrameTimings& timings = mScheduler.GetFrameTimings();
+		return index < timings.systems.size() ? timings.systems[index] : std::chrono::nanoseconds(0);
+	}
+
+	/**
+	 * @tparam After The System that may have to wait.
+	 * @tparam Before The System it may wait on.
+	 * 
+	 * @returns True if, as of the last RunSystems(), After
+	 * waits directly on Before.
+	*/
+	template<typename After, typename Before>
+	bool SystemDependsOn()
+	{
+		return mScheduler.DependsOn(GetSystemIndex<After>(), GetSystemIndex<Before>());
+	}
+
+	/**
+	 * Erases a destroyed Entity from the Systems it could be
+	 * part of, meaning those filed under one of the bits of
+	 * its (last) Signature.
+	 * 
+	 * @param entity The Entity that was destroyed.
+	 * @param entitySignature The Signature the Entity had.
+	*/
+	void EntityDestroyed(Entity entity, Signature entitySignature)
 	{
-		// Erase a destroyed entity from all system lists
 		// mEntities is a set so no check needed
-		for (auto const& pair : mSystems)
+		for (std::size_t system : mWildcardSystems)
+		{
+			mSystems[system]->mEntities.erase(entity);
+		}
+
+		for (ComponentType type = 0; type < mSystemsByComponent.size(); type++)
 		{
-			auto const& system = pair.second;
+			if (!entitySignature.test(type))
+			{
+				continue;
+			}
 
-			system->mEntities.erase(entity);
+			for (std::size_t system : mSystemsByComponent[type])
+			{
+				mSystems[system]->mEntities.erase(entity);
+			}
 		}
 	}
 
-	void EntitySignatureChanged(Entity entity, Signature entitySignature)
+	/**
+	 * Adds a batch of new Entities, which all share a Signature,
+	 * to every System that Signature matches. Each System is
+	 * tested once for the whole batch.
+	 * 
+	 * @param entities The Entities that were just created.
+	 * @param count The number of Entities in `entities`.
+	 * @param entitySignature The Signature every Entity has.
+	*/
+	void EntitiesCreated(const Entity* entities, std::size_t count, Signature entitySignature)
 	{
-		// Notify each system that an entity's signature changed
-		for (auto const& pair : mSystems)
+		for (std::size_t system = 0; system < mSystems.size(); system++)
 		{
-			auto const& type = pair.first;
-			auto const& system = pair.second;
-			auto const& systemSignature = mSignatures[type];
+			auto const& systemSignature = mSignatures[system];
+			if ((entitySignature & systemSignature) != systemSignature)
+			{
+				continue;
+			}
 
-			// Entity signature matches system signature - insert into set
-			if ((entitySignature & systemSignature) == systemSignature)
+			EntitySet& members = mSystems[system]->mEntities;
+			for (std::size_t i = 0; i < count; i++)
 			{
-				system->mEntities.insert(entity);
+				members.insert(entities[i]);
 			}
-			// Entity signature does not match system signature - erase from set
-			else
+		}
+	}
+
+	/**
+	 * Erases a batch of destroyed Entities from every System,
+	 * skipping Systems with no Entities at all.
+	 * 
+	 * @param entities The Entities that were destroyed.
+	 * @param count The number of Entities in `entities`.
+	*/
+	void EntitiesDestroyed(const Entity* entities, std::size_t count)
+	{
+		for (auto const& system : mSystems)
+		{
+			for (std::size_t i = 0; i < count && !system->mEntities.empty(); i++)
 			{
-				system->mEntities.erase(entity);
+				system->mEntities.erase(entities[i]);
 			}
 		}
 	}
 
+	/**
+	 * Empties the Entity set of every System at once.
+	*/
+	void Clear()
+	{
+		for (auto const& system : mSystems)
+		{
+			system->mEntities.clear();
+		}
+	}
+
+	/**
+	 * Updates System membership after a single component bit
+	 * of an Entity's Signature flipped. Only the Systems filed
+	 * under that bit can change their minds about the Entity.
+	 * 
+	 * @param entity The Entity whose Signature changed.
+	 * @param entitySignature The new Signature of the Entity.
+	 * @param changedType The component bit that flipped.
+	*/
+	void EntitySignatureChanged(Entity entity, Signature entitySignature, ComponentType changedType)
+	{
+		for (std::size_t system : mWildcardSystems)
+		{
+			UpdateMembership(system, entity, entitySignature);
+		}
+
+		if (changedType >= mSystemsByComponent.size())
+		{
+			return;
+		}
+
+		for (std::size_t system : mSystemsByComponent[changedType])
+		{
+			UpdateMembership(system, entity, entitySignature);
+		}
+	}
+
+	/**
+	 * Updates the membership of every System after an arbitrary
+	 * change to an Entity's Signature.
+	 * 
+	 * @param entity The Entity whose Signature changed.
+	 * @param entitySignature The new Signature of the Entity.
+	*/
+	void EntitySignatureChanged(Entity entity, Signature entitySignature)
+	{
+		for (std::size_t system = 0; system < mSystems.size(); system++)
+		{
+			UpdateMembership(system, entity, entitySignature);
+		}
+	}
+
 private:
-	// Map from system type string pointer to a signature
-	std::unordered_map<const char*, Signature> mSignatures{};
+	/** Marks a System family that has no slot in mSystems. */
+	static constexpr std::size_t INVALID_SYSTEM = SIZE_MAX;
+
+	template<typename T>
+	std::size_t GetSystemIndex()
+	{
+		std::size_t family = SystemFamily<T>();
+		return family < mSystemIndices.size() ? mSystemIndices[family] : INVALID_SYSTEM;
+	}
+
+	void UpdateMembership(std::size_t system, Entity entity, Signature entitySignature)
+	{
+		auto const& systemSignature = mSignatures[system];
+
+		// Entity signature matches system signature - insert into set
+		if ((entitySignature & systemSignature) == systemSignature)
+		{
+			mSystems[system]->mEntities.insert(entity);
+		}
+		// Entity signature does not match system signature - erase from set
+		else
+		{
+			mSystems[system]->mEntities.erase(entity);
+		}
+	}
+
+	/** Files a System under each bit of its Signature (or as a wildcard). */
+	void Index(std::size_t system)
+	{
+		const Signature& signature = mSignatures[system];
+		if (signature.none())
+		{
+			mWildcardSystems.push_back(system);
+			return;
+		}
+
+		for (ComponentType type = 0; type < MAX_COMPONENTS; type++)
+		{
+			if (!signature.test(type))
+			{
+				continue;
+			}
+
+			if (type >= mSystemsByComponent.size())
+			{
+				mSystemsByComponent.resize(type + 1);
+			}
+			mSystemsByComponent[type].push_back(system);
+		}
+	}
+
+	/** Removes a System from every list Index() put it in. */
+	void Unindex(std::size_t system)
+	{
+		auto eraseFrom = [system](std::vector<std::size_t>& list)
+		{
+			list.erase(std::remove(list.begin(), list.end(), system), list.end());
+		};
+
+		eraseFrom(mWildcardSystems);
+		for (auto& list : mSystemsByComponent)
+		{
+			eraseFrom(list);
+		}
+	}
+
+	/** Runs the Systems' Update() each frame */
+	SystemScheduler mScheduler;
+
+	/** The registered Systems, in registration order */
+	std::vector<std::shared_ptr<System>> mSystems{};
+
+	/** The Signature of each System, parallel to mSystems */
+	std::vector<Signature> mSignatures{};
+
+	/** Map from System family ID to its index in mSystems */
+	std::vector<std::size_t> mSystemIndices{};
+
+	/** Map from component bit to the Systems whose Signature contains it */
+	std::vector<std::vector<std::size_t>> mSystemsByComponent{};
 
-	// Map from system type string pointer to a system pointer
-	std::unordered_map<const char*, std::shared_ptr<System>> mSystems{};
+	/** Systems with an empty Signature, which match every Entity */
+	std::vector<std::size_t> mWildcardSystems{};
 };
 
 #endif
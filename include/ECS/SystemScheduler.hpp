@@ -0,0 +1,112 @@
+#ifndef _ROC_SYSTEM_SCHEDULER_H_
+#define _ROC_SYSTEM_SCHEDULER_H_
+
+/**
+ * @file SystemScheduler.hpp
+ *
+ * This file defines the SystemScheduler class, which runs the
+ * Update() of every System once per frame, in parallel where
+ * their declared Component accesses allow it.
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "System.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @struct FrameTimings
+ *
+ * How long the last frame run by a SystemScheduler took.
+*/
+struct FrameTimings
+{
+	/** Wall time of the whole frame. */
+	std::chrono::nanoseconds frame{0};
+
+	/** Time spent in each System's Update(), in registration order. */
+	std::vector<std::chrono::nanoseconds> systems;
+};
+
+/**
+ * @class SystemScheduler
+ *
+ * Builds a dependency graph over the Systems and runs it on a
+ * ThreadPool. Systems are first put in registration order,
+ * except that a System an explicit ordering makes another wait
+ * on is pulled forward to just before it; nothing else moves.
+ * Then every pair whose SystemAccess conflicts gets an edge
+ * from the earlier System to the later one, so conflicts keep
+ * their registration order unless an ordering forces
+ * otherwise. A System starts as
+ * soon as everything it depends on has finished, so Systems
+ * that don't conflict run at the same time.
+ *
+ * Systems are referred to by their index in the SystemManager.
+ * The graph is rebuilt lazily whenever it is invalidated.
+*/
+class SystemScheduler
+{
+public:
+	/**
+	 * Requires one System to finish before another starts,
+	 * whether or not their accesses conflict.
+	 *
+	 * @param before The System to run first.
+	 * @param after The System to run second.
+	 *
+	 * @returns False (and changes nothing) if the ordering
+	 * would contradict the existing ones, true otherwise.
+	*/
+	bool AddOrdering(std::size_t before, std::size_t after);
+
+	/** Makes the next Run() rebuild the graph, e.g. after a System is registered. */
+	void Invalidate() { mDirty = true; }
+
+	/**
+	 * Runs every System's Update() once.
+	 *
+	 * @param systems The Systems, in registration order.
+	 * @param pool The pool to run them on, or nullptr to run
+	 * them one after another on the calling thread.
+	*/
+	void Run(const std::vector<std::shared_ptr<System>>& systems, ThreadPool* pool);
+
+	/**
+	 * @returns True if the graph makes `after` wait directly
+	 * on `before` (built by the last Run()).
+	*/
+	bool DependsOn(std::size_t after, std::size_t before) const;
+
+	/** @returns The timings of the last Run(). */
+	const FrameTimings& GetFrameTimings() const { return mTimings; }
+
+private:
+	void Build(const std::vector<std::shared_ptr<System>>& systems);
+
+	/** @returns True if the explicit orderings lead from one System to another. */
+	bool Reaches(std::size_t from, std::size_t to) const;
+
+	void RunSystem(System& system, std::size_t index);
+
+	/** The explicit orderings: the Systems that must wait on each System */
+	std::vector<std::vector<std::size_t>> mOrderings;
+
+	/** Every System in registration order, bar what mOrderings pulls forward */
+	std::vector<std::size_t> mOrder;
+
+	/** The Systems that wait directly on each System */
+	std::vector<std::vector<std::size_t>> mSuccessors;
+
+	/** The number of Systems each System waits on directly */
+	std::vector<std::size_t> mDependencyCounts;
+
+	bool mDirty = true;
+
+	FrameTimings mTimings;
+};
+
+#endif
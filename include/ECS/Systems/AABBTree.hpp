@@ -0,0 +1,217 @@
+#ifndef _ROC_AABB_TREE_H_
+#define _ROC_AABB_TREE_H_
+
+/**
+ * @file AABBTree.hpp
+ *
+ * This file defines the AABBTreeBroadphase, a dynamic
+ * bounding volume tree over the colliders.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Broadphase.hpp"
+
+/**
+ * @class AABBTreeBroadphase
+ *
+ * Keeps every collider as a leaf of a balanced binary tree of
+ * boxes, where each internal box encloses its two children.
+ * Unlike a grid it copes with any mix of collider sizes.
+ *
+ * Leaves hold a fattened copy of their collider's bounds,
+ * grown by a margin on every side. A leaf is only taken out
+ * and reinserted once its collider leaves that fattened box,
+ * so colliders jiggling in place cost nothing. Insertions pick
+ * the sibling that grows the tree's total perimeter least,
+ * and rotations keep the tree balanced on the way back up.
+ *
+ * The pairs of leaves whose fattened boxes overlap are cached
+ * between frames; only leaves that were inserted, reinserted
+ * or removed have their pairs looked up again. In a mostly
+ * static scene an Update() is one containment test per
+ * collider, and FindPairs() just copies out the cache.
+ *
+ * Every internal node also holds the union of its leaves'
+ * CollisionFilters, so pair lookups skip whole subtrees of
+ * colliders that can't interact without testing their boxes.
+*/
+class AABBTreeBroadphase : public Broadphase
+{
+public:
+    /**
+     * @param margin How far leaves are fattened on every side, in world units.
+    */
+    explicit AABBTreeBroadphase(double margin = 4.0);
+
+    /**
+     * Changes the fattening margin. Leaves already in the tree
+     * keep theirs until they are next reinserted.
+     *
+     * @param margin The margin, in world units. Negative margins are ignored.
+    */
+    void SetMargin(double margin);
+
+    /** @returns How far leaves are fattened on every side. */
+    double GetMargin() const { return mMargin; }
+
+    void Update(const std::vector<BroadphaseProxy>& proxies) override;
+    void FindPairs(std::vector<BroadphasePair>& pairs) override;
+
+    /**
+     * Calls `func(proxy)` for every collider whose fattened box
+     * overlaps `bounds`, with its index in the last Update(),
+     * whatever its filter.
+    */
+    template<typename F>
+    void Query(const AABB& bounds, F&& func) const
+    {
+        QueryNodes(bounds, nullptr, [&](std::int32_t leaf) { func(mNodes[leaf].proxy); });
+    }
+
+    void Query(const AABB& bounds, const CollisionFilter& filter, std::vector<std::uint32_t>& proxies) const override
+    {
+        QueryNodes(bounds, &filter, [&](std::int32_t leaf) { proxies.push_back(mNodes[leaf].proxy); });
+    }
+
+    /** Walks down only the nodes the ray passes through. */
+    void QueryRay(const Ray& ray, const CollisionFilter& filter, std::vector<std::uint32_t>& proxies) const override;
+
+    /** @returns The number of colliders in the tree. */
+    std::size_t GetLeafCount() const { return mLeaves.size(); }
+
+    /** @returns The height of the tree: 0 for a lone leaf, -1 when empty. */
+    int GetHeight() const;
+
+    /**
+     * @returns The number of leaves the last Update() had to
+     * insert or reinsert.
+    */
+    std::size_t GetReinsertedCount() const { return mReinserted; }
+
+    /**
+     * Checks the tree's links, heights and boxes, for tests.
+     *
+     * @returns True if the tree is consistent.
+    */
+    bool Validate() const;
+
+private:
+    static constexpr std::int32_t NULL_NODE = -1;
+
+    struct Node
+    {
+        /** The enclosing box, or for a leaf the fattened collider box */
+        AABB bounds;
+
+        /** The collider's filter, or for an internal node every layer and mask bit below it */
+        CollisionFilter filter;
+
+        /** The parent, or for a free node the next free node */
+        std::int32_t parent = NULL_NODE;
+        std::int32_t left = NULL_NODE;
+        std::int32_t right = NULL_NODE;
+
+        /** 0 for leaves */
+        std::int32_t height = 0;
+
+        Entity entity = 0;
+
+        /** The leaf's index in the last Update() */
+        std::uint32_t proxy = 0;
+
+        /** The last Update() that saw the leaf */
+        std::uint32_t stamp = 0;
+
+        /** Whether the leaf's cached pairs are out of date */
+        bool moved = false;
+
+        bool IsLeaf() const { return left == NULL_NODE; }
+    };
+
+    struct LeafPair
+    {
+        std::int32_t first;
+        std::int32_t second;
+    };
+
+    std::int32_t AllocateNode();
+    void FreeNode(std::int32_t node);
+
+    void InsertLeaf(std::int32_t leaf);
+    void RemoveLeaf(std::int32_t leaf);
+
+    /** Rebalances and refits from `node` up to the root. */
+    void FixUpwards(std::int32_t node);
+
+    /** Rotates `node`'s taller child up if the children's heights differ by more than one. */
+    std::int32_t Balance(std::int32_t node);
+
+    AABB Fatten(const AABB& bounds) const;
+
+    /** Drops the cached pairs of moved leaves and queries the tree for their new ones. */
+    void UpdateMovedPairs();
+
+    /** Rebuilds the pair cache from scratch by testing the tree against itself. */
+    void FindAllPairs();
+
+    /** Calls `func(leaf)` for every leaf overlapping `bounds` that can interact with `filter` (if not nullptr). */
+    template<typename F>
+    void QueryNodes(const AABB& bounds, const CollisionFilter* filter, F&& func) const
+    {
+        if (mRoot == NULL_NODE)
+        {
+            return;
+        }
+
+        std::vector<std::int32_t> stack;
+        stack.reserve(64);
+        stack.push_back(mRoot);
+        while (!stack.empty())
+        {
+            std::int32_t index = stack.back();
+            stack.pop_back();
+            const Node& node = mNodes[index];
+            if ((filter != nullptr && !node.filter.CanInteract(*filter)) || !node.bounds.Overlaps(bounds))
+            {
+                continue;
+            }
+
+            if (node.IsLeaf())
+            {
+                func(index);
+            }
+            else
+            {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+            }
+        }
+    }
+
+    int ValidateNode(std::int32_t node, std::int32_t parent, std::size_t& leaves) const;
+
+    std::vector<Node> mNodes;
+    std::int32_t mRoot = NULL_NODE;
+    std::int32_t mFreeList = NULL_NODE;
+
+    /** The leaf of each EntityIndex(), or NULL_NODE */
+    std::vector<std::int32_t> mLeafOf;
+
+    /** Every leaf, in the order of the last Update() */
+    std::vector<std::int32_t> mLeaves;
+
+    /** The nodes flagged moved during the current Update() */
+    std::vector<std::int32_t> mMoved;
+
+    /** Leaves whose fattened boxes overlap, first < second */
+    std::vector<LeafPair> mPairs;
+
+    std::uint32_t mStamp = 0;
+    double mMargin;
+    std::size_t mReinserted = 0;
+};
+
+#endif
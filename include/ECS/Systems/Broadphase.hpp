@@ -0,0 +1,296 @@
+#ifndef _ROC_BROADPHASE_H_
+#define _ROC_BROADPHASE_H_
+
+/**
+ * @file Broadphase.hpp
+ *
+ * This file defines the Broadphase interface, which the
+ * CollisionSystem uses to find the pairs of colliders that
+ * might touch before testing them exactly, along with the
+ * axis-aligned boxes it works on and the brute-force
+ * Broadphase every other one is checked against.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../Entity.hpp"
+#include "../ThreadPool.hpp"
+
+/**
+ * @struct AABB
+ *
+ * An axis-aligned bounding box in world space.
+*/
+struct AABB
+{
+    double minX = 0;
+    double minY = 0;
+    double maxX = 0;
+    double maxY = 0;
+
+    /**
+     * @returns True if the boxes overlap. Boxes that only
+     * touch along an edge don't.
+    */
+    bool Overlaps(const AABB& other) const
+    {
+        return minX < other.maxX && maxX > other.minX
+            && minY < other.maxY && maxY > other.minY;
+    }
+
+    /** @returns True if `other` lies entirely inside this box. */
+    bool Contains(const AABB& other) const
+    {
+        return minX <= other.minX && minY <= other.minY
+            && maxX >= other.maxX && maxY >= other.maxY;
+    }
+};
+
+/**
+ * @struct Ray
+ *
+ * A ray from an origin along a direction, as far as
+ * maxDistance times the direction's length.
+*/
+struct Ray
+{
+    double originX = 0;
+    double originY = 0;
+    double dirX = 1;
+    double dirY = 0;
+    double maxDistance = HUGE_VAL;
+};
+
+/**
+ * Tests a ray against a box. As with AABB::Overlaps(), a ray
+ * that only grazes an edge or corner misses.
+ *
+ * @param ray The ray.
+ * @param box The box.
+ * @param distance Set to how far along the ray (in lengths of
+ * its direction) it enters the box: 0 if it starts inside.
+ * @param axis Set to the axis of the face it enters through:
+ * 0 for a left or right face, 1 for a top or bottom one, or
+ * -1 if it starts inside.
+ *
+ * @returns True if the ray hits the box within its maxDistance.
+*/
+inline bool RayHitsBox(const Ray& ray, const AABB& box, double& distance, int& axis)
+{
+    double enter = 0;
+    double leave = ray.maxDistance;
+    axis = -1;
+    const double origin[2] = {ray.originX, ray.originY};
+    const double dir[2] = {ray.dirX, ray.dirY};
+    const double low[2] = {box.minX, box.minY};
+    const double high[2] = {box.maxX, box.maxY};
+    for (int a = 0; a < 2; a++)
+    {
+        // Parallel to this axis' faces: it has to run between them
+        if (dir[a] == 0)
+        {
+            if (!(origin[a] > low[a] && origin[a] < high[a]))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        double inverse = 1.0 / dir[a];
+        double closer = (low[a] - origin[a]) * inverse;
+        double further = (high[a] - origin[a]) * inverse;
+        if (closer > further)
+        {
+            std::swap(closer, further);
+        }
+        if (!(closer <= further))
+        {
+            return false;
+        }
+
+        if (closer > enter)
+        {
+            enter = closer;
+            axis = a;
+        }
+        leave = std::min(leave, further);
+    }
+
+    if (!(enter < leave))
+    {
+        return false;
+    }
+    distance = enter;
+    return true;
+}
+
+/** @returns The box a ray sweeps over (unbounded if its maxDistance is). */
+inline AABB RayBounds(const Ray& ray)
+{
+    double endX = ray.dirX == 0 ? ray.originX : ray.originX + ray.dirX * ray.maxDistance;
+    double endY = ray.dirY == 0 ? ray.originY : ray.originY + ray.dirY * ray.maxDistance;
+    AABB bounds;
+    bounds.minX = std::min(ray.originX, endX);
+    bounds.minY = std::min(ray.originY, endY);
+    bounds.maxX = std::max(ray.originX, endX);
+    bounds.maxY = std::max(ray.originY, endY);
+    return bounds;
+}
+
+/**
+ * @struct CollisionFilter
+ *
+ * Which collision layers a collider is on, and which layers
+ * it can touch. Two colliders interact only if each is on a
+ * layer in the other's mask. The default is on layer 0,
+ * touching every layer.
+*/
+struct CollisionFilter
+{
+    std::uint32_t layers = 1;
+    std::uint32_t mask = UINT32_MAX;
+
+    /** @returns True if colliders with these filters can interact. */
+    bool CanInteract(const CollisionFilter& other) const
+    {
+        return (layers & other.mask) != 0 && (other.layers & mask) != 0;
+    }
+
+    bool operator==(const CollisionFilter& other) const
+    {
+        return layers == other.layers && mask == other.mask;
+    }
+
+    bool operator!=(const CollisionFilter& other) const { return !(*this == other); }
+};
+
+/**
+ * @struct BroadphaseProxy
+ *
+ * What a Broadphase knows about one collider.
+*/
+struct BroadphaseProxy
+{
+    Entity entity;
+    AABB bounds;
+    CollisionFilter filter;
+};
+
+/**
+ * @struct BroadphasePair
+ *
+ * Two colliders that might overlap, as indices into the
+ * proxies last handed to Broadphase::Update(), with
+ * first < second.
+*/
+struct BroadphasePair
+{
+    std::uint32_t first;
+    std::uint32_t second;
+
+    bool operator<(const BroadphasePair& other) const
+    {
+        return first != other.first ? first < other.first : second < other.second;
+    }
+
+    bool operator==(const BroadphasePair& other) const
+    {
+        return first == other.first && second == other.second;
+    }
+};
+
+/**
+ * @class Broadphase
+ *
+ * Narrows the n² pairs of colliders down to the ones worth
+ * an exact test. Each frame the CollisionSystem hands over
+ * every collider with Update() and then asks for the
+ * candidate pairs with FindPairs().
+*/
+class Broadphase
+{
+public:
+    virtual ~Broadphase() = default;
+
+    /**
+     * Brings the Broadphase up to date with this frame's
+     * colliders. Index i of `proxies` is how pairs refer to
+     * the i-th collider until the next Update().
+     *
+     * @param proxies Every collider, each Entity at most once.
+    */
+    virtual void Update(const std::vector<BroadphaseProxy>& proxies) = 0;
+
+    /**
+     * Appends every pair of colliders whose bounds overlap and
+     * whose filters let them interact. Each pair is reported
+     * once; pairs that turn out not to overlap may be reported
+     * too, but pairs that can't interact never are. Filters are
+     * checked before any bounds, so they cost little.
+     *
+     * @param pairs The vector to append to.
+    */
+    virtual void FindPairs(std::vector<BroadphasePair>& pairs) = 0;
+
+    /**
+     * Like FindPairs(), with the search split across a pool.
+     * The pairs must come out exactly as FindPairs() gives
+     * them, whatever the number of threads. By default this
+     * just calls FindPairs() on the calling thread.
+     *
+     * @param pool The pool to search on.
+     * @param pairs The vector to append to.
+    */
+    virtual void ParallelFindPairs(ThreadPool& pool, std::vector<BroadphasePair>& pairs)
+    {
+        (void)pool;
+        FindPairs(pairs);
+    }
+
+    /**
+     * Appends the index of every collider, as of the last
+     * Update(), whose bounds overlap `bounds` and whose filter
+     * can interact with `filter`. Colliders that turn out not to
+     * overlap may be appended too, but none is appended twice.
+     *
+     * @param bounds The box to look in.
+     * @param filter The layers the query is on and can see.
+     * @param proxies The vector to append to.
+    */
+    virtual void Query(const AABB& bounds, const CollisionFilter& filter, std::vector<std::uint32_t>& proxies) const = 0;
+
+    /**
+     * Like Query(), for the colliders a ray might hit. Colliders
+     * it only hits further along than another one appended may be
+     * left out. By default it queries the box the ray sweeps
+     * over, which for a long diagonal ray is most of the world.
+    */
+    virtual void QueryRay(const Ray& ray, const CollisionFilter& filter, std::vector<std::uint32_t>& proxies) const
+    {
+        Query(RayBounds(ray), filter, proxies);
+    }
+};
+
+/**
+ * @class BruteForceBroadphase
+ *
+ * Tests every pair of colliders. Only sensible for a handful
+ * of colliders, or as a reference for the other Broadphases.
+*/
+class BruteForceBroadphase : public Broadphase
+{
+public:
+    void Update(const std::vector<BroadphaseProxy>& proxies) override;
+    void FindPairs(std::vector<BroadphasePair>& pairs) override;
+    void Query(const AABB& bounds, const CollisionFilter& filter, std::vector<std::uint32_t>& proxies) const override;
+
+private:
+    std::vector<AABB> mBounds;
+    std::vector<CollisionFilter> mFilters;
+};
+
+#endif
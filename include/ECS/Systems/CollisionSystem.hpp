@@ -1,69 +1,551 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "../Coordinator.hpp"
 #include "../Components/Transform.hpp"
 #include "../Components/RectangleCollider.hpp"
+#include "Broadphase.hpp"
+#include "SpatialHash.hpp"
+#include "AABBTree.hpp"
+#include "SweepAndPrune.hpp"
+#include "Narrowphase.hpp"
+#include "ContactBuffer.hpp"
+#include "PairSet.hpp"
+#include "StaticIndex.hpp"
+
+/**
+ * @struct CollisionEvent
+ *
+ * Two Entities starting, still or no longer overlapping.
+ * `first` is always the smaller handle.
+*/
+struct CollisionEvent
+{
+    Entity first;
+    Entity second;
+
+    /** The sides of `first` hit, as in Collision::collision_pos (0 for an exit) */
+    int sides;
+};
+
+/**
+ * @struct RaycastHit
+ *
+ * Where a ray first hit a collider.
+*/
+struct RaycastHit
+{
+    /** False if the ray hit nothing, in which case nothing else is set */
+    bool hit = false;
+
+    Entity entity = 0;
+
+    /** How far along the ray, in world units */
+    double distance = 0;
+
+    /** The point hit */
+    double x = 0;
+    double y = 0;
+
+    /** The side of the collider hit, as a COLLISION_ flag (0 if the ray starts inside it) */
+    int side = 0;
+};
 
 class CollisionSystem : public System
 {
+public:
+    /** The number of collision layers, one per bit of RectangleCollider::layer. */
+    static constexpr int COLLISION_LAYERS = 32;
+
+    /** How many moving colliders look up the static ones they hit in one task. */
+    static constexpr std::size_t COLLIDERS_PER_TASK = 256;
+
+    /** How many candidate pairs the Narrowphase tests in one task. */
+    static constexpr std::size_t PAIRS_PER_TASK = 4096;
+
 private:
-    int DoCollisionCheck(Transform& t1, RectangleCollider& c1, Transform& t2, RectangleCollider& c2)
+    /**
+     * The colliders gathered for the current Do(), reused
+     * between frames: the moving ones, then the static ones.
+    */
+    std::vector<BroadphaseProxy> mProxies;
+
+    /** How many of mProxies move; the static ones follow. */
+    std::uint32_t mMoving = 0;
+
+    /** The static colliders gathered for the current Do(). */
+    std::vector<BroadphaseProxy> mStatics;
+
+    /** The static colliders mStaticIndex was built over, in Entity order. */
+    std::vector<BroadphaseProxy> mIndexedStatics;
+    StaticIndex mStaticIndex;
+
+    /** The candidate pairs of the current Do(). */
+    std::vector<BroadphasePair> mPairs;
+
+    /** The candidate pairs that really overlap. */
+    std::vector<Contact> mContacts;
+
+    /**
+     * Each task's own pairs and contacts, appended to mPairs and
+     * mContacts in task order once every task is done, so the
+     * results don't depend on which thread ran what.
+    */
+    std::vector<std::vector<BroadphasePair>> mChunkPairs;
+    std::vector<std::vector<Contact>> mChunkContacts;
+
+    /** Every Collision of the last Do(), by Entity. */
+    ContactBuffer mContactBuffer;
+
+    /** The Entity pairs overlapping as of the last Do(), and the frame before. */
+    PairSet mTouching;
+    PairSet mWasTouching;
+
+    std::vector<CollisionEvent> mEnterEvents;
+    std::vector<CollisionEvent> mStayEvents;
+    std::vector<CollisionEvent> mExitEvents;
+
+    std::unique_ptr<Broadphase> mBroadphase = std::make_unique<SpatialHashBroadphase>();
+    Narrowphase mNarrowphase;
+
+    /** Bit j of row i is set if layers i and j interact; kept symmetric. */
+    std::array<std::uint32_t, COLLISION_LAYERS> mLayerMatrix = MakeLayerMatrix();
+
+    static std::array<std::uint32_t, COLLISION_LAYERS> MakeLayerMatrix()
+    {
+        std::array<std::uint32_t, COLLISION_LAYERS> matrix;
+        matrix.fill(UINT32_MAX);
+        return matrix;
+    }
+
+    /**
+     * @returns A collider's layers and its mask, cut down to
+     * the layers its own layers interact with.
+    */
+    CollisionFilter FilterOf(const RectangleCollider& c) const
+    {
+        CollisionFilter filter;
+        filter.layers = c.layer;
+        filter.mask = 0;
+        for (std::uint32_t layers = c.layer; layers != 0; layers &= layers - 1)
+        {
+            filter.mask |= mLayerMatrix[LowestLayer(layers)];
+        }
+        filter.mask &= c.mask;
+        return filter;
+    }
+
+    /** @returns True if two lists hold the same colliders, in the same order, with the same bounds and filters. */
+    static bool SameProxies(const std::vector<BroadphaseProxy>& a, const std::vector<BroadphaseProxy>& b)
     {
-        int retval = 0;
-        
-        if ((t1.x + c1.offsetX < t2.x + c2.offsetX + c2.width) &&
-            (t1.x + c1.offsetX + c1.width > t2.x + c2.offsetX) &&
-            (t1.y + c1.offsetY < t2.y + c2.offsetY + c2.height) &&
-            (t1.y + c1.offsetY + c1.height > t2.y + c2.offsetY))
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+            [](const BroadphaseProxy& x, const BroadphaseProxy& y)
+            {
+                return x.entity == y.entity && x.filter == y.filter
+                    && x.bounds.minX == y.bounds.minX && x.bounds.minY == y.bounds.minY
+                    && x.bounds.maxX == y.bounds.maxX && x.bounds.maxY == y.bounds.maxY;
+            });
+    }
+
+    /** Scratch space for the Broadphase's answers to queries */
+    mutable std::vector<std::uint32_t> mCandidates;
+
+    /**
+     * Keeps `hit` if the ray enters collider `proxy` before
+     * whatever `best` holds, breaking ties by Entity.
+    */
+    void KeepCloser(const Ray& ray, std::uint32_t proxy, double distance, int axis, RaycastHit& best) const
+    {
+        Entity entity = mProxies[proxy].entity;
+        if (best.hit && (distance > best.distance || (distance == best.distance && entity > best.entity)))
         {
-            retval = 15;
+            return;
         }
 
-        return retval;
+        best.hit = true;
+        best.entity = entity;
+        best.distance = distance;
+        best.x = ray.originX + ray.dirX * distance;
+        best.y = ray.originY + ray.dirY * distance;
+        if (axis == 0)
+        {
+            best.side = ray.dirX > 0 ? COLLISION_LEFT : COLLISION_RIGHT;
+        }
+        else if (axis == 1)
+        {
+            best.side = ray.dirY > 0 ? COLLISION_BOTTOM : COLLISION_TOP;
+        }
+        else
+        {
+            best.side = 0;
+        }
+    }
+
+    static int LowestLayer(std::uint32_t layers)
+    {
+        int layer = 0;
+        while ((layers & 1) == 0)
+        {
+            layers >>= 1;
+            layer++;
+        }
+        return layer;
     }
 
 public:
+    /**
+     * @returns The world-space bounds of a collider on an
+     * Entity at the given Transform.
+    */
+    static AABB BoundsOf(const Transform& t, const RectangleCollider& c)
+    {
+        AABB bounds;
+        bounds.minX = t.x + c.offsetX;
+        bounds.minY = t.y + c.offsetY;
+        bounds.maxX = bounds.minX + c.width;
+        bounds.maxY = bounds.minY + c.height;
+        return bounds;
+    }
+
+    /**
+     * Replaces the Broadphase used to find candidate pairs
+     * among moving colliders (static ones are found through the
+     * StaticIndex instead). The default is a SpatialHashBroadphase with 64-unit cells; an
+     * AABBTreeBroadphase copes better with colliders of very
+     * different sizes, and with scenes that mostly stand still;
+     * a SweepAndPruneBroadphase suits many colliders moving a
+     * little every frame.
+     *
+     * @param broadphase The new Broadphase. Ignored if nullptr.
+    */
+    void SetBroadphase(std::unique_ptr<Broadphase> broadphase)
+    {
+        if (broadphase != nullptr)
+        {
+            mBroadphase = std::move(broadphase);
+        }
+    }
+
+    /** @returns The Broadphase used to find candidate pairs. */
+    Broadphase& GetBroadphase() { return *mBroadphase; }
+
+    /**
+     * Sets whether colliders on two layers can collide, on top
+     * of their own masks. Every pair of layers can by default.
+     * Pairs that can't are dropped by the Broadphase before
+     * their bounds are looked at, and colliders that can touch
+     * nothing at all are left out of it entirely.
+     *
+     * @param layerA A layer, from 0 to COLLISION_LAYERS - 1.
+     * @param layerB Another layer, or the same one.
+     * @param interact Whether they collide.
+     *
+     * @returns False if either layer is out of range.
+    */
+    bool SetLayersInteract(int layerA, int layerB, bool interact)
+    {
+        if (layerA < 0 || layerA >= COLLISION_LAYERS || layerB < 0 || layerB >= COLLISION_LAYERS)
+        {
+            return false;
+        }
+
+        std::uint32_t bitA = std::uint32_t(1) << layerA;
+        std::uint32_t bitB = std::uint32_t(1) << layerB;
+        mLayerMatrix[layerA] = interact ? mLayerMatrix[layerA] | bitB : mLayerMatrix[layerA] & ~bitB;
+        mLayerMatrix[layerB] = interact ? mLayerMatrix[layerB] | bitA : mLayerMatrix[layerB] & ~bitA;
+        return true;
+    }
+
+    /** @returns True if colliders on two layers can collide (false if either is out of range). */
+    bool LayersInteract(int layerA, int layerB) const
+    {
+        if (layerA < 0 || layerA >= COLLISION_LAYERS || layerB < 0 || layerB >= COLLISION_LAYERS)
+        {
+            return false;
+        }
+        return (mLayerMatrix[layerA] >> layerB) & 1;
+    }
+
+    /** @returns The Narrowphase that tests the candidate pairs. */
+    Narrowphase& GetNarrowphase() { return mNarrowphase; }
+
+    /**
+     * @returns The index of static colliders. It is rebuilt
+     * whenever a static collider appears, disappears, moves
+     * or changes layers, and only then.
+    */
+    const StaticIndex& GetStaticIndex() const { return mStaticIndex; }
+
+    /**
+     * @returns The Collisions the last Update() found for an
+     * Entity, valid until the next Update().
+    */
+    ContactSpan ContactsOf(Entity entity) const { return mContactBuffer.ContactsOf(entity); }
+
+    /** @returns Every Collision the last Update() found. */
+    const ContactBuffer& GetContacts() const { return mContactBuffer; }
+
+    /** @returns The pairs that started overlapping in the last Update(). */
+    const std::vector<CollisionEvent>& GetEnterEvents() const { return mEnterEvents; }
+
+    /** @returns The pairs that overlapped in the last Update() and the one before. */
+    const std::vector<CollisionEvent>& GetStayEvents() const { return mStayEvents; }
+
+    /**
+     * @returns The pairs that stopped overlapping in the last
+     * Update(), sorted. This includes pairs with an Entity that
+     * has since been destroyed, whose handle is then stale.
+    */
+    const std::vector<CollisionEvent>& GetExitEvents() const { return mExitEvents; }
+
+    /** @returns A filter that sees every collider, the default for queries. */
+    static CollisionFilter AnyLayer() { return {UINT32_MAX, UINT32_MAX}; }
+
+    /**
+     * Finds every collider overlapping a box. Like the other
+     * queries, it looks at the colliders as of the last Update(),
+     * through the Broadphase and StaticIndex. What that costs
+     * depends on the Broadphase: about log n plus the hits for
+     * the AABBTreeBroadphase (and the StaticIndex), one lookup
+     * per cell the box covers for the SpatialHashBroadphase, log
+     * n plus the colliders starting within the widest one's width
+     * of the box for the SweepAndPruneBroadphase, and a pass over
+     * every collider for the BruteForceBroadphase. Queries can
+     * run between Update()s, but not at the same time as each
+     * other.
+     *
+     * @param bounds The box.
+     * @param hits The vector to append each Entity found to.
+     * @param filter The layers the query is on and can see.
+     *
+     * @returns The number of Entities appended.
+    */
+    std::size_t QueryAABB(const AABB& bounds, std::vector<Entity>& hits, const CollisionFilter& filter = AnyLayer()) const
+    {
+        std::size_t count = hits.size();
+        mCandidates.clear();
+        mBroadphase->Query(bounds, filter, mCandidates);
+        for (std::uint32_t proxy : mCandidates)
+        {
+            if (proxy < mMoving && mProxies[proxy].filter.CanInteract(filter) && mProxies[proxy].bounds.Overlaps(bounds))
+            {
+                hits.push_back(mProxies[proxy].entity);
+            }
+        }
+        mStaticIndex.Query(bounds, filter, [&](std::uint32_t s) { hits.push_back(mProxies[mMoving + s].entity); });
+        return hits.size() - count;
+    }
+
+    /**
+     * Finds every collider a point lies strictly inside (points
+     * on an edge are outside, as with touching boxes).
+     *
+     * @returns The number of Entities appended to `hits`.
+    */
+    std::size_t QueryPoint(double x, double y, std::vector<Entity>& hits, const CollisionFilter& filter = AnyLayer()) const
+    {
+        AABB point;
+        point.minX = point.maxX = x;
+        point.minY = point.maxY = y;
+        return QueryAABB(point, hits, filter);
+    }
+
+    /**
+     * Finds the first collider a ray hits. The ray's direction
+     * needn't be normalised; its maxDistance is in world units.
+     * A ray starting inside a collider hits it at distance 0.
+     *
+     * @param ray The ray.
+     * @param hit Set to the closest hit (ties go to the smaller Entity).
+     * @param filter The layers the ray is on and can see.
+     *
+     * @returns True if the ray hit anything.
+    */
+    bool Raycast(const Ray& ray, RaycastHit& hit, const CollisionFilter& filter = AnyLayer()) const
+    {
+        hit = RaycastHit();
+        double length = std::hypot(ray.dirX, ray.dirY);
+        if (!(length > 0) || !std::isfinite(length))
+        {
+            return false;
+        }
+
+        Ray unit = ray;
+        unit.dirX /= length;
+        unit.dirY /= length;
+
+        mCandidates.clear();
+        mBroadphase->QueryRay(unit, filter, mCandidates);
+        for (std::uint32_t proxy : mCandidates)
+        {
+            double distance;
+            int axis;
+            if (proxy < mMoving && mProxies[proxy].filter.CanInteract(filter)
+                && RayHitsBox(unit, mProxies[proxy].bounds, distance, axis))
+            {
+                KeepCloser(unit, proxy, distance, axis, hit);
+            }
+        }
+        mStaticIndex.QueryRay(unit, filter, [&](std::uint32_t s, double distance, int axis)
+        {
+            KeepCloser(unit, mMoving + s, distance, axis, hit);
+        });
+        return hit.hit;
+    }
+
+    /**
+     * Casts many rays at once, such as line-of-sight checks.
+     *
+     * @param rays The rays.
+     * @param hits Resized to one RaycastHit per ray, in the same order.
+     * @param filter The layers the rays are on and can see.
+     *
+     * @returns The number of rays that hit something.
+    */
+    std::size_t RaycastBatch(const std::vector<Ray>& rays, std::vector<RaycastHit>& hits,
+        const CollisionFilter& filter = AnyLayer()) const
+    {
+        hits.resize(rays.size());
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < rays.size(); i++)
+        {
+            count += Raycast(rays[i], hits[i], filter);
+        }
+        return count;
+    }
+
+    /**
+     * Finds this frame's collisions, replacing the last Do()'s
+     * contacts and events. The pair search and the exact tests
+     * are split into tasks on the Coordinator's ThreadPool; the
+     * results are the same for any number of threads.
+    */
     void Do()
     {
-        Coordinator* cd = Coordinator::Get();
-        std::set<Entity>::iterator first;
-        std::set<Entity>::iterator second;
-        for (first = mEntities.begin(); first != mEntities.end(); first++)
+        // Start over even without a Clear(), so calling Do() twice doesn't add contacts or events up
+        Clear();
+        mProxies.clear();
+        mStatics.clear();
+        Coordinator::Get()->View<Transform, RectangleCollider>().ForEach(
+            [this](Entity e, Transform& t, RectangleCollider& c)
+            {
+                CollisionFilter filter = FilterOf(c);
+                if (filter.layers != 0 && filter.mask != 0)
+                {
+                    (c.isStatic ? mStatics : mProxies).push_back({e, BoundsOf(t, c), filter});
+                }
+            });
+
+        // Swap-removes reorder the Component arrays, so compare the statics in Entity order
+        std::sort(mStatics.begin(), mStatics.end(),
+            [](const BroadphaseProxy& x, const BroadphaseProxy& y) { return x.entity < y.entity; });
+        if (!SameProxies(mStatics, mIndexedStatics))
         {
-            Transform& first_transform = cd->GetComponent<Transform>(*first);
-            RectangleCollider& first_collider = cd->GetComponent<RectangleCollider>(*first);
+            mStaticIndex.Build(mStatics);
+            mIndexedStatics.swap(mStatics);
+        }
+
+        // Moving colliders go through the Broadphase, and each looks up the static ones it hits
+        ThreadPool& pool = Coordinator::Get()->GetThreadPool();
+        mPairs.clear();
+        mBroadphase->Update(mProxies);
+        mBroadphase->ParallelFindPairs(pool, mPairs);
+
+        mMoving = static_cast<std::uint32_t>(mProxies.size());
+        ParallelCollect(pool, mMoving, COLLIDERS_PER_TASK, mChunkPairs, mPairs,
+            [this](std::size_t begin, std::size_t end, std::vector<BroadphasePair>& pairs)
+            {
+                for (std::uint32_t i = static_cast<std::uint32_t>(begin); i < end; i++)
+                {
+                    mStaticIndex.Query(mProxies[i].bounds, mProxies[i].filter,
+                        [&](std::uint32_t s) { pairs.push_back({i, mMoving + s}); });
+                }
+            });
+        mProxies.insert(mProxies.end(), mIndexedStatics.begin(), mIndexedStatics.end());
+
+        // Visit pairs in the order a test of every pair would find them
+        std::sort(mPairs.begin(), mPairs.end());
 
-            second = first;
-            second++;
-            for (; second != mEntities.end(); second++)
+        mContacts.clear();
+        mNarrowphase.SetBounds(mProxies);
+        ParallelCollect(pool, mPairs.size(), PAIRS_PER_TASK, mChunkContacts, mContacts,
+            [this](std::size_t begin, std::size_t end, std::vector<Contact>& contacts)
             {
-                Transform& second_transform = cd->GetComponent<Transform>(*second);
-                RectangleCollider& second_collider = cd->GetComponent<RectangleCollider>(*second);
+                std::vector<std::uint32_t> scratch;
+                mNarrowphase.Run(mPairs, begin, end, contacts, scratch);
+            });
+
+        // Last frame's pairs are found again, or end, as this frame's are found
+        std::swap(mTouching, mWasTouching);
+        mTouching.Clear();
+
+        for (const Contact& contact : mContacts)
+        {
+            Entity a = mProxies[contact.first].entity;
+            Entity b = mProxies[contact.second].entity;
 
-                int retval = DoCollisionCheck(first_transform, first_collider, second_transform, second_collider);
-                if (retval == 0) continue;
+            Collision c;
+            c.ent_collided = b;
+            c.collision_pos = contact.sides;
+            mContactBuffer.Add(a, c);
 
-                Collision c;
-                c.ent_collided = *second;
-                c.collision_pos = retval;
-                first_collider.collisions.emplace_back(c);
+            c.ent_collided = a;
+            c.collision_pos = MirrorSides(contact.sides);
+            mContactBuffer.Add(b, c);
 
-                retval = (~retval) & 15;
-                c.ent_collided = *first;
-                c.collision_pos = retval;
-                second_collider.collisions.emplace_back(c);
+            // A pair still left over from last frame is staying; the rest are new
+            std::uint64_t key = PairSet::Key(a, b);
+            mTouching.Insert(key);
+            CollisionEvent event{std::min(a, b), std::max(a, b), a < b ? contact.sides : MirrorSides(contact.sides)};
+            if (mWasTouching.Erase(key))
+            {
+                mStayEvents.push_back(event);
+            }
+            else
+            {
+                mEnterEvents.push_back(event);
             }
         }
+        mContactBuffer.Build();
+
+        // Whatever wasn't found again has ended
+        for (std::uint64_t key : mWasTouching.Keys())
+        {
+            mExitEvents.push_back({PairSet::First(key), PairSet::Second(key), 0});
+        }
+        std::sort(mExitEvents.begin(), mExitEvents.end(),
+            [](const CollisionEvent& a, const CollisionEvent& b)
+            {
+                return a.first < b.first || (a.first == b.first && a.second < b.second);
+            });
     }
 
     void Clear()
     {
+        mContactBuffer.Reset();
+        mEnterEvents.clear();
+        mStayEvents.clear();
+        mExitEvents.clear();
+    }
+
+    void Update() override
+    {
+        Do();
+    }
+
+    SystemAccess GetAccess() override
+    {
+        SystemAccess access;
         Coordinator* cd = Coordinator::Get();
-        for (Entity e : mEntities)
-        {
-            RectangleCollider& c = cd->GetComponent<RectangleCollider>(e);
-            c.collisions.clear();
-        }
+        access.reads.set(cd->GetComponentType<Transform>());
+        access.reads.set(cd->GetComponentType<RectangleCollider>());
+        return access;
     }
 
     Signature GetSignature() override
@@ -0,0 +1,132 @@
+#ifndef _ROC_CONTACT_BUFFER_H_
+#define _ROC_CONTACT_BUFFER_H_
+
+/**
+ * @file ContactBuffer.hpp
+ *
+ * This file defines the ContactBuffer class, which holds every
+ * Collision found in a frame in one array, grouped by Entity.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../Entity.hpp"
+#include "../Components/RectangleCollider.hpp"
+
+/**
+ * @struct ContactSpan
+ *
+ * The Collisions of one Entity: a view into a ContactBuffer,
+ * valid until the buffer is next Reset().
+*/
+struct ContactSpan
+{
+    const Collision* first = nullptr;
+    std::size_t count = 0;
+
+    const Collision* begin() const { return first; }
+    const Collision* end() const { return first + count; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const Collision& operator[](std::size_t i) const { return first[i]; }
+};
+
+/**
+ * @class ContactBuffer
+ *
+ * Collects a frame's Collisions with Add(), then Build() lays
+ * them out in one array sorted by the Entity they belong to,
+ * each Entity's in the order they were added. ContactsOf() finds
+ * an Entity's run of that array through a table indexed by
+ * EntityIndex(), so it costs the same however many contacts
+ * there are.
+ *
+ * The memory is kept from frame to frame, so once the buffer
+ * has grown to the busiest frame it no longer allocates, and
+ * Reset() forgets the whole frame at once: table entries are
+ * tagged with the frame that wrote them, rather than cleared.
+*/
+class ContactBuffer
+{
+public:
+    /** Forgets every contact, keeping the memory. */
+    void Reset();
+
+    /**
+     * Records a Collision of `owner`'s. It can't be looked up
+     * until the next Build().
+    */
+    void Add(Entity owner, const Collision& collision)
+    {
+        mPending.push_back({owner, collision});
+    }
+
+    /**
+     * Sorts the contacts Add()ed since the last Build() (or
+     * Reset()) by Entity, replacing whatever the last Build()
+     * laid out.
+    */
+    void Build();
+
+    /**
+     * @returns The Collisions of `entity` as of the last Build(),
+     * or an empty span if it has none. An Entity destroyed since
+     * still has its old contacts until the next Reset() or
+     * Build(); a new Entity reusing its index doesn't.
+    */
+    ContactSpan ContactsOf(Entity entity) const
+    {
+        std::uint32_t index = EntityIndex(entity);
+        if (index >= mSlots.size())
+        {
+            return {};
+        }
+
+        const Slot& slot = mSlots[index];
+        if (slot.frame != mFrame || slot.entity != entity)
+        {
+            return {};
+        }
+        return {mCollisions.data() + slot.begin, slot.count};
+    }
+
+    /** @returns Every Entity with a contact, in ascending order. */
+    const std::vector<Entity>& GetOwners() const { return mOwners; }
+
+    /** @returns Every contact, grouped by Entity in the order of GetOwners(). */
+    const std::vector<Collision>& GetCollisions() const { return mCollisions; }
+
+    /** @returns The number of contacts in the buffer. */
+    std::size_t Size() const { return mCollisions.size(); }
+
+private:
+    /** Moves on to a new frame tag, making every Slot stale. */
+    void NextFrame();
+
+    struct Pending
+    {
+        Entity owner;
+        Collision collision;
+    };
+
+    /** Where an Entity's run of mCollisions is, if `frame` is current */
+    struct Slot
+    {
+        std::uint32_t frame = 0;
+        Entity entity = 0;
+        std::uint32_t begin = 0;
+        std::uint32_t count = 0;
+    };
+
+    std::vector<Pending> mPending;
+    std::vector<Collision> mCollisions;
+    std::vector<Entity> mOwners;
+    std::vector<Slot> mSlots;
+
+    /** Starts at 1, so fresh Slots are never current */
+    std::uint32_t mFrame = 1;
+};
+
+#endif
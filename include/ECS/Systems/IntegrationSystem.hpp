@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#include "../Coordinator.hpp"
+#include "../Components/Transform.hpp"
+#include "../Components/Velocity.hpp"
+#include "../Components/Gravity.hpp"
+
+/**
+ * @class IntegrationSystem
+ *
+ * Moves every Entity with a Transform and a Velocity, one
+ * fixed timestep at a time, with semi-implicit Euler: Gravity
+ * (on the Entities that have it) changes the velocity first,
+ * and the new velocity then moves the Transform. Gravity pulls
+ * towards -y, `gravity` units per second per second.
+ *
+ * Each Update() runs exactly one step, so the simulation
+ * doesn't depend on the frame rate. Games that want to keep
+ * up with wall-clock time call Advance() with each frame's
+ * length instead.
+ *
+ * Bodies only go through in batches under
+ * ROCKET_ARCHETYPE_STORAGE, where Step() hands whole table
+ * chunks to ApplyGravity() and ApplyVelocity(), loops over
+ * contiguous arrays the compiler can vectorise. With the
+ * default sparse-set storage Step() goes through
+ * View::ForEach() one body at a time.
+ *
+ * Transform, Velocity and Gravity must all be registered.
+ *
+ * ```
+ * auto integration = cd->RegisterSystem<IntegrationSystem>();
+ * cd->SetSystemSignature<IntegrationSystem>(integration->GetSignature());
+ * integration->Advance(frameSeconds);
+ * ```
+*/
+class IntegrationSystem : public System
+{
+public:
+    /** The timestep a new IntegrationSystem starts with, in seconds. */
+    static constexpr double DEFAULT_TIMESTEP = 1.0 / 60.0;
+
+    /**
+     * The most steps one Advance() runs. A frame longer than
+     * this many steps only moves things this far, rather than
+     * leaving the next frame even further behind.
+    */
+    static constexpr std::size_t MAX_STEPS_PER_ADVANCE = 8;
+
+    /**
+     * @param seconds The length of a step. Lengths that aren't
+     * positive and finite are ignored.
+    */
+    void SetTimestep(double seconds)
+    {
+        if (seconds > 0 && std::isfinite(seconds))
+        {
+            mTimestep = seconds;
+        }
+    }
+
+    /** @returns The length of a step, in seconds. */
+    double GetTimestep() const { return mTimestep; }
+
+    /**
+     * Adds a frame's worth of time and runs a step for each
+     * whole timestep that has built up, keeping the remainder
+     * for the next call.
+     *
+     * @param seconds The time since the last call.
+     *
+     * @returns The number of steps run.
+    */
+    std::size_t Advance(double seconds)
+    {
+        if (!(seconds > 0) || !std::isfinite(seconds))
+        {
+            return 0;
+        }
+
+        mAccumulated += seconds;
+        std::size_t steps = 0;
+        while (mAccumulated >= mTimestep && steps < MAX_STEPS_PER_ADVANCE)
+        {
+            Step();
+            mAccumulated -= mTimestep;
+            steps++;
+        }
+        if (mAccumulated >= mTimestep)
+        {
+            mAccumulated = std::fmod(mAccumulated, mTimestep);
+        }
+        return steps;
+    }
+
+    /**
+     * @returns How far the time left over from Advance() is
+     * into the next step, from 0 up to 1, for drawing Entities
+     * between their last two positions.
+    */
+    double GetInterpolation() const { return mAccumulated / mTimestep; }
+
+    /** Runs one step of GetTimestep() seconds. */
+    void Step()
+    {
+        Coordinator* cd = Coordinator::Get();
+        const double dt = mTimestep;
+#ifdef ROCKET_ARCHETYPE_STORAGE
+        // Each table chunk holds its Components in columns, so whole chunks go through at once
+        cd->View<Velocity, Gravity>().ForEachChunk(
+            [dt](std::size_t rows, const Entity*, Velocity* velocities, Gravity* gravities)
+            {
+                ApplyGravity(velocities, gravities, rows, dt);
+            });
+        cd->View<Transform, Velocity>().ForEachChunk(
+            [dt](std::size_t rows, const Entity*, Transform* transforms, Velocity* velocities)
+            {
+                ApplyVelocity(transforms, velocities, rows, dt);
+            });
+#else
+        // An Entity's Components sit at different places in each array, so bodies go one at a time
+        cd->View<Velocity, Gravity>().ForEach([dt](Entity, Velocity& v, Gravity& g)
+        {
+            v.y -= g.gravity * dt;
+        });
+        cd->View<Transform, Velocity>().ForEach([dt](Entity, Transform& t, Velocity& v)
+        {
+            t.x += v.x * dt;
+            t.y += v.y * dt;
+        });
+#endif
+    }
+
+    /**
+     * Applies one step of gravity to `count` bodies whose
+     * Components are stored side by side.
+    */
+    static void ApplyGravity(Velocity* velocities, const Gravity* gravities, std::size_t count, double dt);
+
+    /**
+     * Moves `count` bodies whose Components are stored side by
+     * side by one step of their velocity.
+    */
+    static void ApplyVelocity(Transform* transforms, const Velocity* velocities, std::size_t count, double dt);
+
+    /** Runs one step. */
+    void Update() override
+    {
+        Step();
+    }
+
+    SystemAccess GetAccess() override
+    {
+        SystemAccess access;
+        Coordinator* cd = Coordinator::Get();
+        access.writes.set(cd->GetComponentType<Transform>());
+        access.writes.set(cd->GetComponentType<Velocity>());
+        access.reads.set(cd->GetComponentType<Gravity>());
+        return access;
+    }
+
+    Signature GetSignature() override
+    {
+        Signature sig;
+        Coordinator* cd = Coordinator::Get();
+        sig[cd->GetComponentType<Transform>()].flip();
+        sig[cd->GetComponentType<Velocity>()].flip();
+        return sig;
+    }
+
+private:
+    double mTimestep = DEFAULT_TIMESTEP;
+
+    /** Time passed to Advance() not yet stepped through. */
+    double mAccumulated = 0;
+};
@@ -0,0 +1,149 @@
+#ifndef _ROC_NARROWPHASE_H_
+#define _ROC_NARROWPHASE_H_
+
+/**
+ * @file Narrowphase.hpp
+ *
+ * This file defines the Narrowphase class, which runs the
+ * exact box tests on a Broadphase's candidate pairs, several
+ * candidates at a time with SIMD instructions where the CPU
+ * has them.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Broadphase.hpp"
+
+/** The instruction sets the Narrowphase can test boxes with. */
+enum class SimdLevel
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+/**
+ * @returns The sides of `box` that `other` overlaps, as a mix
+ * of the COLLISION_LEFT/TOP/RIGHT/BOTTOM flags: the side(s)
+ * `other` pushes in the least from. Y points up, so TOP is the
+ * maxY side. Two sides are set when `other` comes in exactly
+ * diagonally, and 0 is returned if the boxes don't overlap.
+*/
+int CollisionSides(const AABB& box, const AABB& other);
+
+/** @returns The sides flags as seen from the other box: LEFT and RIGHT swapped, TOP and BOTTOM swapped. */
+int MirrorSides(int sides);
+
+/**
+ * @struct Contact
+ *
+ * Two overlapping colliders, as indices into the proxies the
+ * Narrowphase was given, with the sides of the first one hit.
+*/
+struct Contact
+{
+    std::uint32_t first;
+    std::uint32_t second;
+    int sides;
+};
+
+/**
+ * @class Narrowphase
+ *
+ * Keeps the colliders' bounds as four separate arrays (all
+ * the minX, all the minY, ...) and tests each collider against
+ * its candidates in blocks: four at a time with AVX2, two at a
+ * time with SSE2, or one at a time otherwise. Which of those
+ * the CPU supports is checked at runtime.
+ *
+ * SSE2 is the default even where AVX2 is available: candidates
+ * sit at scattered indices, so every lane is its own load, and
+ * packing four of them into a 256-bit register costs more than
+ * the wider compare saves.
+*/
+class Narrowphase
+{
+public:
+    /** The most candidates OverlapMask() takes at once. */
+    static constexpr std::size_t MASK_BITS = 32;
+
+    /** Starts at SimdLevel::SSE2, or Scalar where the build has no SSE2. */
+    Narrowphase();
+
+    /** @returns The widest SimdLevel this CPU (and build) supports. */
+    static SimdLevel BestSimdLevel();
+
+    /**
+     * Picks the instruction set to test with, e.g. to compare
+     * them. Levels the CPU doesn't support fall back to the best
+     * one it does.
+    */
+    void SetSimdLevel(SimdLevel level);
+
+    /** @returns The instruction set tests run with. */
+    SimdLevel GetSimdLevel() const { return mLevel; }
+
+    /**
+     * Copies every collider's bounds into the arrays tested
+     * against. Index i of `proxies` stays collider i.
+    */
+    void SetBounds(const std::vector<BroadphaseProxy>& proxies);
+
+    /**
+     * Tests collider `box` against up to MASK_BITS others.
+     *
+     * @param box The collider to test.
+     * @param candidates The colliders to test it against.
+     * @param count How many candidates there are (at most MASK_BITS).
+     *
+     * @returns A mask with bit k set if `box` overlaps `candidates[k]`.
+    */
+    std::uint32_t OverlapMask(std::uint32_t box, const std::uint32_t* candidates, std::size_t count) const;
+
+    /**
+     * Tests every candidate pair and appends a Contact for each
+     * that overlaps, in the order of `pairs`.
+     *
+     * @param pairs The candidate pairs, grouped by first collider
+     * (any grouping works, but longer groups test faster).
+     * @param contacts The vector to append to.
+    */
+    void Run(const std::vector<BroadphasePair>& pairs, std::vector<Contact>& contacts);
+
+    /**
+     * Like Run(), for pairs [begin, end) only. This only reads
+     * the Narrowphase, so several threads can test chunks of the
+     * same pairs at once, each with its own `contacts` and
+     * `scratch`.
+     *
+     * @param scratch Holds each group's candidates while they're tested.
+    */
+    void Run(const std::vector<BroadphasePair>& pairs, std::size_t begin, std::size_t end,
+        std::vector<Contact>& contacts, std::vector<std::uint32_t>& scratch) const;
+
+private:
+    /** @returns The bounds of collider i. */
+    AABB BoundsOf(std::uint32_t i) const
+    {
+        AABB bounds;
+        bounds.minX = mMinX[i];
+        bounds.minY = mMinY[i];
+        bounds.maxX = mMaxX[i];
+        bounds.maxY = mMaxY[i];
+        return bounds;
+    }
+
+    SimdLevel mLevel;
+
+    std::vector<double> mMinX;
+    std::vector<double> mMinY;
+    std::vector<double> mMaxX;
+    std::vector<double> mMaxY;
+
+    /** The second colliders of the group of pairs being tested */
+    std::vector<std::uint32_t> mCandidates;
+};
+
+#endif
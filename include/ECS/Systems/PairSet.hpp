@@ -0,0 +1,180 @@
+#ifndef _ROC_PAIR_SET_H_
+#define _ROC_PAIR_SET_H_
+
+/**
+ * @file PairSet.hpp
+ *
+ * This file defines the PairSet class, a hash set of unordered
+ * pairs of 32-bit ids, used to track overlapping colliders.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class PairSet
+ *
+ * An open-addressing hash set of pairs. The pairs themselves
+ * live packed in one array (in no particular order), so going
+ * over every pair is a plain loop; the table only maps a pair
+ * to its place in that array. Removing a pair moves the last
+ * one into its place.
+*/
+class PairSet
+{
+public:
+    /** @returns The key of an unordered pair: the smaller id in the high half. */
+    static std::uint64_t Key(std::uint32_t a, std::uint32_t b)
+    {
+        return a < b ? (static_cast<std::uint64_t>(a) << 32) | b : (static_cast<std::uint64_t>(b) << 32) | a;
+    }
+
+    /** @returns The smaller id of a pair. */
+    static std::uint32_t First(std::uint64_t key) { return static_cast<std::uint32_t>(key >> 32); }
+
+    /** @returns The larger id of a pair. */
+    static std::uint32_t Second(std::uint64_t key) { return static_cast<std::uint32_t>(key & 0xFFFFFFFF); }
+
+    /** @returns True if the pair was added, false if it was already there. */
+    bool Insert(std::uint64_t key)
+    {
+        if ((mKeys.size() + 1) * 2 > mSlots.size())
+        {
+            Rehash(std::max<std::size_t>(16, mSlots.size() * 2));
+        }
+
+        std::size_t slot = Home(key);
+        while (mSlots[slot] != EMPTY)
+        {
+            if (mKeys[mSlots[slot]] == key)
+            {
+                return false;
+            }
+            slot = (slot + 1) & (mSlots.size() - 1);
+        }
+        mSlots[slot] = static_cast<std::uint32_t>(mKeys.size());
+        mKeys.push_back(key);
+        return true;
+    }
+
+    /** @returns True if the pair was removed, false if it wasn't there. */
+    bool Erase(std::uint64_t key)
+    {
+        std::size_t slot = Find(key);
+        if (slot == NOT_FOUND)
+        {
+            return false;
+        }
+
+        // Move the last pair into the freed place in the array
+        std::uint32_t index = mSlots[slot];
+        std::uint64_t last = mKeys.back();
+        if (last != key)
+        {
+            mSlots[Find(last)] = index;
+            mKeys[index] = last;
+        }
+        mKeys.pop_back();
+
+        // Pull later entries of the probe run back over the hole
+        std::size_t mask = mSlots.size() - 1;
+        std::size_t hole = slot;
+        std::size_t next = (hole + 1) & mask;
+        while (mSlots[next] != EMPTY)
+        {
+            std::size_t home = Home(mKeys[mSlots[next]]);
+            if (((next - home) & mask) >= ((next - hole) & mask))
+            {
+                mSlots[hole] = mSlots[next];
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+        mSlots[hole] = EMPTY;
+        return true;
+    }
+
+    /** @returns True if the pair is in the set. */
+    bool Contains(std::uint64_t key) const { return Find(key) != NOT_FOUND; }
+
+    /** Removes every pair for which `pred(key)` is true. */
+    template<typename F>
+    void EraseIf(F&& pred)
+    {
+        std::size_t size = mKeys.size();
+        mKeys.erase(std::remove_if(mKeys.begin(), mKeys.end(), pred), mKeys.end());
+        if (mKeys.size() != size)
+        {
+            Rehash(mSlots.size());
+        }
+    }
+
+    /** Removes every pair, keeping the memory. */
+    void Clear()
+    {
+        mKeys.clear();
+        std::fill(mSlots.begin(), mSlots.end(), EMPTY);
+    }
+
+    std::size_t Size() const { return mKeys.size(); }
+    bool Empty() const { return mKeys.empty(); }
+
+    /** @returns Every pair in the set, in no particular order. */
+    const std::vector<std::uint64_t>& Keys() const { return mKeys; }
+
+private:
+    static constexpr std::uint32_t EMPTY = UINT32_MAX;
+    static constexpr std::size_t NOT_FOUND = SIZE_MAX;
+
+    std::size_t Home(std::uint64_t key) const
+    {
+        // The 64-bit finalizer of MurmurHash3, so neighbouring ids spread out
+        key ^= key >> 33;
+        key *= 0xFF51AFD7ED558CCDULL;
+        key ^= key >> 33;
+        key *= 0xC4CEB9FE1A85EC53ULL;
+        key ^= key >> 33;
+        return static_cast<std::size_t>(key) & (mSlots.size() - 1);
+    }
+
+    std::size_t Find(std::uint64_t key) const
+    {
+        if (mSlots.empty())
+        {
+            return NOT_FOUND;
+        }
+
+        std::size_t slot = Home(key);
+        while (mSlots[slot] != EMPTY)
+        {
+            if (mKeys[mSlots[slot]] == key)
+            {
+                return slot;
+            }
+            slot = (slot + 1) & (mSlots.size() - 1);
+        }
+        return NOT_FOUND;
+    }
+
+    void Rehash(std::size_t slots)
+    {
+        mSlots.assign(slots, EMPTY);
+        for (std::uint32_t index = 0; index < mKeys.size(); index++)
+        {
+            std::size_t slot = Home(mKeys[index]);
+            while (mSlots[slot] != EMPTY)
+            {
+                slot = (slot + 1) & (slots - 1);
+            }
+            mSlots[slot] = index;
+        }
+    }
+
+    /** Each slot holds an index into mKeys, or EMPTY. The size is a power of two. */
+    std::vector<std::uint32_t> mSlots;
+    std::vector<std::uint64_t> mKeys;
+};
+
+#endif
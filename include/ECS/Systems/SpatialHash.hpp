@@ -0,0 +1,157 @@
+#ifndef _ROC_SPATIAL_HASH_H_
+#define _ROC_SPATIAL_HASH_H_
+
+/**
+ * @file SpatialHash.hpp
+ *
+ * This file defines the SpatialHashBroadphase, which bins
+ * colliders into a uniform grid of square cells.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Broadphase.hpp"
+
+/**
+ * @class SpatialHashBroadphase
+ *
+ * Bins every collider into each grid cell its bounds cover
+ * and only pairs up colliders sharing a cell. The grid is
+ * unbounded: cells are keyed by their coordinates, and the
+ * entries are sorted by key so each cell's colliders sit
+ * next to each other.
+ *
+ * A pair sharing several cells is only reported by the first
+ * cell both cover, so nothing is reported twice. Colliders
+ * covering more than MAX_CELLS_PER_PROXY cells (or with bounds
+ * that aren't finite) are kept out of the grid and tested
+ * against every other collider instead.
+ *
+ * The cell size should be around the size of a typical
+ * collider: much smaller bins each collider many times, much
+ * larger puts too many colliders in each cell.
+*/
+class SpatialHashBroadphase : public Broadphase
+{
+public:
+    /** The most cells one collider is binned into. */
+    static constexpr std::size_t MAX_CELLS_PER_PROXY = 1024;
+
+    /** How many occupied cells ParallelFindPairs() hands to one task. */
+    static constexpr std::size_t CELLS_PER_TASK = 512;
+
+    /**
+     * @param cellSize The width and height of a cell, in world units.
+    */
+    explicit SpatialHashBroadphase(double cellSize = 64.0);
+
+    /**
+     * Changes the cell size. Takes effect on the next Update().
+     *
+     * @param cellSize The width and height of a cell, in world
+     * units. Sizes that aren't positive are ignored.
+    */
+    void SetCellSize(double cellSize);
+
+    /** @returns The width and height of a cell, in world units. */
+    double GetCellSize() const { return mCellSize; }
+
+    void Update(const std::vector<BroadphaseProxy>& proxies) override;
+    void FindPairs(std::vector<BroadphasePair>& pairs) override;
+
+    /** Pairs up the colliders of each run of CELLS_PER_TASK cells as one task. */
+    void ParallelFindPairs(ThreadPool& pool, std::vector<BroadphasePair>& pairs) override;
+
+    /**
+     * Looks up each cell `bounds` covers. A box covering more
+     * than MAX_CELLS_PER_PROXY cells tests every collider instead.
+    */
+    void Query(const AABB& bounds, const CollisionFilter& filter, std::vector<std::uint32_t>& proxies) const override;
+
+    /**
+     * Walks the cells the ray passes through, nearest first,
+     * appending only colliders it hits, and stops at the first
+     * cell further along than the closest of them. Only the
+     * occupied part of the grid is walked, so an unbounded ray
+     * ends there too; a walk that runs on for more cells than
+     * there are colliders tests the rest of them directly. Not
+     * safe to call from two threads at once.
+    */
+    void QueryRay(const Ray& ray, const CollisionFilter& filter, std::vector<std::uint32_t>& proxies) const override;
+
+private:
+    /** The cells a collider covers, inclusive. */
+    struct CellRange
+    {
+        std::int32_t minX;
+        std::int32_t minY;
+        std::int32_t maxX;
+        std::int32_t maxY;
+    };
+
+    struct CellEntry
+    {
+        std::uint64_t cell;
+        std::uint32_t proxy;
+    };
+
+    std::int32_t CellOf(double coordinate) const;
+
+    /** Tests the ray against the colliders of one cell, appending the unseen ones it hits. */
+    void RayCell(const Ray& ray, const CollisionFilter& filter, std::int32_t x, std::int32_t y,
+        double& closest, std::vector<std::uint32_t>& proxies) const;
+
+    /** Pairs up the colliders sharing each cell of mEntries[begin, last), which must start and end on a cell. */
+    void PairCells(std::size_t begin, std::size_t last, std::vector<BroadphasePair>& pairs) const;
+
+    /** Tests mOversized[begin, end) against every other collider. */
+    void PairOversized(std::size_t begin, std::size_t end, std::vector<BroadphasePair>& pairs) const;
+
+    /** @returns The cells a box covers, or an empty range for a box with a NaN side. */
+    CellRange RangeOf(const AABB& bounds) const;
+
+    /** @returns The number of cells in a range. */
+    static std::uint64_t CellCount(const CellRange& range)
+    {
+        // In 64 bits, as a clamped infinite range spans 2^31 cells
+        std::int64_t width = std::int64_t(range.maxX) - range.minX + 1;
+        std::int64_t height = std::int64_t(range.maxY) - range.minY + 1;
+        return static_cast<std::uint64_t>(std::max<std::int64_t>(width, 0))
+            * static_cast<std::uint64_t>(std::max<std::int64_t>(height, 0));
+    }
+
+    static std::uint64_t CellKey(std::int32_t x, std::int32_t y)
+    {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+    }
+
+    double mCellSize;
+    double mInverseCellSize;
+
+    std::vector<AABB> mBounds;
+    std::vector<CollisionFilter> mFilters;
+    std::vector<CellRange> mRanges;
+
+    /** One entry per (cell, collider), sorted by cell then collider */
+    std::vector<CellEntry> mEntries;
+
+    /** Colliders too big (or too broken) to bin */
+    std::vector<std::uint32_t> mOversized;
+    std::vector<bool> mIsOversized;
+
+    /** The cells the binned colliders cover between them, inclusive */
+    CellRange mGrid{0, 0, -1, -1};
+
+    /** Marks the colliders the current QueryRay() has seen, so it visits each once */
+    mutable std::vector<std::uint32_t> mRayMarks;
+    mutable std::uint32_t mRayMark = 0;
+
+    /** Where each cell's entries start, for ParallelFindPairs() */
+    std::vector<std::size_t> mCellStarts;
+    std::vector<std::vector<BroadphasePair>> mChunkPairs;
+};
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef _ROC_STATIC_INDEX_H_
+#define _ROC_STATIC_INDEX_H_
+
+/**
+ * @file StaticIndex.hpp
+ *
+ * This file defines the StaticIndex class, a bounding volume
+ * hierarchy over colliders that never move, built in one go.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Broadphase.hpp"
+
+/**
+ * @class StaticIndex
+ *
+ * A read-only tree of boxes over the static colliders of a
+ * level, such as walls and platforms. Build() sorts them into
+ * a balanced tree by splitting each group in half along its
+ * longer axis, laid out flat in the order a query visits it,
+ * with each leaf's colliders stored next to each other. Unlike
+ * the AABBTreeBroadphase nothing is fattened or rebalanced,
+ * since the colliders never move; the whole tree is simply
+ * built again if they change.
+ *
+ * Like the AABBTreeBroadphase, every node holds the union of
+ * its colliders' CollisionFilters, so queries skip subtrees of
+ * colliders that can't interact without testing their boxes.
+*/
+class StaticIndex
+{
+public:
+    /** The most colliders a leaf holds. */
+    static constexpr std::size_t LEAF_SIZE = 4;
+
+    /**
+     * Builds the tree over `proxies`, replacing the last one.
+     * Colliders with NaN bounds overlap nothing and are left out.
+    */
+    void Build(const std::vector<BroadphaseProxy>& proxies);
+
+    /**
+     * Calls `func(i)` for every collider overlapping `bounds`
+     * that can interact with `filter`, where i is the
+     * collider's index in the proxies handed to Build().
+    */
+    template<typename F>
+    void Query(const AABB& bounds, const CollisionFilter& filter, F&& func) const
+    {
+        if (mNodes.empty())
+        {
+            return;
+        }
+
+        // The tree is balanced, so its depth stays far below this
+        std::uint32_t stack[64];
+        std::size_t depth = 0;
+        stack[depth++] = 0;
+        while (depth > 0)
+        {
+            std::uint32_t index = stack[--depth];
+            const Node& node = mNodes[index];
+            if (!node.filter.CanInteract(filter) || !node.bounds.Overlaps(bounds))
+            {
+                continue;
+            }
+
+            if (node.right == 0)
+            {
+                for (std::uint32_t i = node.begin; i < node.begin + node.count; i++)
+                {
+                    const Item& item = mItems[i];
+                    if (item.filter.CanInteract(filter) && item.bounds.Overlaps(bounds))
+                    {
+                        func(item.proxy);
+                    }
+                }
+            }
+            else
+            {
+                stack[depth++] = node.right;
+                stack[depth++] = index + 1;
+            }
+        }
+    }
+
+    /**
+     * Calls `func(i, distance, axis)` for every collider `ray`
+     * hits that can interact with `filter`, with the collider's
+     * index and where the ray enters it, as from RayHitsBox().
+    */
+    template<typename F>
+    void QueryRay(const Ray& ray, const CollisionFilter& filter, F&& func) const
+    {
+        if (mNodes.empty())
+        {
+            return;
+        }
+
+        std::uint32_t stack[64];
+        std::size_t depth = 0;
+        stack[depth++] = 0;
+        while (depth > 0)
+        {
+            std::uint32_t index = stack[--depth];
+            const Node& node = mNodes[index];
+            double distance;
+            int axis;
+            if (!node.filter.CanInteract(filter) || !RayHitsBox(ray, node.bounds, distance, axis))
+            {
+                continue;
+            }
+
+            if (node.right == 0)
+            {
+                for (std::uint32_t i = node.begin; i < node.begin + node.count; i++)
+                {
+                    const Item& item = mItems[i];
+                    if (item.filter.CanInteract(filter) && RayHitsBox(ray, item.bounds, distance, axis))
+                    {
+                        func(item.proxy, distance, axis);
+                    }
+                }
+            }
+            else
+            {
+                stack[depth++] = node.right;
+                stack[depth++] = index + 1;
+            }
+        }
+    }
+
+    /** @returns The number of colliders in the tree. */
+    std::size_t Size() const { return mItems.size(); }
+
+    /** @returns The number of times Build() has run. */
+    std::size_t GetBuildCount() const { return mBuilds; }
+
+private:
+    struct Item
+    {
+        AABB bounds;
+        CollisionFilter filter;
+        std::uint32_t proxy;
+    };
+
+    /** A node's left child follows it; `right` is 0 for a leaf, which owns items [begin, begin + count). */
+    struct Node
+    {
+        AABB bounds;
+        CollisionFilter filter;
+        std::uint32_t right = 0;
+        std::uint32_t begin = 0;
+        std::uint32_t count = 0;
+    };
+
+    /** Builds the subtree over mItems[begin, end) and returns its node. */
+    std::uint32_t BuildNode(std::uint32_t begin, std::uint32_t end);
+
+    std::vector<Node> mNodes;
+    std::vector<Item> mItems;
+    std::size_t mBuilds = 0;
+};
+
+#endif
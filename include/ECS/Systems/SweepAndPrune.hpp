@@ -0,0 +1,161 @@
+#ifndef _ROC_SWEEP_AND_PRUNE_H_
+#define _ROC_SWEEP_AND_PRUNE_H_
+
+/**
+ * @file SweepAndPrune.hpp
+ *
+ * This file defines the SweepAndPruneBroadphase, which keeps
+ * the colliders' interval endpoints sorted along one or both
+ * axes from frame to frame.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Broadphase.hpp"
+#include "PairSet.hpp"
+
+/** The axes a SweepAndPruneBroadphase sorts along. */
+enum class SweepAxes
+{
+    X,
+    Y,
+    Both
+};
+
+/**
+ * @class SweepAndPruneBroadphase
+ *
+ * Keeps the start and end of every collider's interval on an
+ * axis in one sorted array. Colliders move little between
+ * frames, so the array stays nearly sorted and an insertion
+ * sort puts it back in order in close to linear time.
+ *
+ * Every swap the sort makes between the start of one interval
+ * and the end of another means two colliders started or
+ * stopped overlapping along that axis, and the set of
+ * overlapping pairs is updated right there. With SweepAxes::Both
+ * a pair is kept while the colliders overlap on both axes;
+ * sorting along a single axis is cheaper and suits worlds
+ * spread out along that axis, like a side-scroller's level,
+ * at the cost of more candidate pairs.
+ *
+ * When many colliders appear at once, or any collider's
+ * CollisionFilter changes, the arrays are sorted from scratch
+ * and the pairs found with a single sweep.
+*/
+class SweepAndPruneBroadphase : public Broadphase
+{
+public:
+    /**
+     * @param axes The axes to sort along.
+    */
+    explicit SweepAndPruneBroadphase(SweepAxes axes = SweepAxes::Both);
+
+    /** @returns The axes sorted along. */
+    SweepAxes GetAxes() const { return mAxes; }
+
+    void Update(const std::vector<BroadphaseProxy>& proxies) override;
+    void FindPairs(std::vector<BroadphasePair>& pairs) override;
+
+    /**
+     * Tests the colliders starting, on the first sorted axis,
+     * between where `bounds` ends and the widest collider's
+     * width before where it starts; none outside that can
+     * overlap it. A query costs log n plus the colliders in that
+     * window, so one very wide collider makes every query
+     * slower.
+    */
+    void Query(const AABB& bounds, const CollisionFilter& filter, std::vector<std::uint32_t>& proxies) const override;
+
+    /**
+     * @returns The number of endpoint swaps the last Update()
+     * made, which stays small while colliders move smoothly.
+    */
+    std::size_t GetSwapCount() const { return mSwaps; }
+
+private:
+    struct Interval
+    {
+        double min;
+        double max;
+    };
+
+    struct Box
+    {
+        /** The box's extent along x and y, as its endpoints sort */
+        Interval extent[2];
+
+        Entity entity = 0;
+        CollisionFilter filter;
+
+        /** The box's index in the last Update() */
+        std::uint32_t proxy = 0;
+
+        /** The last Update() that saw the box */
+        std::uint32_t stamp = 0;
+
+        bool alive = false;
+    };
+
+    struct Endpoint
+    {
+        double value;
+        std::uint32_t box;
+        bool isMax;
+    };
+
+    /** One axis: its endpoints, sorted, and which coordinates of a box they take */
+    struct Axis
+    {
+        std::vector<Endpoint> endpoints;
+        int index;
+    };
+
+    /** @returns A collider's extent along an axis, cleaned up so its endpoints sort. */
+    static Interval IntervalOf(const AABB& bounds, int axis);
+
+    /**
+     * The order endpoints are kept in. At equal values ends go
+     * before starts, so boxes that only touch never overlap.
+    */
+    static bool Less(const Endpoint& a, const Endpoint& b)
+    {
+        return a.value < b.value || (a.value == b.value && a.isMax && !b.isMax);
+    }
+
+    /**
+     * @returns True if two boxes can interact and overlap on
+     * every sorted axis except `skip` (-1 for none).
+    */
+    bool OverlapElsewhere(std::uint32_t a, std::uint32_t b, int skip) const;
+
+    /** Insertion sorts an axis, updating mPairs on every start/end swap. */
+    void SortAxis(Axis& axis);
+
+    /** Sorts every axis from scratch and sweeps the first for all pairs. */
+    void Rebuild();
+
+    std::uint32_t AllocateBox();
+
+    SweepAxes mAxes;
+    std::vector<Axis> mSortAxes;
+
+    std::vector<Box> mBoxes;
+    std::vector<std::uint32_t> mFreeBoxes;
+
+    /** The box of each EntityIndex(), or UINT32_MAX */
+    std::vector<std::uint32_t> mBoxOf;
+
+    /** Overlapping boxes */
+    PairSet mPairs;
+
+    /** The widest box along the first sorted axis, as of the last Update() */
+    double mMaxExtent = 0;
+
+    std::uint32_t mStamp = 0;
+    std::size_t mSwaps = 0;
+};
+
+#endif
@@ -0,0 +1,288 @@
+#ifndef _ROC_THREAD_POOL_H_
+#define _ROC_THREAD_POOL_H_
+
+/**
+ * @file ThreadPool.hpp
+ *
+ * This file defines the ThreadPool class, a work-stealing pool
+ * of worker threads, TaskGroup, which waits on a set of tasks
+ * run on a ThreadPool, ParallelFor(), which splits a range
+ * of indices across one, and ParallelCollect(), which does the
+ * same for loops that produce results.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ *
+ * A fixed set of worker threads, each with its own task queue.
+ * A worker runs the newest task of its own queue first (which
+ * is usually the one whose data is still in cache) and, when
+ * that runs dry, steals the oldest task of another queue.
+ *
+ * Tasks submitted from a worker go to that worker's queue;
+ * tasks submitted from any other thread are dealt round-robin.
+ * Threads waiting on tasks should help run them (see
+ * TaskGroup::Wait()) rather than block, so tasks may safely
+ * wait on tasks of their own.
+*/
+class ThreadPool
+{
+public:
+	using Task = std::function<void()>;
+
+	/**
+	 * Starts the worker threads.
+	 *
+	 * @param workers The number of worker threads. With 0, tasks
+	 * only run on threads that wait for them.
+	*/
+	explicit ThreadPool(std::size_t workers);
+
+	/** Finishes every queued task, then joins the workers. */
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/**
+	 * Queues a task to run on some thread of the pool.
+	 *
+	 * @param task The task, which must not throw (use a
+	 * TaskGroup to get exceptions back).
+	*/
+	void Submit(Task task);
+
+	/**
+	 * Runs one queued task on the calling thread, if there is
+	 * one.
+	 *
+	 * @returns True if a task was run.
+	*/
+	bool RunPending();
+
+	/** @returns The number of worker threads. */
+	std::size_t WorkerCount() const { return mThreads.size(); }
+
+	/**
+	 * @returns The number of worker threads plus one for the
+	 * thread that waits on the work, i.e. how many ways work
+	 * can usefully be split.
+	*/
+	std::size_t Concurrency() const { return mThreads.size() + 1; }
+
+	/**
+	 * @returns The number of threads the hardware can run at
+	 * once, minus the calling thread (at least 1).
+	*/
+	static std::size_t DefaultWorkerCount();
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void WorkerLoop(std::size_t index);
+
+	/** Pops from the back of queue `first`, else steals from the front of the others. */
+	bool TryRun(std::size_t first);
+
+	/** @returns The queue index of the calling thread if it is one of our workers, else SIZE_MAX. */
+	std::size_t CurrentWorker() const;
+
+	std::vector<std::unique_ptr<Queue>> mQueues;
+	std::vector<std::thread> mThreads;
+
+	/** Tasks queued but not yet started. */
+	std::atomic<std::size_t> mPending{0};
+
+	/** Round-robin counter for tasks submitted from outside. */
+	std::atomic<std::size_t> mNextQueue{0};
+
+	std::mutex mSleepMutex;
+	std::condition_variable mWake;
+	bool mStopping = false;
+};
+
+/**
+ * @class TaskGroup
+ *
+ * Runs tasks on a ThreadPool and waits for all of them. Tasks
+ * may add more tasks to the same group while it is running.
+ *
+ * ```
+ * TaskGroup group(pool);
+ * group.Run([&]{ ... });
+ * group.Run([&]{ ... });
+ * group.Wait();
+ * ```
+*/
+class TaskGroup
+{
+public:
+	explicit TaskGroup(ThreadPool& pool) : mPool(pool) {}
+
+	/** Waits for any task still running. */
+	~TaskGroup();
+
+	TaskGroup(const TaskGroup&) = delete;
+	TaskGroup& operator=(const TaskGroup&) = delete;
+
+	/**
+	 * Queues a task in the group.
+	 *
+	 * @param task The task to run.
+	*/
+	void Run(ThreadPool::Task task);
+
+	/**
+	 * Runs queued tasks on the calling thread until every task
+	 * of the group has finished. Rethrows the first exception a
+	 * task of the group threw, if any.
+	*/
+	void Wait();
+
+private:
+	/** Helps run tasks until none of the group's are left. */
+	void Drain();
+
+	ThreadPool& mPool;
+	std::atomic<std::size_t> mRemaining{0};
+
+	std::mutex mErrorMutex;
+	std::exception_ptr mError;
+};
+
+/** The size of a cache line, which parallel loops align their chunks to. */
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+/** The default number of elements a parallel loop hands to one task. */
+constexpr std::size_t DEFAULT_GRAIN_SIZE = 1024;
+
+/**
+ * @tparam Ts The element types of the arrays a loop walks.
+ *
+ * @returns The smallest number of elements that is a whole
+ * number of cache lines in an array of each of Ts, so chunks
+ * of that many elements never share a cache line when the
+ * arrays start on one.
+*/
+template<typename... Ts>
+constexpr std::size_t CacheLineElements()
+{
+	// Each term is a power of two, so the largest is their lcm
+	std::size_t elements = 1;
+	((elements = std::max(elements, CACHE_LINE_SIZE / std::gcd(sizeof(Ts), CACHE_LINE_SIZE))), ...);
+	return elements;
+}
+
+/**
+ * Splits the indices [0, count) into chunks and calls
+ * `func(begin, end)` once per chunk, spread across a pool.
+ * Chunk boundaries depend only on `count` and `chunkSize`,
+ * never on the number of threads, so work is always divided
+ * the same way. Returns once every chunk is done.
+ *
+ * @param pool The pool to run chunks on.
+ * @param count The number of indices.
+ * @param chunkSize The number of indices per chunk (the last may be short).
+ * @param func A callable taking the first and one-past-last index of a chunk.
+*/
+template<typename F>
+void ParallelFor(ThreadPool& pool, std::size_t count, std::size_t chunkSize, F&& func)
+{
+	chunkSize = std::max<std::size_t>(chunkSize, 1);
+	if (count <= chunkSize || pool.WorkerCount() == 0)
+	{
+		for (std::size_t begin = 0; begin < count; begin += chunkSize)
+		{
+			func(begin, std::min(begin + chunkSize, count));
+		}
+		return;
+	}
+
+	TaskGroup group(pool);
+	for (std::size_t begin = 0; begin < count; begin += chunkSize)
+	{
+		std::size_t end = std::min(begin + chunkSize, count);
+		group.Run([&func, begin, end]() { func(begin, end); });
+	}
+	group.Wait();
+}
+
+/**
+ * Like ParallelFor(), but each chunk appends its results to a
+ * buffer of its own, and the buffers are then appended to
+ * `results` in chunk order. The results come out in the same
+ * order as running `func` over every chunk in turn, however
+ * many threads there are.
+ *
+ * @param pool The pool to run chunks on.
+ * @param count The number of indices.
+ * @param chunkSize The number of indices per chunk (the last may be short).
+ * @param buffers One buffer per chunk, kept between calls so
+ * their memory is reused. Resized as needed and left cleared.
+ * @param results The vector to append to.
+ * @param func A callable taking the first and one-past-last
+ * index of a chunk and the std::vector<T> to append its results to.
+*/
+template<typename T, typename F>
+void ParallelCollect(ThreadPool& pool, std::size_t count, std::size_t chunkSize,
+	std::vector<std::vector<T>>& buffers, std::vector<T>& results, F&& func)
+{
+	chunkSize = std::max<std::size_t>(chunkSize, 1);
+	if (count <= chunkSize || pool.WorkerCount() == 0)
+	{
+		func(std::size_t(0), count, results);
+		return;
+	}
+
+	std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+	if (buffers.size() < chunks)
+	{
+		buffers.resize(chunks);
+	}
+	ParallelFor(pool, count, chunkSize, [&](std::size_t begin, std::size_t end)
+	{
+		std::vector<T>& buffer = buffers[begin / chunkSize];
+		buffer.clear();
+		func(begin, end, buffer);
+	});
+
+	std::size_t total = results.size();
+	for (std::size_t chunk = 0; chunk < chunks; chunk++)
+	{
+		total += buffers[chunk].size();
+	}
+	results.reserve(total);
+	for (std::size_t chunk = 0; chunk < chunks; chunk++)
+	{
+		results.insert(results.end(), buffers[chunk].begin(), buffers[chunk].end());
+		buffers[chunk].clear();
+	}
+}
+
+/**
+ * @returns `grain` rounded up to a whole number of `unit`s
+ * (and to at least one unit).
+*/
+inline std::size_t AlignGrain(std::size_t grain, std::size_t unit)
+{
+	return std::max<std::size_t>((grain + unit - 1) / unit, 1) * unit;
+}
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef _ROC_VIEW_H_
+#define _ROC_VIEW_H_
+
+/**
+ * @file View.hpp
+ *
+ * This file defines the ComponentView class, returned by
+ * Coordinator::View(), which iterates every Entity owning
+ * a given set of Components straight out of the packed
+ * ComponentArray objects.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+#include "Entity.hpp"
+#include "Component.hpp"
+#include "IComponentArray.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @class ComponentView
+ *
+ * A lightweight view over the Entities that have every
+ * Component in Ts. Iteration walks the smallest of the
+ * ComponentArray objects front to back, filters Entities
+ * with a single Signature test, and fetches the remaining
+ * Components by sparse-set index - no hashing, no exceptions.
+ *
+ * @note Adding or removing any of the viewed Components (or
+ * destroying Entities) while iterating is not supported.
+ *
+ * @tparam Ts The subclasses of Component to view.
+*/
+template<typename... Ts>
+class ComponentView
+{
+public:
+	/**
+	 * Creates a view. If any of the arrays is nullptr (its
+	 * Component isn't registered) the view is empty.
+	 *
+	 * @param arrays The ComponentArray of each viewed Component.
+	 * @param signatures The Signature of every Entity, indexed by EntityIndex().
+	 * @param mask The Signature bits of the viewed Components.
+	*/
+	ComponentView(std::tuple<ComponentArray<Ts>*...> arrays, const Signature* signatures, Signature mask)
+		: mArrays(arrays), mSignatures(signatures), mMask(mask)
+	{
+		mValid = ((std::get<ComponentArray<Ts>*>(mArrays) != nullptr) && ...);
+	}
+
+	/**
+	 * Calls `func(entity, components...)` once for every Entity
+	 * owning all of the viewed Components.
+	 *
+	 * @param func A callable taking an Entity followed by a
+	 * reference to each viewed Component, in the order of Ts.
+	*/
+	template<typename F>
+	void ForEach(F&& func)
+	{
+		if (!mValid)
+		{
+			return;
+		}
+		DriveBySmallest([&](auto driver)
+		{
+			constexpr std::size_t D = decltype(driver)::value;
+			Drive<D>(func, 0, std::get<D>(mArrays)->Size(), std::index_sequence_for<Ts...>{});
+		}, std::index_sequence_for<Ts...>{});
+	}
+
+	/**
+	 * Like ForEach(), but splits the packed range being walked
+	 * into chunks run on a ThreadPool. Chunks are `grain`
+	 * Entities rounded up to whole cache lines of every viewed
+	 * array, and don't depend on the number of threads.
+	 *
+	 * @note `func` is called from several threads at once, for
+	 * different Entities.
+	 *
+	 * @param pool The pool to run chunks on.
+	 * @param func The same kind of callable as ForEach() takes.
+	 * @param grain The number of Entities per chunk (before rounding).
+	*/
+	template<typename F>
+	void ParallelForEach(ThreadPool& pool, F&& func, std::size_t grain = DEFAULT_GRAIN_SIZE)
+	{
+		if (!mValid)
+		{
+			return;
+		}
+		DriveBySmallest([&](auto driver)
+		{
+			constexpr std::size_t D = decltype(driver)::value;
+			std::size_t chunk = AlignGrain(grain, CacheLineElements<Entity, Ts...>());
+			ParallelFor(pool, std::get<D>(mArrays)->Size(), chunk, [&](std::size_t begin, std::size_t end)
+			{
+				Drive<D>(func, begin, end, std::index_sequence_for<Ts...>{});
+			});
+		}, std::index_sequence_for<Ts...>{});
+	}
+
+	/**
+	 * @returns An upper bound on the number of Entities in the
+	 * view: the size of the smallest viewed ComponentArray.
+	*/
+	std::size_t SizeHint() const
+	{
+		if (!mValid)
+		{
+			return 0;
+		}
+		std::size_t size = SIZE_MAX;
+		((size = std::min(size, std::get<ComponentArray<Ts>*>(mArrays)->Size())), ...);
+		return size;
+	}
+
+private:
+	/** Calls `body(std::integral_constant<D>)` for the first smallest array D. */
+	template<typename B, std::size_t... Is>
+	void DriveBySmallest(B&& body, std::index_sequence<Is...>)
+	{
+		std::size_t smallest = SizeHint();
+		bool driven = false;
+
+		((!driven && std::get<Is>(mArrays)->Size() == smallest
+			? (body(std::integral_constant<std::size_t, Is>{}), driven = true)
+			: false), ...);
+	}
+
+	/** Walks positions [begin, end) of array D. */
+	template<std::size_t D, typename F, std::size_t... Is>
+	void Drive(F& func, std::size_t begin, std::size_t end, std::index_sequence<Is...>)
+	{
+		auto* driver = std::get<D>(mArrays);
+		const SparseSet& entities = driver->Entities();
+
+		for (std::size_t i = begin; i < end; i++)
+		{
+			Entity entity = entities[i];
+			if ((mSignatures[EntityIndex(entity)] & mMask) != mMask)
+			{
+				continue;
+			}
+			func(entity, Fetch<D, Is>(i, entity)...);
+		}
+	}
+
+	template<std::size_t D, std::size_t I>
+	auto& Fetch(std::size_t driverIndex, Entity entity)
+	{
+		auto* array = std::get<I>(mArrays);
+		if constexpr (I == D)
+		{
+			return array->At(driverIndex);
+		}
+		else
+		{
+			return array->At(array->Entities().IndexOf(entity));
+		}
+	}
+
+	std::tuple<ComponentArray<Ts>*...> mArrays;
+	const Signature* mSignatures;
+	Signature mMask;
+	bool mValid;
+};
+
+#endif
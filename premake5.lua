@@ -1,6 +1,15 @@
 workspace "RocketGameEngine"
     configurations { "Debug", "Release" }
 
+newoption {
+    trigger = "archetype-storage",
+    description = "Store components in archetype tables instead of per-type component arrays"
+}
+
+filter "options:archetype-storage"
+    defines { "ROCKET_ARCHETYPE_STORAGE" }
+filter {}
+
 project "UnitTests"
     kind "ConsoleApp"
     language "C++"
@@ -26,7 +35,7 @@ defines {
 }
 
 links {
-    "boost_unit_test_framework"
+    "boost_unit_test_framework", "pthread"
 }
 
 buildoptions {
@@ -62,6 +71,10 @@ buildoptions {
     "-Wall", "`pkg-config spdlog --cflags`"
 }
 
+links {
+    "pthread"
+}
+
 linkoptions {
     "`pkg-config spdlog --libs`"
 }
@@ -72,4 +85,42 @@ filter "configurations:Debug"
 
 filter "configurations:Release"
     optimize "On"
-    defines { "SPDLOG_ACTIVE_LEVEL=SPDLOG_LEVEL_INFO"}
\ No newline at end of file
+    defines { "SPDLOG_ACTIVE_LEVEL=SPDLOG_LEVEL_INFO"}
+-----------------
+
+project "Benchmarks"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+    optimize "On"
+    objdir "obj/Benchmarks/%{cfg.buildcfg}"
+    targetdir "build/%{cfg.buildcfg}"
+
+files {
+    "bench/**.cpp",
+    "src/**.cpp"
+}
+
+includedirs {
+    "include"
+}
+
+removefiles {
+    "src/main.cpp"
+}
+
+defines {
+    "SPDLOG_ACTIVE_LEVEL=SPDLOG_LEVEL_OFF"
+}
+
+links {
+    "pthread"
+}
+
+buildoptions {
+    "`pkg-config spdlog --cflags`"
+}
+
+linkoptions {
+    "`pkg-config spdlog --libs`"
+}
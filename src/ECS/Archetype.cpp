@@ -0,0 +1,125 @@
+#include "ECS/Archetype.hpp"
+
+/**
+ * @file Archetype.cpp
+ * 
+ * @brief Implementation for @link Archetype.hpp @endlink
+*/
+
+namespace
+{
+    std::size_t AlignUp(std::size_t value, std::size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+Archetype::Archetype(Signature signature, const std::vector<ComponentInfo>& infos)
+    : mSignature(signature)
+{
+    mColumnOf.fill(NO_COLUMN);
+
+    std::size_t rowBytes = sizeof(Entity);
+    for (ComponentType type = 0; type < infos.size(); type++)
+    {
+        if (!signature.test(type))
+        {
+            continue;
+        }
+
+        mColumnOf[type] = static_cast<std::int16_t>(mColumns.size());
+        mColumns.push_back({type, 0, &infos[type]});
+        rowBytes += infos[type].size;
+    }
+
+    // Leave room for the padding in front of each column
+    std::size_t padding = COLUMN_ALIGN * (mColumns.size() + 1);
+    mChunkCapacity = CHUNK_BYTES > padding + rowBytes ? (CHUNK_BYTES - padding) / rowBytes : 1;
+
+    std::size_t offset = AlignUp(mChunkCapacity * sizeof(Entity), COLUMN_ALIGN);
+    for (ColumnInfo& column : mColumns)
+    {
+        column.offset = offset;
+        offset = AlignUp(offset + mChunkCapacity * column.info->size, COLUMN_ALIGN);
+    }
+    mChunkBlocks = offset / COLUMN_ALIGN;
+}
+
+Archetype::~Archetype()
+{
+    Clear();
+}
+
+std::size_t Archetype::AllocateRow(Entity entity)
+{
+    std::size_t row = mSize;
+    if (row / mChunkCapacity >= mChunks.size())
+    {
+        mChunks.emplace_back(new Block[mChunkBlocks]);
+    }
+
+    Entities(row / mChunkCapacity)[row % mChunkCapacity] = entity;
+    mSize++;
+    return row;
+}
+
+void Archetype::DestroyRow(std::size_t row)
+{
+    for (const ColumnInfo& column : mColumns)
+    {
+        column.info->destroy(Get(row, column.type));
+    }
+}
+
+Entity Archetype::RemoveRow(std::size_t row)
+{
+    DestroyRow(row);
+
+    std::size_t last = mSize - 1;
+    Entity moved = MAX_ENTITIES;
+    if (row != last)
+    {
+        for (const ColumnInfo& column : mColumns)
+        {
+            column.info->moveConstruct(Get(row, column.type), Get(last, column.type));
+            column.info->destroy(Get(last, column.type));
+        }
+
+        moved = EntityAt(last);
+        Entities(row / mChunkCapacity)[row % mChunkCapacity] = moved;
+    }
+
+    mSize--;
+    return moved;
+}
+
+std::size_t Archetype::MoveRow(std::size_t row, Archetype& destination, Entity& moved)
+{
+    std::size_t newRow = destination.AllocateRow(EntityAt(row));
+    for (const ColumnInfo& column : mColumns)
+    {
+        if (destination.Has(column.type))
+        {
+            column.info->moveConstruct(destination.Get(newRow, column.type), Get(row, column.type));
+        }
+    }
+
+    // Moved-from Components are still objects, so they get destroyed too
+    moved = RemoveRow(row);
+    return newRow;
+}
+
+void Archetype::Clear()
+{
+    // Destroy column by column, a chunk at a time, so trivially
+    // destructible columns cost one call per chunk
+    for (std::size_t chunk = 0; chunk < ChunkCount(); chunk++)
+    {
+        std::size_t rows = RowsInChunk(chunk);
+        for (const ColumnInfo& column : mColumns)
+        {
+            column.info->destroyRange(Column(chunk, column.type), rows);
+        }
+    }
+    mSize = 0;
+}
@@ -0,0 +1,53 @@
+#include "ECS/CommandBuffer.hpp"
+
+#include <algorithm>
+
+/**
+ * @file CommandBuffer.cpp
+ * 
+ * @brief Implementation for @link CommandBuffer.hpp @endlink
+*/
+
+void Coordinator::ApplyCommands(CommandBuffer& buffer)
+{
+    std::lock_guard<std::mutex> lock(buffer.mMutex);
+
+    std::vector<Entity> created = CreateEntities(buffer.mCreateCount);
+
+    // Additions and removals in the order they were recorded, a Run at a time
+    std::vector<Entity> touched;
+    std::vector<std::size_t> addsDone(buffer.mQueues.size(), 0);
+    std::vector<std::size_t> removesDone(buffer.mQueues.size(), 0);
+    for (const CommandBuffer::Run& run : buffer.mRuns)
+    {
+        CommandBuffer::IComponentQueue& queue = *buffer.mQueues[run.type];
+        std::size_t& done = run.add ? addsDone[run.type] : removesDone[run.type];
+        if (run.add)
+        {
+            queue.ApplyAdds(*this, done, done + run.count, created, touched);
+        }
+        else
+        {
+            queue.ApplyRemoves(*this, done, done + run.count, created, touched);
+        }
+        done += run.count;
+    }
+
+    // One membership update per Entity, however many Components it changed
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (Entity entity : touched)
+    {
+        mSystemManager->EntitySignatureChanged(entity, mEntityManager->GetSignature(entity));
+    }
+
+    std::vector<Entity> destroyed;
+    destroyed.reserve(buffer.mDestroys.size());
+    for (Entity entity : buffer.mDestroys)
+    {
+        destroyed.push_back(CommandBuffer::Resolve(entity, created));
+    }
+    DestroyEntities(destroyed);
+
+    buffer.ClearUnlocked();
+}
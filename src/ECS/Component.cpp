@@ -0,0 +1,31 @@
+#include "ECS/Component.hpp"
+
+/**
+ * @file Component.cpp
+ * 
+ * @brief Implementation for @link Component.hpp @endlink
+*/
+
+const PropertyDescriptor* FindProperty(const PropertyTable& table, const std::string& property)
+{
+    for (const PropertyDescriptor& descriptor : table)
+    {
+        if (property == descriptor.name)
+        {
+            return &descriptor;
+        }
+    }
+    return nullptr;
+}
+
+bool ApplyProperty(const PropertyTable& table, Component& component, const std::string& property, const Property& value)
+{
+    const PropertyDescriptor* descriptor = FindProperty(table, property);
+    if (descriptor == nullptr)
+    {
+        return false;
+    }
+
+    descriptor->setter(component, value);
+    return true;
+}
@@ -1,6 +1,6 @@
 #include "ECS/Components/RectangleCollider.hpp"
 
-bool CheckCollision(Collision& c, int position)
+bool CheckCollision(const Collision& c, int position)
 {
     return (c.collision_pos & position) == position;
 }
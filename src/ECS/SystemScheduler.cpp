@@ -0,0 +1,192 @@
+#include "ECS/SystemScheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <spdlog/spdlog.h>
+
+/**
+ * @file SystemScheduler.cpp
+ *
+ * @brief Implementation for @link SystemScheduler.hpp @endlink
+*/
+
+bool SystemScheduler::AddOrdering(std::size_t before, std::size_t after)
+{
+    if (before == after || Reaches(after, before))
+    {
+        SPDLOG_ERROR("System ordering would form a cycle.");
+        return false;
+    }
+
+    std::size_t needed = std::max(before, after) + 1;
+    if (mOrderings.size() < needed)
+    {
+        mOrderings.resize(needed);
+    }
+    mOrderings[before].push_back(after);
+    mDirty = true;
+    return true;
+}
+
+void SystemScheduler::Run(const std::vector<std::shared_ptr<System>>& systems, ThreadPool* pool)
+{
+    if (mDirty || mOrder.size() != systems.size())
+    {
+        Build(systems);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    mTimings.systems.assign(systems.size(), std::chrono::nanoseconds(0));
+
+    if (pool == nullptr || pool->WorkerCount() == 0)
+    {
+        for (std::size_t system : mOrder)
+        {
+            RunSystem(*systems[system], system);
+        }
+    }
+    else
+    {
+        std::unique_ptr<std::atomic<std::size_t>[]> waiting(new std::atomic<std::size_t>[systems.size()]);
+        for (std::size_t i = 0; i < systems.size(); i++)
+        {
+            waiting[i] = mDependencyCounts[i];
+        }
+
+        // Each System, once done, launches the Systems it was the last dependency of
+        TaskGroup group(*pool);
+        std::function<void(std::size_t)> launch = [&](std::size_t system)
+        {
+            group.Run([&, system]()
+            {
+                RunSystem(*systems[system], system);
+                for (std::size_t next : mSuccessors[system])
+                {
+                    if (--waiting[next] == 0)
+                    {
+                        launch(next);
+                    }
+                }
+            });
+        };
+
+        for (std::size_t system : mOrder)
+        {
+            if (mDependencyCounts[system] == 0)
+            {
+                launch(system);
+            }
+        }
+        group.Wait();
+    }
+
+    mTimings.frame = std::chrono::steady_clock::now() - start;
+}
+
+bool SystemScheduler::DependsOn(std::size_t after, std::size_t before) const
+{
+    if (before >= mSuccessors.size())
+    {
+        return false;
+    }
+    const std::vector<std::size_t>& next = mSuccessors[before];
+    return std::find(next.begin(), next.end(), after) != next.end();
+}
+
+void SystemScheduler::Build(const std::vector<std::shared_ptr<System>>& systems)
+{
+    std::size_t count = systems.size();
+    if (mOrderings.size() < count)
+    {
+        mOrderings.resize(count);
+    }
+
+    // The Systems each System must wait on, in registration order
+    std::vector<std::vector<std::size_t>> waitsOn(count);
+    for (std::size_t system = 0; system < count; system++)
+    {
+        for (std::size_t after : mOrderings[system])
+        {
+            waitsOn[after].push_back(system);
+        }
+    }
+
+    // Take the Systems in registration order, placing whatever each waits on just before it
+    mOrder.clear();
+    std::vector<bool> placed(count, false);
+    std::function<void(std::size_t)> place = [&](std::size_t system)
+    {
+        if (placed[system])
+        {
+            return;
+        }
+        placed[system] = true;
+        for (std::size_t before : waitsOn[system])
+        {
+            place(before);
+        }
+        mOrder.push_back(system);
+    };
+    for (std::size_t system = 0; system < count; system++)
+    {
+        place(system);
+    }
+
+    // Edges follow that order, so the graph can't have cycles
+    std::vector<SystemAccess> accesses;
+    for (auto const& system : systems)
+    {
+        accesses.push_back(system->GetAccess());
+    }
+
+    mSuccessors.assign(count, {});
+    mDependencyCounts.assign(count, 0);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        std::size_t first = mOrder[i];
+        for (std::size_t j = i + 1; j < count; j++)
+        {
+            std::size_t second = mOrder[j];
+            const std::vector<std::size_t>& ordered = mOrderings[first];
+            if (accesses[first].ConflictsWith(accesses[second])
+                || std::find(ordered.begin(), ordered.end(), second) != ordered.end())
+            {
+                mSuccessors[first].push_back(second);
+                mDependencyCounts[second]++;
+            }
+        }
+    }
+
+    mDirty = false;
+}
+
+bool SystemScheduler::Reaches(std::size_t from, std::size_t to) const
+{
+    std::vector<std::size_t> stack{from};
+    std::vector<bool> seen(mOrderings.size(), false);
+    while (!stack.empty())
+    {
+        std::size_t system = stack.back();
+        stack.pop_back();
+        if (system == to)
+        {
+            return true;
+        }
+        if (system >= mOrderings.size() || seen[system])
+        {
+            continue;
+        }
+
+        seen[system] = true;
+        stack.insert(stack.end(), mOrderings[system].begin(), mOrderings[system].end());
+    }
+    return false;
+}
+
+void SystemScheduler::RunSystem(System& system, std::size_t index)
+{
+    auto start = std::chrono::steady_clock::now();
+    system.Update();
+    mTimings.systems[index] = std::chrono::steady_clock::now() - start;
+}
@@ -0,0 +1,529 @@
+#include "ECS/Systems/AABBTree.hpp"
+
+#include <algorithm>
+
+/**
+ * @file AABBTree.cpp
+ *
+ * @brief Implementation for @link AABBTree.hpp @endlink
+*/
+
+namespace
+{
+    AABB Union(const AABB& a, const AABB& b)
+    {
+        AABB bounds;
+        bounds.minX = std::min(a.minX, b.minX);
+        bounds.minY = std::min(a.minY, b.minY);
+        bounds.maxX = std::max(a.maxX, b.maxX);
+        bounds.maxY = std::max(a.maxY, b.maxY);
+        return bounds;
+    }
+
+    /** Every layer and mask bit of either filter, so a subtree's filter admits whatever its leaves' do */
+    CollisionFilter Union(const CollisionFilter& a, const CollisionFilter& b)
+    {
+        CollisionFilter filter;
+        filter.layers = a.layers | b.layers;
+        filter.mask = a.mask | b.mask;
+        return filter;
+    }
+
+    /** The insertion cost of a box (its perimeter, the 2D stand-in for surface area) */
+    double Cost(const AABB& bounds)
+    {
+        return 2.0 * ((bounds.maxX - bounds.minX) + (bounds.maxY - bounds.minY));
+    }
+}
+
+AABBTreeBroadphase::AABBTreeBroadphase(double margin)
+    : mLeafOf(MAX_ENTITIES, NULL_NODE), mMargin(0)
+{
+    SetMargin(margin);
+}
+
+void AABBTreeBroadphase::SetMargin(double margin)
+{
+    if (margin >= 0)
+    {
+        mMargin = margin;
+    }
+}
+
+void AABBTreeBroadphase::Update(const std::vector<BroadphaseProxy>& proxies)
+{
+    mStamp++;
+    mReinserted = 0;
+
+    // Note which leaves are still around
+    for (const BroadphaseProxy& proxy : proxies)
+    {
+        if (EntityIndex(proxy.entity) >= mLeafOf.size())
+        {
+            mLeafOf.resize(EntityIndex(proxy.entity) + 1, NULL_NODE);
+        }
+
+        std::int32_t leaf = mLeafOf[EntityIndex(proxy.entity)];
+        if (leaf != NULL_NODE && mNodes[leaf].entity == proxy.entity)
+        {
+            mNodes[leaf].stamp = mStamp;
+        }
+    }
+
+    // Drop the ones that aren't
+    for (std::int32_t leaf : mLeaves)
+    {
+        if (mNodes[leaf].stamp == mStamp)
+        {
+            continue;
+        }
+
+        Entity entity = mNodes[leaf].entity;
+        if (mLeafOf[EntityIndex(entity)] == leaf)
+        {
+            mLeafOf[EntityIndex(entity)] = NULL_NODE;
+        }
+        RemoveLeaf(leaf);
+        mNodes[leaf].moved = true;
+        mMoved.push_back(leaf);
+        FreeNode(leaf);
+    }
+
+    // Insert new leaves, and reinsert those that left their fattened box
+    mLeaves.clear();
+    for (std::uint32_t i = 0; i < proxies.size(); i++)
+    {
+        const BroadphaseProxy& proxy = proxies[i];
+        std::int32_t leaf = mLeafOf[EntityIndex(proxy.entity)];
+        if (leaf == NULL_NODE)
+        {
+            leaf = AllocateNode();
+            mNodes[leaf].entity = proxy.entity;
+            mNodes[leaf].stamp = mStamp;
+            mNodes[leaf].bounds = Fatten(proxy.bounds);
+            mNodes[leaf].filter = proxy.filter;
+            mLeafOf[EntityIndex(proxy.entity)] = leaf;
+            InsertLeaf(leaf);
+        }
+        else if (!mNodes[leaf].bounds.Contains(proxy.bounds) || mNodes[leaf].filter != proxy.filter)
+        {
+            RemoveLeaf(leaf);
+            mNodes[leaf].bounds = Fatten(proxy.bounds);
+            mNodes[leaf].filter = proxy.filter;
+            InsertLeaf(leaf);
+        }
+        else
+        {
+            mNodes[leaf].proxy = i;
+            mLeaves.push_back(leaf);
+            continue;
+        }
+
+        mNodes[leaf].proxy = i;
+        mNodes[leaf].moved = true;
+        mMoved.push_back(leaf);
+        mLeaves.push_back(leaf);
+        mReinserted++;
+    }
+
+    if (mMoved.empty())
+    {
+        return;
+    }
+
+    if (mReinserted * 4 > mLeaves.size())
+    {
+        // With this much changed, one pass over the whole tree beats a query per leaf
+        FindAllPairs();
+    }
+    else
+    {
+        UpdateMovedPairs();
+    }
+
+    for (std::int32_t node : mMoved)
+    {
+        mNodes[node].moved = false;
+    }
+    mMoved.clear();
+}
+
+void AABBTreeBroadphase::UpdateMovedPairs()
+{
+    // Forget the pairs of every leaf that changed, then look them up again
+    mPairs.erase(std::remove_if(mPairs.begin(), mPairs.end(), [this](const LeafPair& pair)
+    {
+        return mNodes[pair.first].moved || mNodes[pair.second].moved;
+    }), mPairs.end());
+
+    for (std::int32_t leaf : mLeaves)
+    {
+        if (!mNodes[leaf].moved)
+        {
+            continue;
+        }
+
+        QueryNodes(mNodes[leaf].bounds, &mNodes[leaf].filter, [&](std::int32_t other)
+        {
+            // Two moved leaves find each other; only the lower one keeps the pair
+            if (other == leaf || (mNodes[other].moved && other < leaf))
+            {
+                return;
+            }
+            mPairs.push_back({std::min(leaf, other), std::max(leaf, other)});
+        });
+    }
+}
+
+void AABBTreeBroadphase::FindAllPairs()
+{
+    mPairs.clear();
+    if (mRoot == NULL_NODE)
+    {
+        return;
+    }
+
+    // Every pair of leaves meets at the node where they split, so test each
+    // node's two subtrees against each other
+    std::vector<LeafPair> crossings;
+    std::vector<std::int32_t> nodes{mRoot};
+    while (!nodes.empty())
+    {
+        const Node& node = mNodes[nodes.back()];
+        nodes.pop_back();
+        if (!node.IsLeaf())
+        {
+            nodes.push_back(node.left);
+            nodes.push_back(node.right);
+            crossings.push_back({node.left, node.right});
+        }
+    }
+
+    while (!crossings.empty())
+    {
+        LeafPair crossing = crossings.back();
+        crossings.pop_back();
+        const Node& a = mNodes[crossing.first];
+        const Node& b = mNodes[crossing.second];
+        if (!a.filter.CanInteract(b.filter) || !a.bounds.Overlaps(b.bounds))
+        {
+            continue;
+        }
+
+        if (a.IsLeaf() && b.IsLeaf())
+        {
+            mPairs.push_back({std::min(crossing.first, crossing.second), std::max(crossing.first, crossing.second)});
+        }
+        else if (b.IsLeaf() || (!a.IsLeaf() && Cost(a.bounds) >= Cost(b.bounds)))
+        {
+            crossings.push_back({a.left, crossing.second});
+            crossings.push_back({a.right, crossing.second});
+        }
+        else
+        {
+            crossings.push_back({crossing.first, b.left});
+            crossings.push_back({crossing.first, b.right});
+        }
+    }
+}
+
+void AABBTreeBroadphase::FindPairs(std::vector<BroadphasePair>& pairs)
+{
+    for (const LeafPair& pair : mPairs)
+    {
+        std::uint32_t first = mNodes[pair.first].proxy;
+        std::uint32_t second = mNodes[pair.second].proxy;
+        pairs.push_back({std::min(first, second), std::max(first, second)});
+    }
+}
+
+void AABBTreeBroadphase::QueryRay(const Ray& ray, const CollisionFilter& filter, std::vector<std::uint32_t>& proxies) const
+{
+    if (mRoot == NULL_NODE)
+    {
+        return;
+    }
+
+    std::vector<std::int32_t> stack{mRoot};
+    while (!stack.empty())
+    {
+        const Node& node = mNodes[stack.back()];
+        stack.pop_back();
+        double distance;
+        int axis;
+        if (!node.filter.CanInteract(filter) || !RayHitsBox(ray, node.bounds, distance, axis))
+        {
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            proxies.push_back(node.proxy);
+        }
+        else
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+int AABBTreeBroadphase::GetHeight() const
+{
+    return mRoot == NULL_NODE ? -1 : mNodes[mRoot].height;
+}
+
+bool AABBTreeBroadphase::Validate() const
+{
+    std::size_t leaves = 0;
+    if (mRoot != NULL_NODE && ValidateNode(mRoot, NULL_NODE, leaves) < 0)
+    {
+        return false;
+    }
+    return leaves == mLeaves.size();
+}
+
+int AABBTreeBroadphase::ValidateNode(std::int32_t index, std::int32_t parent, std::size_t& leaves) const
+{
+    const Node& node = mNodes[index];
+    if (node.parent != parent)
+    {
+        return -1;
+    }
+
+    if (node.IsLeaf())
+    {
+        leaves++;
+        return node.height == 0 ? 0 : -1;
+    }
+
+    int left = ValidateNode(node.left, index, leaves);
+    int right = ValidateNode(node.right, index, leaves);
+    if (left < 0 || right < 0 || node.height != 1 + std::max(left, right))
+    {
+        return -1;
+    }
+
+    const AABB expected = Union(mNodes[node.left].bounds, mNodes[node.right].bounds);
+    if (!node.bounds.Contains(expected) || !expected.Contains(node.bounds))
+    {
+        return -1;
+    }
+    if (node.filter != Union(mNodes[node.left].filter, mNodes[node.right].filter))
+    {
+        return -1;
+    }
+    return node.height;
+}
+
+std::int32_t AABBTreeBroadphase::AllocateNode()
+{
+    std::int32_t node;
+    if (mFreeList != NULL_NODE)
+    {
+        // A reused leaf keeps its moved flag, so pairs cached for it are still dropped
+        node = mFreeList;
+        mFreeList = mNodes[node].parent;
+        bool moved = mNodes[node].moved;
+        mNodes[node] = Node();
+        mNodes[node].moved = moved;
+    }
+    else
+    {
+        node = static_cast<std::int32_t>(mNodes.size());
+        mNodes.emplace_back();
+    }
+    return node;
+}
+
+void AABBTreeBroadphase::FreeNode(std::int32_t node)
+{
+    bool moved = mNodes[node].moved;
+    mNodes[node] = Node();
+    mNodes[node].moved = moved;
+    mNodes[node].parent = mFreeList;
+    mFreeList = node;
+}
+
+void AABBTreeBroadphase::InsertLeaf(std::int32_t leaf)
+{
+    if (mRoot == NULL_NODE)
+    {
+        mRoot = leaf;
+        mNodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // Walk down to the sibling that grows the tree least
+    const AABB bounds = mNodes[leaf].bounds;
+    std::int32_t index = mRoot;
+    while (!mNodes[index].IsLeaf())
+    {
+        const Node& node = mNodes[index];
+        double combined = Cost(Union(node.bounds, bounds));
+
+        // Pairing with this node makes a new parent; going lower grows this node anyway
+        double cost = 2.0 * combined;
+        double inherited = 2.0 * (combined - Cost(node.bounds));
+
+        auto descendCost = [&](std::int32_t child)
+        {
+            const Node& c = mNodes[child];
+            double grown = Cost(Union(c.bounds, bounds));
+            return (c.IsLeaf() ? grown : grown - Cost(c.bounds)) + inherited;
+        };
+        double leftCost = descendCost(node.left);
+        double rightCost = descendCost(node.right);
+
+        if (cost < leftCost && cost < rightCost)
+        {
+            break;
+        }
+        index = leftCost < rightCost ? node.left : node.right;
+    }
+
+    std::int32_t sibling = index;
+    std::int32_t oldParent = mNodes[sibling].parent;
+    std::int32_t newParent = AllocateNode();
+    mNodes[newParent].parent = oldParent;
+    mNodes[newParent].bounds = Union(bounds, mNodes[sibling].bounds);
+    mNodes[newParent].filter = Union(mNodes[leaf].filter, mNodes[sibling].filter);
+    mNodes[newParent].height = mNodes[sibling].height + 1;
+    mNodes[newParent].left = sibling;
+    mNodes[newParent].right = leaf;
+    mNodes[sibling].parent = newParent;
+    mNodes[leaf].parent = newParent;
+
+    if (oldParent == NULL_NODE)
+    {
+        mRoot = newParent;
+    }
+    else if (mNodes[oldParent].left == sibling)
+    {
+        mNodes[oldParent].left = newParent;
+    }
+    else
+    {
+        mNodes[oldParent].right = newParent;
+    }
+
+    FixUpwards(oldParent);
+}
+
+void AABBTreeBroadphase::RemoveLeaf(std::int32_t leaf)
+{
+    if (leaf == mRoot)
+    {
+        mRoot = NULL_NODE;
+        return;
+    }
+
+    std::int32_t parent = mNodes[leaf].parent;
+    std::int32_t grandParent = mNodes[parent].parent;
+    std::int32_t sibling = mNodes[parent].left == leaf ? mNodes[parent].right : mNodes[parent].left;
+
+    // The sibling takes the parent's place
+    mNodes[sibling].parent = grandParent;
+    if (grandParent == NULL_NODE)
+    {
+        mRoot = sibling;
+    }
+    else if (mNodes[grandParent].left == parent)
+    {
+        mNodes[grandParent].left = sibling;
+    }
+    else
+    {
+        mNodes[grandParent].right = sibling;
+    }
+
+    FreeNode(parent);
+    mNodes[leaf].parent = NULL_NODE;
+    FixUpwards(grandParent);
+}
+
+void AABBTreeBroadphase::FixUpwards(std::int32_t index)
+{
+    while (index != NULL_NODE)
+    {
+        index = Balance(index);
+
+        Node& node = mNodes[index];
+        node.height = 1 + std::max(mNodes[node.left].height, mNodes[node.right].height);
+        node.bounds = Union(mNodes[node.left].bounds, mNodes[node.right].bounds);
+        node.filter = Union(mNodes[node.left].filter, mNodes[node.right].filter);
+        index = node.parent;
+    }
+}
+
+std::int32_t AABBTreeBroadphase::Balance(std::int32_t a)
+{
+    Node& A = mNodes[a];
+    if (A.IsLeaf() || A.height < 2)
+    {
+        return a;
+    }
+
+    std::int32_t b = A.left;
+    std::int32_t c = A.right;
+    int balance = mNodes[c].height - mNodes[b].height;
+    if (balance >= -1 && balance <= 1)
+    {
+        return a;
+    }
+
+    // Rotate the taller child (up) above A; A keeps the other child
+    std::int32_t up = balance > 1 ? c : b;
+    std::int32_t kept = balance > 1 ? b : c;
+    Node& U = mNodes[up];
+    std::int32_t f = U.left;
+    std::int32_t g = U.right;
+
+    U.left = a;
+    U.parent = A.parent;
+    A.parent = up;
+    if (U.parent == NULL_NODE)
+    {
+        mRoot = up;
+    }
+    else if (mNodes[U.parent].left == a)
+    {
+        mNodes[U.parent].left = up;
+    }
+    else
+    {
+        mNodes[U.parent].right = up;
+    }
+
+    // The taller grandchild stays with U, the shorter one moves under A
+    std::int32_t stays = mNodes[f].height > mNodes[g].height ? f : g;
+    std::int32_t moves = stays == f ? g : f;
+    U.right = stays;
+    if (balance > 1)
+    {
+        A.right = moves;
+    }
+    else
+    {
+        A.left = moves;
+    }
+    mNodes[moves].parent = a;
+
+    A.bounds = Union(mNodes[kept].bounds, mNodes[moves].bounds);
+    A.filter = Union(mNodes[kept].filter, mNodes[moves].filter);
+    A.height = 1 + std::max(mNodes[kept].height, mNodes[moves].height);
+    U.bounds = Union(A.bounds, mNodes[stays].bounds);
+    U.filter = Union(A.filter, mNodes[stays].filter);
+    U.height = 1 + std::max(A.height, mNodes[stays].height);
+    return up;
+}
+
+AABB AABBTreeBroadphase::Fatten(const AABB& bounds) const
+{
+    AABB fat = bounds;
+    fat.minX -= mMargin;
+    fat.minY -= mMargin;
+    fat.maxX += mMargin;
+    fat.maxY += mMargin;
+    return fat;
+}
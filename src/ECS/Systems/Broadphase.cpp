@@ -0,0 +1,45 @@
+#include "ECS/Systems/Broadphase.hpp"
+
+/**
+ * @file Broadphase.cpp
+ *
+ * @brief Implementation for @link Broadphase.hpp @endlink
+*/
+
+void BruteForceBroadphase::Update(const std::vector<BroadphaseProxy>& proxies)
+{
+    mBounds.clear();
+    mFilters.clear();
+    for (const BroadphaseProxy& proxy : proxies)
+    {
+        mBounds.push_back(proxy.bounds);
+        mFilters.push_back(proxy.filter);
+    }
+}
+
+void BruteForceBroadphase::FindPairs(std::vector<BroadphasePair>& pairs)
+{
+    std::uint32_t count = static_cast<std::uint32_t>(mBounds.size());
+    for (std::uint32_t first = 0; first < count; first++)
+    {
+        for (std::uint32_t second = first + 1; second < count; second++)
+        {
+            if (mFilters[first].CanInteract(mFilters[second]) && mBounds[first].Overlaps(mBounds[second]))
+            {
+                pairs.push_back({first, second});
+            }
+        }
+    }
+}
+
+void BruteForceBroadphase::Query(const AABB& bounds, const CollisionFilter& filter, std::vector<std::uint32_t>& proxies) const
+{
+    std::uint32_t count = static_cast<std::uint32_t>(mBounds.size());
+    for (std::uint32_t proxy = 0; proxy < count; proxy++)
+    {
+        if (mFilters[proxy].CanInteract(filter) && mBounds[proxy].Overlaps(bounds))
+        {
+            proxies.push_back(proxy);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#include "ECS/Systems/ContactBuffer.hpp"
+
+#include <algorithm>
+
+/**
+ * @file ContactBuffer.cpp
+ *
+ * @brief Implementation for @link ContactBuffer.hpp @endlink
+*/
+
+void ContactBuffer::Reset()
+{
+    mPending.clear();
+    mCollisions.clear();
+    mOwners.clear();
+    NextFrame();
+}
+
+void ContactBuffer::NextFrame()
+{
+    // After 2^32 frames an old tag could come round again
+    if (++mFrame == 0)
+    {
+        std::fill(mSlots.begin(), mSlots.end(), Slot());
+        mFrame = 1;
+    }
+}
+
+void ContactBuffer::Build()
+{
+    // A fresh tag, so a second Build() doesn't count onto the last one's slots
+    NextFrame();
+
+    // Count each owner's contacts
+    mOwners.clear();
+    for (const Pending& pending : mPending)
+    {
+        std::uint32_t index = EntityIndex(pending.owner);
+        if (index >= mSlots.size())
+        {
+            mSlots.resize(index + 1);
+        }
+
+        Slot& slot = mSlots[index];
+        if (slot.frame != mFrame)
+        {
+            slot.frame = mFrame;
+            slot.entity = pending.owner;
+            slot.count = 0;
+            mOwners.push_back(pending.owner);
+        }
+        slot.count++;
+    }
+
+    // Give each owner its run of the array, in Entity order
+    std::sort(mOwners.begin(), mOwners.end());
+    std::uint32_t begin = 0;
+    for (Entity owner : mOwners)
+    {
+        Slot& slot = mSlots[EntityIndex(owner)];
+        slot.begin = begin;
+        begin += slot.count;
+        slot.count = 0;
+    }
+
+    // Drop each contact in at the end of its owner's run so far
+    mCollisions.resize(mPending.size());
+    for (const Pending& pending : mPending)
+    {
+        Slot& slot = mSlots[EntityIndex(pending.owner)];
+        mCollisions[slot.begin + slot.count] = pending.collision;
+        slot.count++;
+    }
+    mPending.clear();
+}
@@ -0,0 +1,25 @@
+#include "ECS/Systems/IntegrationSystem.hpp"
+
+/**
+ * @file IntegrationSystem.cpp
+ *
+ * @brief Implementation for @link IntegrationSystem.hpp @endlink
+*/
+
+void IntegrationSystem::ApplyGravity(Velocity* velocities, const Gravity* gravities, std::size_t count, double dt)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        velocities[i].y -= gravities[i].gravity * dt;
+    }
+}
+
+void IntegrationSystem::ApplyVelocity(Transform* transforms, const Velocity* velocities, std::size_t count, double dt)
+{
+    // Plain per-field loads, as nothing promises x and y sit next to each other in a Component
+    for (std::size_t i = 0; i < count; i++)
+    {
+        transforms[i].x += velocities[i].x * dt;
+        transforms[i].y += velocities[i].y * dt;
+    }
+}
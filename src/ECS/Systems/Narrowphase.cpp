@@ -0,0 +1,255 @@
+#include "ECS/Systems/Narrowphase.hpp"
+
+#include <algorithm>
+
+#include "ECS/Components/RectangleCollider.hpp"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#define ROC_NARROWPHASE_SSE2 1
+#if defined(__GNUC__)
+#define ROC_NARROWPHASE_AVX2 1
+#endif
+#endif
+
+/**
+ * @file Narrowphase.cpp
+ *
+ * @brief Implementation for @link Narrowphase.hpp @endlink
+*/
+
+namespace
+{
+    /** The arrays a kernel reads, and the box it tests against them */
+    struct Batch
+    {
+        const double* minX;
+        const double* minY;
+        const double* maxX;
+        const double* maxY;
+        AABB box;
+    };
+
+    /** @returns The index of the lowest set bit of a non-zero mask. */
+    unsigned LowestBit(std::uint32_t mask)
+    {
+#if defined(__GNUC__)
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+        unsigned bit = 0;
+        while ((mask & 1) == 0)
+        {
+            mask >>= 1;
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
+    std::uint32_t OverlapMaskScalar(const Batch& batch, const std::uint32_t* candidates, std::size_t count)
+    {
+        std::uint32_t mask = 0;
+        for (std::size_t k = 0; k < count; k++)
+        {
+            std::uint32_t c = candidates[k];
+            bool hit = batch.box.minX < batch.maxX[c] && batch.box.maxX > batch.minX[c]
+                && batch.box.minY < batch.maxY[c] && batch.box.maxY > batch.minY[c];
+            mask |= static_cast<std::uint32_t>(hit) << k;
+        }
+        return mask;
+    }
+
+#ifdef ROC_NARROWPHASE_SSE2
+    std::uint32_t OverlapMaskSSE2(const Batch& batch, const std::uint32_t* candidates, std::size_t count)
+    {
+        const __m128d minX = _mm_set1_pd(batch.box.minX);
+        const __m128d minY = _mm_set1_pd(batch.box.minY);
+        const __m128d maxX = _mm_set1_pd(batch.box.maxX);
+        const __m128d maxY = _mm_set1_pd(batch.box.maxY);
+
+        // SSE2 has no gather, so the pair of candidates is loaded lane by lane
+        std::uint32_t mask = 0;
+        std::size_t k = 0;
+        for (; k + 2 <= count; k += 2)
+        {
+            std::uint32_t a = candidates[k];
+            std::uint32_t b = candidates[k + 1];
+            __m128d hit = _mm_and_pd(
+                _mm_and_pd(_mm_cmplt_pd(minX, _mm_set_pd(batch.maxX[b], batch.maxX[a])),
+                           _mm_cmpgt_pd(maxX, _mm_set_pd(batch.minX[b], batch.minX[a]))),
+                _mm_and_pd(_mm_cmplt_pd(minY, _mm_set_pd(batch.maxY[b], batch.maxY[a])),
+                           _mm_cmpgt_pd(maxY, _mm_set_pd(batch.minY[b], batch.minY[a]))));
+            mask |= static_cast<std::uint32_t>(_mm_movemask_pd(hit)) << k;
+        }
+        if (k < count)
+        {
+            mask |= OverlapMaskScalar(batch, candidates + k, count - k) << k;
+        }
+        return mask;
+    }
+#endif
+
+#ifdef ROC_NARROWPHASE_AVX2
+    __attribute__((target("avx2")))
+    std::uint32_t OverlapMaskAVX2(const Batch& batch, const std::uint32_t* candidates, std::size_t count)
+    {
+        const __m256d minX = _mm256_set1_pd(batch.box.minX);
+        const __m256d minY = _mm256_set1_pd(batch.box.minY);
+        const __m256d maxX = _mm256_set1_pd(batch.box.maxX);
+        const __m256d maxY = _mm256_set1_pd(batch.box.maxY);
+
+        // Lane-by-lane loads rather than _mm256_i32gather_pd: on
+        // many CPUs (and on all with the gather microcode fix) the
+        // gather instruction is slower than four plain loads
+        std::uint32_t mask = 0;
+        std::size_t k = 0;
+        for (; k + 4 <= count; k += 4)
+        {
+            std::uint32_t a = candidates[k];
+            std::uint32_t b = candidates[k + 1];
+            std::uint32_t c = candidates[k + 2];
+            std::uint32_t d = candidates[k + 3];
+            __m256d otherMinX = _mm256_set_pd(batch.minX[d], batch.minX[c], batch.minX[b], batch.minX[a]);
+            __m256d otherMinY = _mm256_set_pd(batch.minY[d], batch.minY[c], batch.minY[b], batch.minY[a]);
+            __m256d otherMaxX = _mm256_set_pd(batch.maxX[d], batch.maxX[c], batch.maxX[b], batch.maxX[a]);
+            __m256d otherMaxY = _mm256_set_pd(batch.maxY[d], batch.maxY[c], batch.maxY[b], batch.maxY[a]);
+
+            // Ordered, non-signalling compares: NaN never overlaps, like the scalar test
+            __m256d hit = _mm256_and_pd(
+                _mm256_and_pd(_mm256_cmp_pd(minX, otherMaxX, _CMP_LT_OQ), _mm256_cmp_pd(maxX, otherMinX, _CMP_GT_OQ)),
+                _mm256_and_pd(_mm256_cmp_pd(minY, otherMaxY, _CMP_LT_OQ), _mm256_cmp_pd(maxY, otherMinY, _CMP_GT_OQ)));
+            mask |= static_cast<std::uint32_t>(_mm256_movemask_pd(hit)) << k;
+        }
+        if (k < count)
+        {
+            mask |= OverlapMaskScalar(batch, candidates + k, count - k) << k;
+        }
+        return mask;
+    }
+#endif
+}
+
+int CollisionSides(const AABB& box, const AABB& other)
+{
+    if (!box.Overlaps(other))
+    {
+        return 0;
+    }
+
+    // How far `other` reaches in past each side
+    double left = other.maxX - box.minX;
+    double right = box.maxX - other.minX;
+    double bottom = other.maxY - box.minY;
+    double top = box.maxY - other.minY;
+    double least = std::min(std::min(left, right), std::min(bottom, top));
+
+    int sides = 0;
+    sides |= left == least ? COLLISION_LEFT : 0;
+    sides |= right == least ? COLLISION_RIGHT : 0;
+    sides |= bottom == least ? COLLISION_BOTTOM : 0;
+    sides |= top == least ? COLLISION_TOP : 0;
+    return sides;
+}
+
+int MirrorSides(int sides)
+{
+    int mirrored = 0;
+    mirrored |= (sides & COLLISION_LEFT) ? COLLISION_RIGHT : 0;
+    mirrored |= (sides & COLLISION_RIGHT) ? COLLISION_LEFT : 0;
+    mirrored |= (sides & COLLISION_TOP) ? COLLISION_BOTTOM : 0;
+    mirrored |= (sides & COLLISION_BOTTOM) ? COLLISION_TOP : 0;
+    return mirrored;
+}
+
+Narrowphase::Narrowphase()
+    : mLevel(std::min(SimdLevel::SSE2, BestSimdLevel()))
+{
+}
+
+SimdLevel Narrowphase::BestSimdLevel()
+{
+#if defined(ROC_NARROWPHASE_AVX2)
+    static const SimdLevel best = __builtin_cpu_supports("avx2") ? SimdLevel::AVX2 : SimdLevel::SSE2;
+    return best;
+#elif defined(ROC_NARROWPHASE_SSE2)
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+void Narrowphase::SetSimdLevel(SimdLevel level)
+{
+    mLevel = std::min(level, BestSimdLevel());
+}
+
+void Narrowphase::SetBounds(const std::vector<BroadphaseProxy>& proxies)
+{
+    std::size_t count = proxies.size();
+    mMinX.resize(count);
+    mMinY.resize(count);
+    mMaxX.resize(count);
+    mMaxY.resize(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        mMinX[i] = proxies[i].bounds.minX;
+        mMinY[i] = proxies[i].bounds.minY;
+        mMaxX[i] = proxies[i].bounds.maxX;
+        mMaxY[i] = proxies[i].bounds.maxY;
+    }
+}
+
+std::uint32_t Narrowphase::OverlapMask(std::uint32_t box, const std::uint32_t* candidates, std::size_t count) const
+{
+    Batch batch{mMinX.data(), mMinY.data(), mMaxX.data(), mMaxY.data(), BoundsOf(box)};
+    count = std::min(count, MASK_BITS);
+    switch (mLevel)
+    {
+#ifdef ROC_NARROWPHASE_AVX2
+    case SimdLevel::AVX2:
+        return OverlapMaskAVX2(batch, candidates, count);
+#endif
+#ifdef ROC_NARROWPHASE_SSE2
+    case SimdLevel::SSE2:
+        return OverlapMaskSSE2(batch, candidates, count);
+#endif
+    default:
+        return OverlapMaskScalar(batch, candidates, count);
+    }
+}
+
+void Narrowphase::Run(const std::vector<BroadphasePair>& pairs, std::vector<Contact>& contacts)
+{
+    Run(pairs, 0, pairs.size(), contacts, mCandidates);
+}
+
+void Narrowphase::Run(const std::vector<BroadphasePair>& pairs, std::size_t begin, std::size_t end,
+    std::vector<Contact>& contacts, std::vector<std::uint32_t>& scratch) const
+{
+    while (begin < end)
+    {
+        // Gather the group of pairs sharing a first collider
+        std::uint32_t box = pairs[begin].first;
+        std::size_t last = begin;
+        scratch.clear();
+        while (last < end && pairs[last].first == box)
+        {
+            scratch.push_back(pairs[last].second);
+            last++;
+        }
+
+        const AABB bounds = BoundsOf(box);
+        for (std::size_t block = 0; block < scratch.size(); block += MASK_BITS)
+        {
+            std::size_t count = std::min(MASK_BITS, scratch.size() - block);
+            std::uint32_t mask = OverlapMask(box, scratch.data() + block, count);
+            while (mask != 0)
+            {
+                std::uint32_t other = scratch[block + LowestBit(mask)];
+                contacts.push_back({box, other, CollisionSides(bounds, BoundsOf(other))});
+                mask &= mask - 1;
+            }
+        }
+        begin = last;
+    }
+}
@@ -0,0 +1,370 @@
+#include "ECS/Systems/SpatialHash.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @file SpatialHash.cpp
+ *
+ * @brief Implementation for @link SpatialHash.hpp @endlink
+*/
+
+namespace
+{
+    /** Keeps cell coordinates well inside int32_t, whatever the bounds */
+    const double CELL_LIMIT = 1 << 30;
+}
+
+SpatialHashBroadphase::SpatialHashBroadphase(double cellSize)
+    : mCellSize(64.0), mInverseCellSize(1.0 / 64.0)
+{
+    SetCellSize(cellSize);
+}
+
+void SpatialHashBroadphase::SetCellSize(double cellSize)
+{
+    if (!(cellSize > 0) || !std::isfinite(cellSize))
+    {
+        return;
+    }
+    mCellSize = cellSize;
+    mInverseCellSize = 1.0 / cellSize;
+}
+
+std::int32_t SpatialHashBroadphase::CellOf(double coordinate) const
+{
+    double cell = std::floor(coordinate * mInverseCellSize);
+    return static_cast<std::int32_t>(std::clamp(cell, -CELL_LIMIT, CELL_LIMIT));
+}
+
+SpatialHashBroadphase::CellRange SpatialHashBroadphase::RangeOf(const AABB& bounds) const
+{
+    if (std::isnan(bounds.minX) || std::isnan(bounds.minY) || std::isnan(bounds.maxX) || std::isnan(bounds.maxY))
+    {
+        return {0, 0, -1, -1};
+    }
+    return {CellOf(bounds.minX), CellOf(bounds.minY), CellOf(bounds.maxX), CellOf(bounds.maxY)};
+}
+
+void SpatialHashBroadphase::Update(const std::vector<BroadphaseProxy>& proxies)
+{
+    std::size_t count = proxies.size();
+    mBounds.resize(count);
+    mFilters.resize(count);
+    mRanges.resize(count);
+    mIsOversized.assign(count, false);
+    mOversized.clear();
+    mEntries.clear();
+    mGrid = {0, 0, -1, -1};
+    mRayMarks.assign(count, 0);
+    mRayMark = 0;
+
+    for (std::uint32_t proxy = 0; proxy < count; proxy++)
+    {
+        const AABB& bounds = proxies[proxy].bounds;
+        mBounds[proxy] = bounds;
+        mFilters[proxy] = proxies[proxy].filter;
+
+        bool finite = std::isfinite(bounds.minX) && std::isfinite(bounds.minY)
+            && std::isfinite(bounds.maxX) && std::isfinite(bounds.maxY);
+        CellRange range = finite ? RangeOf(bounds) : CellRange{0, 0, -1, -1};
+        mRanges[proxy] = range;
+
+        if (!finite || CellCount(range) > MAX_CELLS_PER_PROXY)
+        {
+            mIsOversized[proxy] = true;
+            mOversized.push_back(proxy);
+            continue;
+        }
+
+        if (mEntries.empty())
+        {
+            mGrid = range;
+        }
+        else
+        {
+            mGrid = {std::min(mGrid.minX, range.minX), std::min(mGrid.minY, range.minY),
+                std::max(mGrid.maxX, range.maxX), std::max(mGrid.maxY, range.maxY)};
+        }
+
+        for (std::int32_t x = range.minX; x <= range.maxX; x++)
+        {
+            for (std::int32_t y = range.minY; y <= range.maxY; y++)
+            {
+                mEntries.push_back({CellKey(x, y), proxy});
+            }
+        }
+    }
+
+    std::sort(mEntries.begin(), mEntries.end(), [](const CellEntry& a, const CellEntry& b)
+    {
+        return a.cell != b.cell ? a.cell < b.cell : a.proxy < b.proxy;
+    });
+}
+
+void SpatialHashBroadphase::FindPairs(std::vector<BroadphasePair>& pairs)
+{
+    PairCells(0, mEntries.size(), pairs);
+    PairOversized(0, mOversized.size(), pairs);
+}
+
+void SpatialHashBroadphase::ParallelFindPairs(ThreadPool& pool, std::vector<BroadphasePair>& pairs)
+{
+    // Chunks are runs of whole cells, so every cell is paired up by one chunk
+    mCellStarts.clear();
+    for (std::size_t i = 0; i < mEntries.size(); i++)
+    {
+        if (i == 0 || mEntries[i].cell != mEntries[i - 1].cell)
+        {
+            mCellStarts.push_back(i);
+        }
+    }
+    mCellStarts.push_back(mEntries.size());
+
+    ParallelCollect(pool, mCellStarts.size() - 1, CELLS_PER_TASK, mChunkPairs, pairs,
+        [this](std::size_t begin, std::size_t end, std::vector<BroadphasePair>& found)
+        {
+            PairCells(mCellStarts[begin], mCellStarts[end], found);
+        });
+    ParallelCollect(pool, mOversized.size(), 1, mChunkPairs, pairs,
+        [this](std::size_t begin, std::size_t end, std::vector<BroadphasePair>& found)
+        {
+            PairOversized(begin, end, found);
+        });
+}
+
+void SpatialHashBroadphase::PairCells(std::size_t begin, std::size_t last, std::vector<BroadphasePair>& pairs) const
+{
+    while (begin < last)
+    {
+        std::uint64_t cell = mEntries[begin].cell;
+        std::size_t end = begin + 1;
+        while (end < last && mEntries[end].cell == cell)
+        {
+            end++;
+        }
+
+        std::int32_t cellX = static_cast<std::int32_t>(cell >> 32);
+        std::int32_t cellY = static_cast<std::int32_t>(cell & 0xFFFFFFFF);
+        for (std::size_t a = begin; a < end; a++)
+        {
+            const CellRange& first = mRanges[mEntries[a].proxy];
+            const CollisionFilter& filter = mFilters[mEntries[a].proxy];
+            for (std::size_t b = a + 1; b < end; b++)
+            {
+                if (!filter.CanInteract(mFilters[mEntries[b].proxy]))
+                {
+                    continue;
+                }
+
+                // Only the first cell both colliders cover reports them
+                const CellRange& second = mRanges[mEntries[b].proxy];
+                if (std::max(first.minX, second.minX) != cellX || std::max(first.minY, second.minY) != cellY)
+                {
+                    continue;
+                }
+                pairs.push_back({mEntries[a].proxy, mEntries[b].proxy});
+            }
+        }
+        begin = end;
+    }
+}
+
+void SpatialHashBroadphase::PairOversized(std::size_t begin, std::size_t end, std::vector<BroadphasePair>& pairs) const
+{
+    for (std::size_t i = begin; i < end; i++)
+    {
+        std::uint32_t big = mOversized[i];
+        for (std::uint32_t other = 0; other < mBounds.size(); other++)
+        {
+            if (other == big || (mIsOversized[other] && other < big) || !mFilters[big].CanInteract(mFilters[other]))
+            {
+                continue;
+            }
+            if (mBounds[big].Overlaps(mBounds[other]))
+            {
+                pairs.push_back({std::min(big, other), std::max(big, other)});
+            }
+        }
+    }
+}
+
+void SpatialHashBroadphase::Query(const AABB& bounds, const CollisionFilter& filter, std::vector<std::uint32_t>& proxies) const
+{
+    CellRange range = RangeOf(bounds);
+    if (CellCount(range) > MAX_CELLS_PER_PROXY)
+    {
+        for (std::uint32_t proxy = 0; proxy < mBounds.size(); proxy++)
+        {
+            if (mFilters[proxy].CanInteract(filter) && mBounds[proxy].Overlaps(bounds))
+            {
+                proxies.push_back(proxy);
+            }
+        }
+        return;
+    }
+
+    for (std::int32_t x = range.minX; x <= range.maxX; x++)
+    {
+        for (std::int32_t y = range.minY; y <= range.maxY; y++)
+        {
+            std::uint64_t cell = CellKey(x, y);
+            auto entry = std::lower_bound(mEntries.begin(), mEntries.end(), cell,
+                [](const CellEntry& e, std::uint64_t key) { return e.cell < key; });
+            for (; entry != mEntries.end() && entry->cell == cell; ++entry)
+            {
+                // As in FindPairs(), only the first cell both cover reports a collider
+                const CellRange& other = mRanges[entry->proxy];
+                if (!mFilters[entry->proxy].CanInteract(filter)
+                    || std::max(range.minX, other.minX) != x || std::max(range.minY, other.minY) != y)
+                {
+                    continue;
+                }
+                proxies.push_back(entry->proxy);
+            }
+        }
+    }
+
+    for (std::uint32_t big : mOversized)
+    {
+        if (mFilters[big].CanInteract(filter) && mBounds[big].Overlaps(bounds))
+        {
+            proxies.push_back(big);
+        }
+    }
+}
+
+void SpatialHashBroadphase::QueryRay(const Ray& ray, const CollisionFilter& filter, std::vector<std::uint32_t>& proxies) const
+{
+    if (!std::isfinite(ray.originX) || !std::isfinite(ray.originY) || !std::isfinite(ray.dirX) || !std::isfinite(ray.dirY)
+        || (ray.dirX == 0 && ray.dirY == 0))
+    {
+        Broadphase::QueryRay(ray, filter, proxies);
+        return;
+    }
+
+    // After 2^32 queries an old mark could come round again
+    if (++mRayMark == 0)
+    {
+        std::fill(mRayMarks.begin(), mRayMarks.end(), 0);
+        mRayMark = 1;
+    }
+
+    // The oversized colliders first, as any hit among them shortens the walk
+    double closest = ray.maxDistance;
+    for (std::uint32_t big : mOversized)
+    {
+        double distance;
+        int axis;
+        if (mFilters[big].CanInteract(filter) && RayHitsBox(ray, mBounds[big], distance, axis))
+        {
+            proxies.push_back(big);
+            closest = std::min(closest, distance);
+        }
+    }
+    if (mEntries.empty())
+    {
+        return;
+    }
+
+    // Clip the ray to the occupied cells
+    double start = 0;
+    double end = closest;
+    const double origin[2] = {ray.originX, ray.originY};
+    const double dir[2] = {ray.dirX, ray.dirY};
+    const double low[2] = {mGrid.minX * mCellSize, mGrid.minY * mCellSize};
+    const double high[2] = {(mGrid.maxX + 1.0) * mCellSize, (mGrid.maxY + 1.0) * mCellSize};
+    for (int a = 0; a < 2; a++)
+    {
+        if (dir[a] == 0)
+        {
+            if (origin[a] < low[a] || origin[a] > high[a])
+            {
+                return;
+            }
+            continue;
+        }
+        double closer = (low[a] - origin[a]) / dir[a];
+        double further = (high[a] - origin[a]) / dir[a];
+        start = std::max(start, std::min(closer, further));
+        end = std::min(end, std::max(closer, further));
+    }
+    if (!(start <= end))
+    {
+        return;
+    }
+
+    std::int32_t x = std::clamp(CellOf(ray.originX + ray.dirX * start), mGrid.minX, mGrid.maxX);
+    std::int32_t y = std::clamp(CellOf(ray.originY + ray.dirY * start), mGrid.minY, mGrid.maxY);
+
+    // Step cell by cell, into whichever neighbour the ray reaches first
+    std::int32_t stepX = ray.dirX > 0 ? 1 : -1;
+    std::int32_t stepY = ray.dirY > 0 ? 1 : -1;
+    double deltaX = ray.dirX == 0 ? HUGE_VAL : mCellSize / std::abs(ray.dirX);
+    double deltaY = ray.dirY == 0 ? HUGE_VAL : mCellSize / std::abs(ray.dirY);
+    double nextX = ray.dirX == 0 ? HUGE_VAL : ((x + (stepX > 0 ? 1.0 : 0.0)) * mCellSize - ray.originX) / ray.dirX;
+    double nextY = ray.dirY == 0 ? HUGE_VAL : ((y + (stepY > 0 ? 1.0 : 0.0)) * mCellSize - ray.originY) / ray.dirY;
+    double entered = start;
+    std::size_t visited = 0;
+    while (entered <= end && entered <= closest)
+    {
+        // A walk longer than a pass over every collider isn't worth finishing
+        if (++visited > mBounds.size())
+        {
+            for (std::uint32_t proxy = 0; proxy < mBounds.size(); proxy++)
+            {
+                double distance;
+                int axis;
+                if (!mIsOversized[proxy] && mRayMarks[proxy] != mRayMark && mFilters[proxy].CanInteract(filter)
+                    && RayHitsBox(ray, mBounds[proxy], distance, axis))
+                {
+                    proxies.push_back(proxy);
+                }
+            }
+            return;
+        }
+
+        RayCell(ray, filter, x, y, closest, proxies);
+        if (nextX < nextY)
+        {
+            entered = nextX;
+            nextX += deltaX;
+            x += stepX;
+        }
+        else
+        {
+            entered = nextY;
+            nextY += deltaY;
+            y += stepY;
+        }
+        if (x < mGrid.minX || x > mGrid.maxX || y < mGrid.minY || y > mGrid.maxY)
+        {
+            break;
+        }
+    }
+}
+
+void SpatialHashBroadphase::RayCell(const Ray& ray, const CollisionFilter& filter, std::int32_t x, std::int32_t y,
+    double& closest, std::vector<std::uint32_t>& proxies) const
+{
+    std::uint64_t cell = CellKey(x, y);
+    auto entry = std::lower_bound(mEntries.begin(), mEntries.end(), cell,
+        [](const CellEntry& e, std::uint64_t key) { return e.cell < key; });
+    for (; entry != mEntries.end() && entry->cell == cell; ++entry)
+    {
+        std::uint32_t proxy = entry->proxy;
+        if (mRayMarks[proxy] == mRayMark || !mFilters[proxy].CanInteract(filter))
+        {
+            continue;
+        }
+        mRayMarks[proxy] = mRayMark;
+
+        double distance;
+        int axis;
+        if (RayHitsBox(ray, mBounds[proxy], distance, axis))
+        {
+            proxies.push_back(proxy);
+            closest = std::min(closest, distance);
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#include "ECS/Systems/StaticIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @file StaticIndex.cpp
+ *
+ * @brief Implementation for @link StaticIndex.hpp @endlink
+*/
+
+void StaticIndex::Build(const std::vector<BroadphaseProxy>& proxies)
+{
+    mBuilds++;
+    mNodes.clear();
+    mItems.clear();
+    for (std::uint32_t i = 0; i < proxies.size(); i++)
+    {
+        const AABB& bounds = proxies[i].bounds;
+        if (std::isnan(bounds.minX) || std::isnan(bounds.minY) || std::isnan(bounds.maxX) || std::isnan(bounds.maxY))
+        {
+            continue;
+        }
+        mItems.push_back({bounds, proxies[i].filter, i});
+    }
+
+    if (!mItems.empty())
+    {
+        mNodes.reserve(2 * (mItems.size() / LEAF_SIZE + 1));
+        BuildNode(0, static_cast<std::uint32_t>(mItems.size()));
+    }
+}
+
+std::uint32_t StaticIndex::BuildNode(std::uint32_t begin, std::uint32_t end)
+{
+    std::uint32_t index = static_cast<std::uint32_t>(mNodes.size());
+    mNodes.emplace_back();
+
+    // The node's box and filter cover all of its items
+    Node node;
+    node.bounds = mItems[begin].bounds;
+    node.filter = mItems[begin].filter;
+    double lowX = HUGE_VAL;
+    double lowY = HUGE_VAL;
+    double highX = -HUGE_VAL;
+    double highY = -HUGE_VAL;
+    for (std::uint32_t i = begin; i < end; i++)
+    {
+        const AABB& bounds = mItems[i].bounds;
+        node.bounds.minX = std::min(node.bounds.minX, bounds.minX);
+        node.bounds.minY = std::min(node.bounds.minY, bounds.minY);
+        node.bounds.maxX = std::max(node.bounds.maxX, bounds.maxX);
+        node.bounds.maxY = std::max(node.bounds.maxY, bounds.maxY);
+        node.filter.layers |= mItems[i].filter.layers;
+        node.filter.mask |= mItems[i].filter.mask;
+
+        // Centres, doubled; an infinite box's is NaN, which std::min/max pass over
+        lowX = std::min(lowX, bounds.minX + bounds.maxX);
+        lowY = std::min(lowY, bounds.minY + bounds.maxY);
+        highX = std::max(highX, bounds.minX + bounds.maxX);
+        highY = std::max(highY, bounds.minY + bounds.maxY);
+    }
+
+    if (end - begin <= LEAF_SIZE)
+    {
+        node.begin = begin;
+        node.count = end - begin;
+        mNodes[index] = node;
+        return index;
+    }
+
+    // Split at the median centre along the axis the centres spread out most on.
+    // Boxes infinite both ways have no centre (-inf + inf), so they sort last.
+    bool alongX = !(highY - lowY > highX - lowX);
+    auto centre = [alongX](const Item& item)
+    {
+        double c = alongX ? item.bounds.minX + item.bounds.maxX : item.bounds.minY + item.bounds.maxY;
+        return std::isnan(c) ? HUGE_VAL : c;
+    };
+    std::uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(mItems.begin() + begin, mItems.begin() + middle, mItems.begin() + end,
+        [&](const Item& a, const Item& b) { return centre(a) < centre(b); });
+
+    BuildNode(begin, middle);
+    node.right = BuildNode(middle, end);
+    mNodes[index] = node;
+    return index;
+}
@@ -0,0 +1,309 @@
+#include "ECS/Systems/SweepAndPrune.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/**
+ * @file SweepAndPrune.cpp
+ *
+ * @brief Implementation for @link SweepAndPrune.hpp @endlink
+*/
+
+namespace
+{
+    const std::uint32_t NO_BOX = UINT32_MAX;
+}
+
+SweepAndPruneBroadphase::SweepAndPruneBroadphase(SweepAxes axes)
+    : mAxes(axes), mBoxOf(MAX_ENTITIES, NO_BOX)
+{
+    if (axes != SweepAxes::Y)
+    {
+        mSortAxes.push_back({{}, 0});
+    }
+    if (axes != SweepAxes::X)
+    {
+        mSortAxes.push_back({{}, 1});
+    }
+}
+
+void SweepAndPruneBroadphase::Update(const std::vector<BroadphaseProxy>& proxies)
+{
+    mStamp++;
+    mSwaps = 0;
+
+    // Note which boxes are still around
+    for (const BroadphaseProxy& proxy : proxies)
+    {
+        if (EntityIndex(proxy.entity) >= mBoxOf.size())
+        {
+            mBoxOf.resize(EntityIndex(proxy.entity) + 1, NO_BOX);
+        }
+
+        std::uint32_t box = mBoxOf[EntityIndex(proxy.entity)];
+        if (box != NO_BOX && mBoxes[box].entity == proxy.entity)
+        {
+            mBoxes[box].stamp = mStamp;
+        }
+    }
+
+    // Drop the ones that aren't, with their endpoints and pairs
+    bool removed = false;
+    for (std::uint32_t box = 0; box < mBoxes.size(); box++)
+    {
+        Box& b = mBoxes[box];
+        if (!b.alive || b.stamp == mStamp)
+        {
+            continue;
+        }
+
+        if (mBoxOf[EntityIndex(b.entity)] == box)
+        {
+            mBoxOf[EntityIndex(b.entity)] = NO_BOX;
+        }
+        b.alive = false;
+        mFreeBoxes.push_back(box);
+        removed = true;
+    }
+
+    if (removed)
+    {
+        for (Axis& axis : mSortAxes)
+        {
+            axis.endpoints.erase(std::remove_if(axis.endpoints.begin(), axis.endpoints.end(),
+                [this](const Endpoint& e) { return !mBoxes[e.box].alive; }), axis.endpoints.end());
+        }
+        mPairs.EraseIf([this](std::uint64_t key)
+        {
+            return !mBoxes[PairSet::First(key)].alive || !mBoxes[PairSet::Second(key)].alive;
+        });
+    }
+
+    // Add new boxes at the end of each axis, and take this frame's bounds
+    std::size_t added = 0;
+    bool refiltered = false;
+    mMaxExtent = 0;
+    for (std::uint32_t i = 0; i < proxies.size(); i++)
+    {
+        const BroadphaseProxy& proxy = proxies[i];
+        std::uint32_t box = mBoxOf[EntityIndex(proxy.entity)];
+        if (box == NO_BOX)
+        {
+            box = AllocateBox();
+            mBoxes[box].entity = proxy.entity;
+            mBoxes[box].stamp = mStamp;
+            mBoxOf[EntityIndex(proxy.entity)] = box;
+            for (Axis& axis : mSortAxes)
+            {
+                axis.endpoints.push_back({0, box, false});
+                axis.endpoints.push_back({0, box, true});
+            }
+            added++;
+        }
+        else if (mBoxes[box].filter != proxy.filter)
+        {
+            refiltered = true;
+        }
+        mBoxes[box].filter = proxy.filter;
+        mBoxes[box].extent[0] = IntervalOf(proxy.bounds, 0);
+        mBoxes[box].extent[1] = IntervalOf(proxy.bounds, 1);
+        mBoxes[box].proxy = i;
+
+        // Broken boxes' NaN widths never count
+        const Interval& extent = mBoxes[box].extent[mSortAxes.front().index];
+        if (extent.max - extent.min > mMaxExtent)
+        {
+            mMaxExtent = extent.max - extent.min;
+        }
+    }
+
+    for (Axis& axis : mSortAxes)
+    {
+        for (Endpoint& endpoint : axis.endpoints)
+        {
+            const Interval& extent = mBoxes[endpoint.box].extent[axis.index];
+            endpoint.value = endpoint.isMax ? extent.max : extent.min;
+        }
+    }
+
+    // Pairs a changed filter allows (or forbids) aren't found by swaps
+    if (added * 4 > proxies.size() || refiltered)
+    {
+        Rebuild();
+        return;
+    }
+
+    for (Axis& axis : mSortAxes)
+    {
+        SortAxis(axis);
+    }
+}
+
+void SweepAndPruneBroadphase::FindPairs(std::vector<BroadphasePair>& pairs)
+{
+    for (std::uint64_t key : mPairs.Keys())
+    {
+        std::uint32_t first = mBoxes[PairSet::First(key)].proxy;
+        std::uint32_t second = mBoxes[PairSet::Second(key)].proxy;
+        pairs.push_back({std::min(first, second), std::max(first, second)});
+    }
+}
+
+void SweepAndPruneBroadphase::Query(const AABB& bounds, const CollisionFilter& filter, std::vector<std::uint32_t>& proxies) const
+{
+    const Axis& axis = mSortAxes.front();
+    Interval query = IntervalOf(bounds, axis.index);
+    Interval other = IntervalOf(bounds, 1 - axis.index);
+
+    // Only intervals starting before the query's end, and no more than the widest box before its start, can overlap it
+    auto byValue = [](const Endpoint& e, double value) { return e.value < value; };
+    auto begin = std::lower_bound(axis.endpoints.begin(), axis.endpoints.end(), query.min - mMaxExtent, byValue);
+    auto end = std::lower_bound(begin, axis.endpoints.end(), query.max, byValue);
+    for (auto it = begin; it != end; ++it)
+    {
+        const Box& box = mBoxes[it->box];
+        if (it->isMax || !box.filter.CanInteract(filter))
+        {
+            continue;
+        }
+
+        const Interval& extent = box.extent[axis.index];
+        const Interval& across = box.extent[1 - axis.index];
+        if (extent.max > query.min && across.min < other.max && across.max > other.min)
+        {
+            proxies.push_back(box.proxy);
+        }
+    }
+}
+
+SweepAndPruneBroadphase::Interval SweepAndPruneBroadphase::IntervalOf(const AABB& bounds, int axis)
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+    double min = axis == 0 ? bounds.minX : bounds.minY;
+    double max = axis == 0 ? bounds.maxX : bounds.maxY;
+
+    // Broken boxes sort last, and inside-out ones are treated as empty ones at their start
+    if (std::isnan(min))
+    {
+        return {infinity, infinity};
+    }
+    return {min, std::isnan(max) ? infinity : std::max(min, max)};
+}
+
+bool SweepAndPruneBroadphase::OverlapElsewhere(std::uint32_t a, std::uint32_t b, int skip) const
+{
+    if (!mBoxes[a].filter.CanInteract(mBoxes[b].filter))
+    {
+        return false;
+    }
+
+    for (const Axis& axis : mSortAxes)
+    {
+        if (axis.index == skip)
+        {
+            continue;
+        }
+
+        const Interval& first = mBoxes[a].extent[axis.index];
+        const Interval& second = mBoxes[b].extent[axis.index];
+        if (!(first.min < second.max && first.max > second.min))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SweepAndPruneBroadphase::SortAxis(Axis& axis)
+{
+    std::vector<Endpoint>& endpoints = axis.endpoints;
+    for (std::size_t i = 1; i < endpoints.size(); i++)
+    {
+        Endpoint key = endpoints[i];
+        std::size_t j = i;
+        while (j > 0 && Less(key, endpoints[j - 1]))
+        {
+            const Endpoint& passed = endpoints[j - 1];
+            if (key.isMax != passed.isMax && key.box != passed.box)
+            {
+                if (!key.isMax)
+                {
+                    // A start passing an end: the intervals now overlap
+                    if (OverlapElsewhere(key.box, passed.box, axis.index))
+                    {
+                        mPairs.Insert(PairSet::Key(key.box, passed.box));
+                    }
+                }
+                else
+                {
+                    // An end passing a start: they no longer do
+                    mPairs.Erase(PairSet::Key(key.box, passed.box));
+                }
+            }
+
+            endpoints[j] = passed;
+            j--;
+            mSwaps++;
+        }
+        endpoints[j] = key;
+    }
+}
+
+void SweepAndPruneBroadphase::Rebuild()
+{
+    for (Axis& axis : mSortAxes)
+    {
+        std::sort(axis.endpoints.begin(), axis.endpoints.end(), Less);
+    }
+
+    // Sweep the first axis, pairing each start with the boxes still open.
+    // An empty interval's end sorts before its start, so it never opens.
+    mPairs.Clear();
+    std::vector<std::uint32_t> active;
+    std::vector<bool> ended(mBoxes.size(), false);
+    for (const Endpoint& endpoint : mSortAxes.front().endpoints)
+    {
+        if (endpoint.isMax)
+        {
+            auto it = std::find(active.begin(), active.end(), endpoint.box);
+            if (it != active.end())
+            {
+                *it = active.back();
+                active.pop_back();
+            }
+            ended[endpoint.box] = true;
+            continue;
+        }
+
+        for (std::uint32_t other : active)
+        {
+            if (OverlapElsewhere(endpoint.box, other, -1))
+            {
+                mPairs.Insert(PairSet::Key(endpoint.box, other));
+            }
+        }
+        if (!ended[endpoint.box])
+        {
+            active.push_back(endpoint.box);
+        }
+    }
+}
+
+std::uint32_t SweepAndPruneBroadphase::AllocateBox()
+{
+    std::uint32_t box;
+    if (!mFreeBoxes.empty())
+    {
+        box = mFreeBoxes.back();
+        mFreeBoxes.pop_back();
+        mBoxes[box] = Box();
+    }
+    else
+    {
+        box = static_cast<std::uint32_t>(mBoxes.size());
+        mBoxes.emplace_back();
+    }
+    mBoxes[box].alive = true;
+    return box;
+}
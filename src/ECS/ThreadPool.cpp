@@ -0,0 +1,202 @@
+#include "ECS/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @file ThreadPool.cpp
+ *
+ * @brief Implementation for @link ThreadPool.hpp @endlink
+*/
+
+namespace
+{
+    // The pool and queue index of the calling thread, if it is a worker
+    thread_local const ThreadPool* tPool = nullptr;
+    thread_local std::size_t tQueue = 0;
+}
+
+ThreadPool::ThreadPool(std::size_t workers)
+{
+    // Workers 0..n-1 own a queue each; with no workers, one shared queue
+    std::size_t queues = std::max<std::size_t>(workers, 1);
+    for (std::size_t i = 0; i < queues; i++)
+    {
+        mQueues.push_back(std::make_unique<Queue>());
+    }
+
+    for (std::size_t i = 0; i < workers; i++)
+    {
+        mThreads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    // Nothing can wait on queued tasks once we're gone, so run them first
+    while (RunPending()) {}
+
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mStopping = true;
+    }
+    mWake.notify_all();
+
+    for (std::thread& thread : mThreads)
+    {
+        thread.join();
+    }
+}
+
+std::size_t ThreadPool::DefaultWorkerCount()
+{
+    std::size_t hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 1;
+}
+
+void ThreadPool::Submit(Task task)
+{
+    std::size_t queue = CurrentWorker();
+    if (queue == SIZE_MAX)
+    {
+        queue = mNextQueue++ % mQueues.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mQueues[queue]->mutex);
+        mQueues[queue]->tasks.push_back(std::move(task));
+    }
+    mPending++;
+
+    // Taking the lock orders this with a worker checking mPending
+    // before it sleeps, so the wakeup can't be lost
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+    }
+    mWake.notify_one();
+}
+
+bool ThreadPool::RunPending()
+{
+    std::size_t queue = CurrentWorker();
+    return TryRun(queue == SIZE_MAX ? 0 : queue);
+}
+
+void ThreadPool::WorkerLoop(std::size_t index)
+{
+    tPool = this;
+    tQueue = index;
+
+    while (true)
+    {
+        if (TryRun(index))
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mWake.wait(lock, [this]() { return mStopping || mPending > 0; });
+        if (mStopping && mPending == 0)
+        {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::TryRun(std::size_t first)
+{
+    if (mPending == 0)
+    {
+        return false;
+    }
+
+    Task task;
+    for (std::size_t i = 0; i < mQueues.size() && !task; i++)
+    {
+        Queue& queue = *mQueues[(first + i) % mQueues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            continue;
+        }
+
+        // Newest of our own tasks, oldest of anyone else's
+        if (i == 0)
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+
+    if (!task)
+    {
+        return false;
+    }
+
+    mPending--;
+    task();
+    return true;
+}
+
+std::size_t ThreadPool::CurrentWorker() const
+{
+    return tPool == this ? tQueue : SIZE_MAX;
+}
+
+TaskGroup::~TaskGroup()
+{
+    // Tasks still refer to the group, so they must finish first
+    Drain();
+}
+
+void TaskGroup::Run(ThreadPool::Task task)
+{
+    mRemaining++;
+    mPool.Submit([this, task = std::move(task)]()
+    {
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mErrorMutex);
+            if (!mError)
+            {
+                mError = std::current_exception();
+            }
+        }
+        mRemaining--;
+    });
+}
+
+void TaskGroup::Wait()
+{
+    Drain();
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mErrorMutex);
+        std::swap(error, mError);
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void TaskGroup::Drain()
+{
+    while (mRemaining > 0)
+    {
+        if (!mPool.RunPending())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
@@ -11,6 +11,21 @@ BOOST_AUTO_TEST_CASE( GravityComponent_Tests )
     SPDLOG_TRACE("Test Gravity Properties Exist");
     Gravity g;
     BOOST_CHECK_NO_THROW( g.gravity = 8.7 );
+
+    // Ensure gravity can be set by name through the static property table
+    SPDLOG_TRACE("Test Gravity Properties Set By Name");
+    BOOST_TEST( g.SetProperty("gravity", Property(1.5)) );
+    BOOST_TEST( g.gravity == 1.5 );
+    BOOST_TEST( !g.SetProperty("DNE", Property(1.5)) );
+    BOOST_CHECK_THROW( g.SetProperty("gravity", Property(1)), std::bad_any_cast );
+
+    // Ensure the table describes the property, and copies stay plain data
+    SPDLOG_TRACE("Test Gravity Property Table");
+    const PropertyDescriptor* d = FindProperty(Gravity::Properties(), "gravity");
+    BOOST_REQUIRE( d != nullptr );
+    BOOST_TEST( (*d->type == typeid(double)) );
+    BOOST_TEST( reinterpret_cast<double*>(reinterpret_cast<char*>(&g) + d->offset) == &g.gravity );
+    BOOST_TEST( std::is_trivially_copyable<Gravity>::value );
 }
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -16,8 +16,17 @@ BOOST_AUTO_TEST_CASE( RectangleColliderComponent_Tests )
     BOOST_CHECK_NO_THROW( rc.width = 5.0 );
     BOOST_CHECK_NO_THROW( rc.height = 5.0 );
 
-    // Ensure collision vector exists
-    BOOST_CHECK_NO_THROW( rc.collisions.emplace_back(Collision()) );
+    // Ensure layer properties exist, on layer 0 and touching every layer
+    BOOST_TEST( rc.layer == 1u );
+    BOOST_TEST( rc.mask == 0xFFFFFFFFu );
+    BOOST_CHECK_NO_THROW( rc.SetProperty("layer", Property(std::uint32_t(4))) );
+    BOOST_TEST( rc.layer == 4u );
+
+    // Ensure collision flags can be set and checked
+    Collision collision{0, 0};
+    AddCollision(collision, COLLISION_LEFT);
+    BOOST_TEST( CheckCollision(collision, COLLISION_LEFT) );
+    BOOST_TEST( !CheckCollision(collision, COLLISION_RIGHT) );
 }
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,28 @@
+#include <boost/test/unit_test.hpp>
+
+#include <ECS/Roc_ECS.hpp>
+#include <spdlog/spdlog.h>
+
+BOOST_AUTO_TEST_SUITE( Component_Tests )
+
+BOOST_AUTO_TEST_CASE( VelocityComponent_Tests )
+{
+    // Ensure velocity properties exist and start at rest
+    SPDLOG_TRACE("Test Velocity Properties Exist");
+    Velocity v;
+    BOOST_TEST( v.x == 0 );
+    BOOST_TEST( v.y == 0 );
+    BOOST_CHECK_NO_THROW( v.x = 3.5 );
+
+    // Ensure velocity can be set by name through the static property table
+    SPDLOG_TRACE("Test Velocity Properties Set By Name");
+    BOOST_TEST( v.SetProperty("y", Property(-2.0)) );
+    BOOST_TEST( v.y == -2.0 );
+    BOOST_TEST( !v.SetProperty("z", Property(1.0)) );
+
+    // Ensure copies stay plain data
+    SPDLOG_TRACE("Test Velocity Is Plain Data");
+    BOOST_TEST( std::is_trivially_copyable<Velocity>::value );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
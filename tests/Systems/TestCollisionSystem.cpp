@@ -0,0 +1,1100 @@
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <ECS/Roc_ECS.hpp>
+
+struct Collision_Fixture
+{
+    Collision_Fixture()
+    {
+        Coordinator* c = Coordinator::Get();
+        c->Init();
+        c->RegisterComponent<Transform>();
+        c->RegisterComponent<RectangleCollider>();
+        system = c->RegisterSystem<CollisionSystem>();
+        c->SetSystemSignature<CollisionSystem>(system->GetSignature());
+    }
+    ~Collision_Fixture()
+    {
+        Coordinator::DeleteCoordinator();
+    }
+
+    Entity AddBox(double x, double y, double width, double height)
+    {
+        Coordinator* c = Coordinator::Get();
+        Entity e = c->CreateEntities(1).front();
+        Transform t;
+        t.x = x;
+        t.y = y;
+        RectangleCollider rc;
+        rc.width = width;
+        rc.height = height;
+        c->AddComponent<Transform>(e, t);
+        c->AddComponent<RectangleCollider>(e, rc);
+        return e;
+    }
+
+    std::shared_ptr<CollisionSystem> system;
+};
+
+// A mix of small and large boxes, some overlapping
+static std::vector<BroadphaseProxy> RandomProxies(std::size_t count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> position(-500.0, 500.0);
+    std::uniform_real_distribution<double> size(1.0, 40.0);
+    std::vector<BroadphaseProxy> proxies;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        BroadphaseProxy proxy;
+        proxy.entity = static_cast<Entity>(i);
+        proxy.bounds.minX = position(rng);
+        proxy.bounds.minY = position(rng);
+        double scale = (i % 50 == 0) ? 10.0 : 1.0;
+        proxy.bounds.maxX = proxy.bounds.minX + size(rng) * scale;
+        proxy.bounds.maxY = proxy.bounds.minY + size(rng) * scale;
+        proxies.push_back(proxy);
+    }
+    return proxies;
+}
+
+// The overlapping pairs a Broadphase finds, sorted, checking none repeats
+static std::vector<BroadphasePair> OverlappingPairs(Broadphase& broadphase, const std::vector<BroadphaseProxy>& proxies)
+{
+    std::vector<BroadphasePair> pairs;
+    broadphase.Update(proxies);
+    broadphase.FindPairs(pairs);
+    std::sort(pairs.begin(), pairs.end());
+    BOOST_TEST( (std::adjacent_find(pairs.begin(), pairs.end()) == pairs.end()) );
+    for (const BroadphasePair& pair : pairs)
+    {
+        BOOST_TEST( pair.first < pair.second );
+    }
+    pairs.erase(std::remove_if(pairs.begin(), pairs.end(), [&](const BroadphasePair& pair)
+    {
+        return !proxies[pair.first].bounds.Overlaps(proxies[pair.second].bounds);
+    }), pairs.end());
+    return pairs;
+}
+
+BOOST_AUTO_TEST_SUITE( System_Tests )
+
+// Sanity tests for what CollisionSystem::Do() reports
+BOOST_FIXTURE_TEST_CASE( CollisionSystem_Tests, Collision_Fixture )
+{
+    SPDLOG_TRACE("Test Overlapping Colliders Collide");
+    Coordinator* c = Coordinator::Get();
+    Entity a = AddBox(0, 0, 10, 10);
+    Entity b = AddBox(5, 5, 10, 10);
+    Entity touching = AddBox(10, -10, 5, 10);
+    Entity far = AddBox(1000, 1000, 10, 10);
+    system->Update();
+    ContactSpan ca = system->ContactsOf(a);
+    ContactSpan cb = system->ContactsOf(b);
+    BOOST_REQUIRE( ca.size() == 1 );
+    BOOST_REQUIRE( cb.size() == 1 );
+    BOOST_TEST( ca[0].ent_collided == b );
+    BOOST_TEST( cb[0].ent_collided == a );
+
+    // Are the sides hit reported, mirrored for the other collider?
+    SPDLOG_TRACE("Test Collision Sides");
+    BOOST_TEST( ca[0].collision_pos == (COLLISION_RIGHT | COLLISION_TOP) );
+    BOOST_TEST( cb[0].collision_pos == (COLLISION_LEFT | COLLISION_BOTTOM) );
+    BOOST_TEST( CheckCollision(ca[0], COLLISION_TOP) );
+    BOOST_TEST( !CheckCollision(ca[0], COLLISION_BOTTOM) );
+    BOOST_TEST( system->ContactsOf(touching).empty() );
+    BOOST_TEST( system->ContactsOf(far).empty() );
+
+    // Are collider offsets part of the bounds?
+    SPDLOG_TRACE("Test Collider Offsets Move Bounds");
+    c->GetComponent<RectangleCollider>(far).offsetX = -995;
+    c->GetComponent<RectangleCollider>(far).offsetY = -995;
+    system->Update();
+    BOOST_TEST( system->ContactsOf(far).size() == 2 );
+    BOOST_TEST( system->ContactsOf(a).size() == 2 );
+
+    // Are last frame's collisions cleared?
+    SPDLOG_TRACE("Test Collisions Cleared Each Frame");
+    c->GetComponent<Transform>(b).x = 500;
+    system->Update();
+    BOOST_TEST( system->ContactsOf(b).empty() );
+    BOOST_TEST( system->ContactsOf(a).size() == 1 );
+    BOOST_TEST( system->GetContacts().Size() == 2 );
+
+    // Running Do() again without a Clear() finds the same contacts, not twice as many
+    SPDLOG_TRACE("Test Do Twice Without Clear");
+    system->Do();
+    system->Do();
+    BOOST_TEST( system->ContactsOf(a).size() == 1 );
+    BOOST_TEST( system->ContactsOf(far).size() == 1 );
+    BOOST_TEST( system->ContactsOf(b).empty() );
+    BOOST_TEST( system->GetContacts().Size() == 2 );
+
+    // Does a destroyed Entity's handle stop finding its slot's contacts?
+    SPDLOG_TRACE("Test Stale Handles Find No Contacts");
+    c->DestroyEntities(&far, 1);
+    Entity reused = AddBox(5, 5, 10, 10);
+    system->Update();
+    BOOST_TEST( system->ContactsOf(far).empty() );
+    BOOST_TEST( system->ContactsOf(reused).size() == 1 );
+}
+
+// Sanity tests for CollisionSystem's enter, stay and exit events
+BOOST_FIXTURE_TEST_CASE( CollisionEvents_Tests, Collision_Fixture )
+{
+    SPDLOG_TRACE("Test New Overlaps Enter");
+    Coordinator* c = Coordinator::Get();
+    Entity a = AddBox(0, 0, 10, 10);
+    Entity b = AddBox(5, 5, 10, 10);
+    Entity d = AddBox(100, 0, 10, 10);
+    system->Update();
+    BOOST_REQUIRE( system->GetEnterEvents().size() == 1 );
+    const CollisionEvent& enter = system->GetEnterEvents()[0];
+    BOOST_TEST( enter.first == std::min(a, b) );
+    BOOST_TEST( enter.second == std::max(a, b) );
+    BOOST_TEST( enter.sides == (a < b ? COLLISION_RIGHT | COLLISION_TOP : COLLISION_LEFT | COLLISION_BOTTOM) );
+    BOOST_TEST( system->GetStayEvents().empty() );
+    BOOST_TEST( system->GetExitEvents().empty() );
+
+    SPDLOG_TRACE("Test Lasting Overlaps Stay");
+    c->GetComponent<Transform>(b).x = 4;
+    system->Update();
+    BOOST_TEST( system->GetEnterEvents().empty() );
+    BOOST_REQUIRE( system->GetStayEvents().size() == 1 );
+    BOOST_TEST( system->GetStayEvents()[0].first == std::min(a, b) );
+    BOOST_TEST( system->GetExitEvents().empty() );
+
+    SPDLOG_TRACE("Test Ended Overlaps Exit");
+    c->GetComponent<Transform>(b).x = 95;
+    system->Update();
+    BOOST_REQUIRE( system->GetExitEvents().size() == 1 );
+    BOOST_TEST( system->GetExitEvents()[0].first == std::min(a, b) );
+    BOOST_TEST( system->GetExitEvents()[0].second == std::max(a, b) );
+    BOOST_REQUIRE( system->GetEnterEvents().size() == 1 );
+    BOOST_TEST( system->GetEnterEvents()[0].first == std::min(b, d) );
+    BOOST_TEST( system->GetStayEvents().empty() );
+
+    SPDLOG_TRACE("Test Nothing Changing Gives Only Stays");
+    system->Update();
+    BOOST_TEST( system->GetEnterEvents().empty() );
+    BOOST_TEST( system->GetStayEvents().size() == 1 );
+    BOOST_TEST( system->GetExitEvents().empty() );
+
+    // Does each Do() report only its own events, even without a Clear()?
+    SPDLOG_TRACE("Test Do Twice Without Clear Reports One Frame");
+    c->GetComponent<Transform>(b).x = 200;
+    system->Do();
+    BOOST_TEST( system->GetExitEvents().size() == 1 );
+    c->GetComponent<Transform>(b).x = 95;
+    system->Do();
+    BOOST_TEST( system->GetEnterEvents().size() == 1 );
+    BOOST_TEST( system->GetStayEvents().empty() );
+    BOOST_TEST( system->GetExitEvents().empty() );
+    system->Do();
+    BOOST_TEST( system->GetEnterEvents().empty() );
+    BOOST_TEST( system->GetStayEvents().size() == 1 );
+
+    SPDLOG_TRACE("Test Destroyed Entities Exit");
+    c->DestroyEntities(&d, 1);
+    system->Update();
+    BOOST_REQUIRE( system->GetExitEvents().size() == 1 );
+    BOOST_TEST( system->GetExitEvents()[0].first == std::min(b, d) );
+    BOOST_TEST( system->GetStayEvents().empty() );
+}
+
+// Sanity tests for collision layers, masks and the layer matrix
+BOOST_FIXTURE_TEST_CASE( CollisionLayers_Tests, Collision_Fixture )
+{
+    SPDLOG_TRACE("Test Layer Matrix");
+    Coordinator* c = Coordinator::Get();
+    BOOST_TEST( system->LayersInteract(1, 1) );
+    BOOST_TEST( system->SetLayersInteract(1, 1, false) );
+    BOOST_TEST( system->SetLayersInteract(2, 1, false) );
+    BOOST_TEST( !system->LayersInteract(1, 1) );
+    BOOST_TEST( !system->LayersInteract(1, 2) );
+    BOOST_TEST( system->LayersInteract(0, 1) );
+    BOOST_TEST( !system->SetLayersInteract(0, CollisionSystem::COLLISION_LAYERS, false) );
+    BOOST_TEST( !system->LayersInteract(-1, 0) );
+
+    SPDLOG_TRACE("Test Layers That Don't Interact Don't Collide");
+    Entity wall = AddBox(0, 0, 100, 10);
+    Entity bullet = AddBox(10, 5, 4, 4);
+    Entity otherBullet = AddBox(12, 5, 4, 4);
+    Entity pickup = AddBox(11, 6, 2, 2);
+    c->GetComponent<RectangleCollider>(bullet).layer = 1 << 1;
+    c->GetComponent<RectangleCollider>(otherBullet).layer = 1 << 1;
+    c->GetComponent<RectangleCollider>(pickup).layer = 1 << 2;
+    system->Update();
+    BOOST_TEST( system->ContactsOf(wall).size() == 3 );
+    BOOST_TEST( system->ContactsOf(bullet).size() == 1 );
+    BOOST_TEST( system->ContactsOf(otherBullet).size() == 1 );
+    BOOST_TEST( system->ContactsOf(pickup).size() == 1 );
+
+    SPDLOG_TRACE("Test Masks Filter Both Ways");
+    c->GetComponent<RectangleCollider>(pickup).mask = 1 << 1;
+    system->Update();
+    BOOST_TEST( system->ContactsOf(pickup).empty() );
+    BOOST_TEST( system->ContactsOf(wall).size() == 2 );
+    c->GetComponent<RectangleCollider>(wall).mask = 0;
+    system->Update();
+    BOOST_TEST( system->GetContacts().Size() == 0 );
+
+    SPDLOG_TRACE("Test Reenabled Layers Collide Again");
+    c->GetComponent<RectangleCollider>(wall).mask = 0xFFFFFFFF;
+    system->SetLayersInteract(1, 1, true);
+    system->Update();
+    BOOST_TEST( system->ContactsOf(bullet).size() == 2 );
+}
+
+// Sanity tests that every Broadphase honours CollisionFilters
+BOOST_AUTO_TEST_CASE( BroadphaseFilter_Tests )
+{
+    SPDLOG_TRACE("Test Broadphases Drop Pairs That Can't Interact");
+    std::vector<BroadphaseProxy> proxies = RandomProxies(600, 23);
+    for (std::size_t i = 0; i < proxies.size(); i++)
+    {
+        proxies[i].filter.layers = 1u << (i % 4);
+        proxies[i].filter.mask = (i % 4 == 3) ? 1u : UINT32_MAX & ~(1u << (i % 4));
+    }
+
+    BruteForceBroadphase brute;
+    SpatialHashBroadphase hash(16.0);
+    AABBTreeBroadphase tree;
+    SweepAndPruneBroadphase sap;
+    SweepAndPruneBroadphase sapX(SweepAxes::X);
+    std::vector<Broadphase*> broadphases{&hash, &tree, &sap, &sapX};
+
+    std::vector<BroadphaseProxy> unfiltered = proxies;
+    for (BroadphaseProxy& proxy : unfiltered)
+    {
+        proxy.filter = CollisionFilter();
+    }
+    std::size_t everything = OverlappingPairs(brute, unfiltered).size();
+
+    for (int frame = 0; frame < 3; frame++)
+    {
+        std::vector<BroadphasePair> expected = OverlappingPairs(brute, proxies);
+        BOOST_TEST( expected.size() < everything );
+        for (const BroadphasePair& pair : expected)
+        {
+            BOOST_TEST( proxies[pair.first].filter.CanInteract(proxies[pair.second].filter) );
+        }
+        for (Broadphase* broadphase : broadphases)
+        {
+            BOOST_TEST( (OverlappingPairs(*broadphase, proxies) == expected) );
+        }
+        BOOST_TEST( tree.Validate() );
+
+        // Change some filters without moving anything
+        for (std::size_t i = frame; i < proxies.size(); i += 7)
+        {
+            proxies[i].filter.mask ^= 1u << ((i + frame) % 4);
+        }
+    }
+}
+
+// Sanity tests for the StaticIndex
+BOOST_AUTO_TEST_CASE( StaticIndex_Tests )
+{
+    SPDLOG_TRACE("Test Queries Match Brute Force");
+    std::vector<BroadphaseProxy> proxies = RandomProxies(500, 29);
+    for (std::size_t i = 0; i < proxies.size(); i += 5)
+    {
+        proxies[i].filter.layers = 2;
+    }
+    proxies[3].bounds.minX = std::nan("");
+    proxies[4].bounds = {-HUGE_VAL, -HUGE_VAL, HUGE_VAL, HUGE_VAL};
+
+    StaticIndex index;
+    BOOST_TEST( index.GetBuildCount() == 0u );
+    index.Build(proxies);
+    BOOST_TEST( index.Size() == proxies.size() - 1 );
+    BOOST_TEST( index.GetBuildCount() == 1u );
+
+    CollisionFilter filter;
+    filter.mask = 1;
+    for (const BroadphaseProxy& probe : RandomProxies(100, 31))
+    {
+        std::vector<std::uint32_t> expected;
+        for (std::uint32_t i = 0; i < proxies.size(); i++)
+        {
+            if (proxies[i].filter.CanInteract(filter) && proxies[i].bounds.Overlaps(probe.bounds))
+            {
+                expected.push_back(i);
+            }
+        }
+
+        std::vector<std::uint32_t> found;
+        index.Query(probe.bounds, filter, [&](std::uint32_t i) { found.push_back(i); });
+        std::sort(found.begin(), found.end());
+        BOOST_TEST( (found == expected) );
+        BOOST_TEST( std::count(found.begin(), found.end(), 4u) == 1 );
+    }
+
+    SPDLOG_TRACE("Test Empty Index");
+    index.Build({});
+    std::size_t hits = 0;
+    index.Query({-HUGE_VAL, -HUGE_VAL, HUGE_VAL, HUGE_VAL}, CollisionFilter(), [&](std::uint32_t) { hits++; });
+    BOOST_TEST( hits == 0u );
+}
+
+// Sanity tests for static colliders in the CollisionSystem
+BOOST_FIXTURE_TEST_CASE( StaticColliders_Tests, Collision_Fixture )
+{
+    SPDLOG_TRACE("Test Static Colliders Only Hit Moving Ones");
+    Coordinator* c = Coordinator::Get();
+    Entity floor = AddBox(0, 0, 100, 10);
+    Entity wall = AddBox(0, 0, 10, 100);
+    Entity player = AddBox(5, 5, 10, 10);
+    Entity enemy = AddBox(12, 5, 10, 10);
+    c->GetComponent<RectangleCollider>(floor).isStatic = true;
+    c->GetComponent<RectangleCollider>(wall).isStatic = true;
+    system->Update();
+    BOOST_TEST( system->GetStaticIndex().Size() == 2u );
+    BOOST_TEST( system->ContactsOf(floor).size() == 2 );
+    BOOST_TEST( system->ContactsOf(wall).size() == 1 );
+    BOOST_TEST( system->ContactsOf(player).size() == 3 );
+    BOOST_TEST( system->ContactsOf(enemy).size() == 2 );
+    for (const Collision& collision : system->ContactsOf(floor))
+    {
+        BOOST_TEST( collision.ent_collided != wall );
+    }
+
+    // Are sides still reported from each collider's point of view?
+    ContactSpan enemyHits = system->ContactsOf(enemy);
+    auto onFloor = std::find_if(enemyHits.begin(), enemyHits.end(),
+        [&](const Collision& collision) { return collision.ent_collided == floor; });
+    BOOST_REQUIRE( onFloor != enemyHits.end() );
+    BOOST_TEST( onFloor->collision_pos == COLLISION_BOTTOM );
+
+    SPDLOG_TRACE("Test Static Index Only Rebuilt On Change");
+    std::size_t builds = system->GetStaticIndex().GetBuildCount();
+    c->GetComponent<Transform>(player).x = 50;
+    system->Update();
+    system->Update();
+    BOOST_TEST( system->GetStaticIndex().GetBuildCount() == builds );
+    BOOST_TEST( system->ContactsOf(wall).empty() );
+
+    c->GetComponent<Transform>(wall).x = 45;
+    system->Update();
+    BOOST_TEST( system->GetStaticIndex().GetBuildCount() == builds + 1 );
+    BOOST_TEST( system->ContactsOf(wall).size() == 1 );
+
+    c->GetComponent<RectangleCollider>(wall).isStatic = false;
+    system->Update();
+    BOOST_TEST( system->GetStaticIndex().GetBuildCount() == builds + 2 );
+    BOOST_TEST( system->GetStaticIndex().Size() == 1u );
+    BOOST_TEST( system->ContactsOf(wall).size() == 2 );
+
+    c->DestroyEntities(&floor, 1);
+    system->Update();
+    BOOST_TEST( system->GetStaticIndex().Size() == 0u );
+    BOOST_TEST( system->ContactsOf(enemy).empty() );
+
+    // Destroying a moving collider moves the last statics up in the Component arrays, but changes none
+    Entity passerby = AddBox(300, 300, 5, 5);
+    Entity ledge = AddBox(400, 400, 10, 10);
+    Entity shelf = AddBox(500, 500, 10, 10);
+    c->GetComponent<RectangleCollider>(ledge).isStatic = true;
+    c->GetComponent<RectangleCollider>(shelf).isStatic = true;
+    system->Update();
+    builds = system->GetStaticIndex().GetBuildCount();
+    c->DestroyEntities(&passerby, 1);
+    system->Update();
+    BOOST_TEST( system->GetStaticIndex().GetBuildCount() == builds );
+    BOOST_TEST( system->GetStaticIndex().Size() == 2u );
+}
+
+// Sanity tests for the ray against box test
+BOOST_AUTO_TEST_CASE( RayHitsBox_Tests )
+{
+    SPDLOG_TRACE("Test Rays Hit Boxes");
+    AABB box{10, 0, 20, 10};
+    double distance = -1;
+    int axis = -2;
+    BOOST_TEST( RayHitsBox({0, 5, 1, 0, 100}, box, distance, axis) );
+    BOOST_TEST( distance == 10 );
+    BOOST_TEST( axis == 0 );
+    BOOST_TEST( RayHitsBox({15, 20, 0, -2, 100}, box, distance, axis) );
+    BOOST_TEST( distance == 5 );
+    BOOST_TEST( axis == 1 );
+    BOOST_TEST( RayHitsBox({15, 5, 1, 1, 100}, box, distance, axis) );
+    BOOST_TEST( distance == 0 );
+    BOOST_TEST( axis == -1 );
+
+    SPDLOG_TRACE("Test Rays Miss Boxes");
+    BOOST_TEST( !RayHitsBox({0, 5, 1, 0, 9}, box, distance, axis) );
+    BOOST_TEST( !RayHitsBox({0, 5, -1, 0, 100}, box, distance, axis) );
+    BOOST_TEST( !RayHitsBox({0, 10, 1, 0, 100}, box, distance, axis) );
+    BOOST_TEST( !RayHitsBox({0, 30, 1, -1, 100}, box, distance, axis) );
+    BOOST_TEST( !RayHitsBox({0, 5, 0, 0, 100}, box, distance, axis) );
+    BOOST_TEST( !RayHitsBox({0, 5, 1, 0, 100}, {std::nan(""), 0, 20, 10}, distance, axis) );
+    BOOST_TEST( RayHitsBox({0, 5, 1, 0, HUGE_VAL}, {30, -HUGE_VAL, 40, HUGE_VAL}, distance, axis) );
+    BOOST_TEST( distance == 30 );
+}
+
+// Sanity tests for every Broadphase's Query()
+BOOST_AUTO_TEST_CASE( BroadphaseQuery_Tests )
+{
+    SPDLOG_TRACE("Test Broadphase Queries Find Every Overlap Once");
+    std::vector<BroadphaseProxy> proxies = RandomProxies(400, 37);
+    for (std::size_t i = 0; i < proxies.size(); i += 3)
+    {
+        proxies[i].filter.layers = 2;
+    }
+    proxies[5].bounds = {-1e9, 10, 1e9, 20};
+
+    BruteForceBroadphase brute;
+    SpatialHashBroadphase hash(16.0);
+    AABBTreeBroadphase tree;
+    SweepAndPruneBroadphase sap;
+    SweepAndPruneBroadphase sapY(SweepAxes::Y);
+    std::vector<Broadphase*> broadphases{&brute, &hash, &tree, &sap, &sapY};
+    for (Broadphase* broadphase : broadphases)
+    {
+        broadphase->Update(proxies);
+    }
+
+    std::vector<AABB> queries;
+    for (const BroadphaseProxy& proxy : RandomProxies(50, 41))
+    {
+        queries.push_back(proxy.bounds);
+    }
+    queries.push_back({-HUGE_VAL, -HUGE_VAL, HUGE_VAL, HUGE_VAL});
+    queries.push_back({50, 50, 50, 50});
+
+    CollisionFilter filter;
+    filter.mask = 1;
+    for (const AABB& query : queries)
+    {
+        std::vector<std::uint32_t> expected;
+        for (std::uint32_t i = 0; i < proxies.size(); i++)
+        {
+            if (proxies[i].filter.CanInteract(filter) && proxies[i].bounds.Overlaps(query))
+            {
+                expected.push_back(i);
+            }
+        }
+
+        for (Broadphase* broadphase : broadphases)
+        {
+            std::vector<std::uint32_t> found;
+            broadphase->Query(query, filter, found);
+            std::sort(found.begin(), found.end());
+            BOOST_TEST( (std::adjacent_find(found.begin(), found.end()) == found.end()) );
+            found.erase(std::remove_if(found.begin(), found.end(),
+                [&](std::uint32_t i) { return !proxies[i].bounds.Overlaps(query); }), found.end());
+            BOOST_TEST( (found == expected) );
+        }
+    }
+
+    // Do ray queries find the closest hit, once?
+    SPDLOG_TRACE("Test Broadphase Ray Queries Find The Closest Hit");
+    std::mt19937 rng(59);
+    std::uniform_real_distribution<double> position(-20.0, 220.0);
+    std::uniform_real_distribution<double> angle(0.0, 6.3);
+    for (int i = 0; i < 100; i++)
+    {
+        double a = angle(rng);
+        Ray ray{position(rng), position(rng), std::cos(a), std::sin(a), i % 2 == 0 ? 60.0 : HUGE_VAL};
+        double closest = HUGE_VAL;
+        for (std::uint32_t p = 0; p < proxies.size(); p++)
+        {
+            double distance;
+            int axis;
+            if (proxies[p].filter.CanInteract(filter) && RayHitsBox(ray, proxies[p].bounds, distance, axis))
+            {
+                closest = std::min(closest, distance);
+            }
+        }
+
+        for (Broadphase* broadphase : broadphases)
+        {
+            std::vector<std::uint32_t> found;
+            broadphase->QueryRay(ray, filter, found);
+            std::sort(found.begin(), found.end());
+            BOOST_TEST( (std::adjacent_find(found.begin(), found.end()) == found.end()) );
+            double best = HUGE_VAL;
+            for (std::uint32_t p : found)
+            {
+                double distance;
+                int axis;
+                if (proxies[p].filter.CanInteract(filter) && RayHitsBox(ray, proxies[p].bounds, distance, axis))
+                {
+                    best = std::min(best, distance);
+                }
+            }
+            BOOST_TEST( best == closest );
+        }
+    }
+}
+
+// Sanity tests for CollisionSystem's spatial queries
+BOOST_FIXTURE_TEST_CASE( CollisionQueries_Tests, Collision_Fixture )
+{
+    SPDLOG_TRACE("Test Queries Match Brute Force");
+    Coordinator* c = Coordinator::Get();
+    std::vector<BroadphaseProxy> proxies = RandomProxies(300, 43);
+    std::vector<Entity> entities;
+    for (std::size_t i = 0; i < proxies.size(); i++)
+    {
+        const AABB& bounds = proxies[i].bounds;
+        entities.push_back(AddBox(bounds.minX, bounds.minY, bounds.maxX - bounds.minX, bounds.maxY - bounds.minY));
+        c->GetComponent<RectangleCollider>(entities.back()).isStatic = i % 3 == 0;
+        c->GetComponent<RectangleCollider>(entities.back()).layer = i % 4 == 0 ? 2 : 1;
+
+        // The system's boxes, rounded the way it rounds them
+        proxies[i].bounds.maxX = bounds.minX + (bounds.maxX - bounds.minX);
+        proxies[i].bounds.maxY = bounds.minY + (bounds.maxY - bounds.minY);
+    }
+
+    CollisionFilter filter;
+    filter.mask = 1;
+    std::vector<Ray> rays;
+    std::mt19937 rng(47);
+    std::uniform_real_distribution<double> position(-20.0, 220.0);
+    std::uniform_real_distribution<double> angle(0.0, 6.3);
+    for (int i = 0; i < 200; i++)
+    {
+        double a = angle(rng);
+        rays.push_back({position(rng), position(rng), 3 * std::cos(a), 3 * std::sin(a), i % 2 == 0 ? 40.0 : HUGE_VAL});
+    }
+    rays.push_back({50, 50, 0, 0, 10});
+
+    std::vector<std::unique_ptr<Broadphase>> broadphases;
+    broadphases.push_back(std::make_unique<SpatialHashBroadphase>());
+    broadphases.push_back(std::make_unique<AABBTreeBroadphase>());
+    broadphases.push_back(std::make_unique<SweepAndPruneBroadphase>());
+    for (std::unique_ptr<Broadphase>& broadphase : broadphases)
+    {
+        system->SetBroadphase(std::move(broadphase));
+        system->Update();
+
+        for (const BroadphaseProxy& probe : RandomProxies(30, 53))
+        {
+            std::vector<Entity> expected;
+            for (std::size_t i = 0; i < proxies.size(); i++)
+            {
+                if (i % 4 != 0 && proxies[i].bounds.Overlaps(probe.bounds))
+                {
+                    expected.push_back(entities[i]);
+                }
+            }
+
+            std::vector<Entity> found{entities[0]};
+            BOOST_TEST( system->QueryAABB(probe.bounds, found, filter) == expected.size() );
+            found.erase(found.begin());
+            std::sort(found.begin(), found.end());
+            BOOST_TEST( (found == expected) );
+
+            // Points at each probe's corner
+            std::size_t inside = 0;
+            for (const BroadphaseProxy& proxy : proxies)
+            {
+                inside += proxy.bounds.Overlaps({probe.bounds.minX, probe.bounds.minY, probe.bounds.minX, probe.bounds.minY});
+            }
+            found.clear();
+            BOOST_TEST( system->QueryPoint(probe.bounds.minX, probe.bounds.minY, found) == inside );
+        }
+
+        std::vector<RaycastHit> hits;
+        std::size_t hitCount = system->RaycastBatch(rays, hits, filter);
+        BOOST_REQUIRE( hits.size() == rays.size() );
+        std::size_t expectedHits = 0;
+        for (std::size_t r = 0; r < rays.size(); r++)
+        {
+            RaycastHit expected;
+            double length = std::hypot(rays[r].dirX, rays[r].dirY);
+            Ray unit{rays[r].originX, rays[r].originY, rays[r].dirX / length, rays[r].dirY / length, rays[r].maxDistance};
+            for (std::size_t i = 0; length > 0 && i < proxies.size(); i++)
+            {
+                double distance;
+                int axis;
+                if (i % 4 != 0 && RayHitsBox(unit, proxies[i].bounds, distance, axis)
+                    && (!expected.hit || distance < expected.distance
+                        || (distance == expected.distance && entities[i] < expected.entity)))
+                {
+                    expected.hit = true;
+                    expected.entity = entities[i];
+                    expected.distance = distance;
+                }
+            }
+
+            expectedHits += expected.hit;
+            BOOST_TEST( hits[r].hit == expected.hit );
+            if (expected.hit && hits[r].hit)
+            {
+                BOOST_TEST( hits[r].entity == expected.entity );
+                BOOST_TEST( hits[r].distance == expected.distance );
+                BOOST_TEST( std::hypot(hits[r].x - rays[r].originX, hits[r].y - rays[r].originY) == expected.distance,
+                    boost::test_tools::tolerance(1e-9) );
+            }
+        }
+        BOOST_TEST( hitCount == expectedHits );
+        BOOST_TEST( expectedHits > 0u );
+    }
+
+    SPDLOG_TRACE("Test Raycast Sides");
+    RaycastHit hit;
+    Entity wall = AddBox(1000, 1000, 10, 10);
+    system->Update();
+    BOOST_TEST( system->Raycast({980, 1005, 1, 0, 100}, hit) );
+    BOOST_TEST( hit.entity == wall );
+    BOOST_TEST( hit.side == COLLISION_LEFT );
+    BOOST_TEST( hit.distance == 20 );
+    BOOST_TEST( system->Raycast({1005, 1020, 0, -1, 100}, hit) );
+    BOOST_TEST( hit.side == COLLISION_TOP );
+    BOOST_TEST( hit.y == 1010 );
+    BOOST_TEST( !system->Raycast({1005, 1020, 0, 1, 100}, hit) );
+    BOOST_TEST( !hit.hit );
+}
+
+// Sanity tests for the ContactBuffer
+BOOST_AUTO_TEST_CASE( ContactBuffer_Tests )
+{
+    SPDLOG_TRACE("Test Contacts Grouped By Entity");
+    ContactBuffer buffer;
+    BOOST_TEST( buffer.ContactsOf(3).empty() );
+    buffer.Add(7, {COLLISION_LEFT, 3});
+    buffer.Add(3, {COLLISION_RIGHT, 7});
+    buffer.Add(7, {COLLISION_TOP, 1});
+    buffer.Add(1, {COLLISION_BOTTOM, 7});
+    buffer.Build();
+    BOOST_TEST( buffer.Size() == 4 );
+    BOOST_TEST( (buffer.GetOwners() == std::vector<Entity>{1, 3, 7}) );
+    ContactSpan seven = buffer.ContactsOf(7);
+    BOOST_REQUIRE( seven.size() == 2 );
+    BOOST_TEST( seven[0].ent_collided == 3 );
+    BOOST_TEST( seven[1].ent_collided == 1 );
+    BOOST_TEST( seven.end() - buffer.GetCollisions().data() == 4 );
+    BOOST_TEST( buffer.ContactsOf(1)[0].collision_pos == COLLISION_BOTTOM );
+    BOOST_TEST( buffer.ContactsOf(2).empty() );
+    BOOST_TEST( buffer.ContactsOf(MakeEntity(7, 1)).empty() );
+    BOOST_TEST( buffer.ContactsOf(100000).empty() );
+
+    SPDLOG_TRACE("Test Reset Forgets Every Contact");
+    buffer.Reset();
+    BOOST_TEST( buffer.Size() == 0 );
+    BOOST_TEST( buffer.ContactsOf(7).empty() );
+    buffer.Add(MakeEntity(3, 2), {COLLISION_LEFT, 9});
+    buffer.Build();
+    BOOST_TEST( buffer.ContactsOf(3).empty() );
+    BOOST_TEST( buffer.ContactsOf(MakeEntity(3, 2)).size() == 1 );
+    BOOST_TEST( buffer.ContactsOf(1).empty() );
+
+    SPDLOG_TRACE("Test Build Twice Replaces The Last Build");
+    buffer.Add(MakeEntity(3, 2), {COLLISION_TOP, 4});
+    buffer.Add(4, {COLLISION_BOTTOM, MakeEntity(3, 2)});
+    buffer.Build();
+    BOOST_TEST( buffer.Size() == 2 );
+    BOOST_TEST( buffer.ContactsOf(MakeEntity(3, 2)).size() == 1 );
+    BOOST_TEST( buffer.ContactsOf(MakeEntity(3, 2))[0].ent_collided == 4 );
+    buffer.Build();
+    BOOST_TEST( buffer.Size() == 0 );
+    BOOST_TEST( buffer.ContactsOf(4).empty() );
+}
+
+// Sanity tests for the SpatialHashBroadphase
+BOOST_AUTO_TEST_CASE( SpatialHash_Tests )
+{
+    SPDLOG_TRACE("Test Spatial Hash Matches Brute Force");
+    std::vector<BroadphaseProxy> proxies = RandomProxies(600, 7);
+    BruteForceBroadphase brute;
+    std::vector<BroadphasePair> expected = OverlappingPairs(brute, proxies);
+    BOOST_TEST( !expected.empty() );
+    for (double cellSize : {0.5, 8.0, 64.0, 5000.0})
+    {
+        SpatialHashBroadphase hash(cellSize);
+        BOOST_TEST( hash.GetCellSize() == cellSize );
+        BOOST_TEST( (OverlappingPairs(hash, proxies) == expected) );
+    }
+
+    // Are bad cell sizes refused?
+    SPDLOG_TRACE("Test Spatial Hash Cell Size");
+    SpatialHashBroadphase hash(16.0);
+    hash.SetCellSize(0);
+    hash.SetCellSize(-1);
+    BOOST_TEST( hash.GetCellSize() == 16.0 );
+
+    // Do boxes too big for the grid, or broken ones, still work?
+    SPDLOG_TRACE("Test Spatial Hash Oversized Bounds");
+    BroadphaseProxy huge{0, {-1e9, -1e9, 1e9, 1e9}, CollisionFilter()};
+    BroadphaseProxy broken{0, {std::nan(""), 0, 1, 1}, CollisionFilter()};
+    BroadphaseProxy infinite{0, {0, 0, std::numeric_limits<double>::infinity(), 1}, CollisionFilter()};
+    proxies.insert(proxies.begin() + 10, huge);
+    proxies.push_back(broken);
+    proxies.push_back(infinite);
+    expected = OverlappingPairs(brute, proxies);
+    BOOST_TEST( (OverlappingPairs(hash, proxies) == expected) );
+
+    // Does an unbounded ray stop walking at the first thing it hits?
+    SPDLOG_TRACE("Test Spatial Hash Ray Stops At First Hit");
+    std::vector<BroadphaseProxy> row;
+    for (int i = 0; i < 200; i++)
+    {
+        row.push_back({static_cast<Entity>(i), {i * 20.0, 0, i * 20.0 + 10, 10}, CollisionFilter()});
+    }
+    hash.Update(row);
+    std::vector<std::uint32_t> found;
+    hash.QueryRay({-50, 5, 1, 0}, CollisionFilter(), found);
+    BOOST_TEST( (found == std::vector<std::uint32_t>{0}) );
+    found.clear();
+    hash.QueryRay({1995, 5, -1, 0}, CollisionFilter(), found);
+    BOOST_TEST( (found == std::vector<std::uint32_t>{99}) );
+    found.clear();
+    hash.QueryRay({-50, 50, 1, 0}, CollisionFilter(), found);
+    BOOST_TEST( found.empty() );
+}
+
+// Sanity tests for the AABBTreeBroadphase
+BOOST_AUTO_TEST_CASE( AABBTree_Tests )
+{
+    SPDLOG_TRACE("Test AABB Tree Matches Brute Force");
+    std::vector<BroadphaseProxy> proxies = RandomProxies(600, 3);
+    BruteForceBroadphase brute;
+    AABBTreeBroadphase tree(2.0);
+    BOOST_TEST( tree.GetHeight() == -1 );
+    BOOST_TEST( (OverlappingPairs(tree, proxies) == OverlappingPairs(brute, proxies)) );
+    BOOST_TEST( tree.Validate() );
+    BOOST_TEST( tree.GetLeafCount() == 600 );
+    BOOST_TEST( tree.GetReinsertedCount() == 600 );
+    BOOST_TEST( tree.GetHeight() <= 20 );
+
+    // Does a scene that stands still cost no reinsertions?
+    SPDLOG_TRACE("Test AABB Tree Static Scene");
+    BOOST_TEST( (OverlappingPairs(tree, proxies) == OverlappingPairs(brute, proxies)) );
+    BOOST_TEST( tree.GetReinsertedCount() == 0 );
+
+    // Do colliders moving inside their fattened box stay put?
+    SPDLOG_TRACE("Test AABB Tree Fattened Bounds");
+    for (BroadphaseProxy& proxy : proxies)
+    {
+        proxy.bounds.minX += 1.5;
+        proxy.bounds.maxX += 1.5;
+    }
+    BOOST_TEST( (OverlappingPairs(tree, proxies) == OverlappingPairs(brute, proxies)) );
+    BOOST_TEST( tree.GetReinsertedCount() == 0 );
+
+    // Does the tree follow colliders moving, appearing and disappearing?
+    SPDLOG_TRACE("Test AABB Tree Incremental Updates");
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> step(-20.0, 20.0);
+    Entity next = static_cast<Entity>(proxies.size());
+    for (int frame = 0; frame < 20; frame++)
+    {
+        for (std::size_t i = frame % 5; i < proxies.size(); i += 5)
+        {
+            double dx = step(rng), dy = step(rng);
+            proxies[i].bounds = {proxies[i].bounds.minX + dx, proxies[i].bounds.minY + dy,
+                proxies[i].bounds.maxX + dx, proxies[i].bounds.maxY + dy};
+        }
+        proxies.erase(proxies.begin() + frame * 7);
+        BroadphaseProxy added = proxies[frame];
+        added.entity = next++;
+        proxies.push_back(added);
+        BOOST_TEST( (OverlappingPairs(tree, proxies) == OverlappingPairs(brute, proxies)) );
+        BOOST_TEST( tree.Validate() );
+    }
+    BOOST_TEST( tree.GetLeafCount() == proxies.size() );
+
+    // Is an Entity reusing an index treated as a new collider?
+    SPDLOG_TRACE("Test AABB Tree Recycled Entities");
+    proxies[0].entity = MakeEntity(EntityIndex(proxies[0].entity), EntityGeneration(proxies[0].entity) + 1);
+    BOOST_TEST( (OverlappingPairs(tree, proxies) == OverlappingPairs(brute, proxies)) );
+    BOOST_TEST( tree.GetReinsertedCount() == 1 );
+    BOOST_TEST( tree.Validate() );
+
+    // Does emptying the world empty the tree?
+    SPDLOG_TRACE("Test AABB Tree Empties");
+    proxies.clear();
+    BOOST_TEST( OverlappingPairs(tree, proxies).empty() );
+    BOOST_TEST( tree.GetHeight() == -1 );
+    BOOST_TEST( tree.Validate() );
+}
+
+// Sanity tests for the PairSet hash set
+BOOST_AUTO_TEST_CASE( PairSet_Tests )
+{
+    SPDLOG_TRACE("Test PairSet Insert And Erase");
+    PairSet set;
+    BOOST_TEST( PairSet::Key(3, 7) == PairSet::Key(7, 3) );
+    BOOST_TEST( PairSet::First(PairSet::Key(7, 3)) == 3 );
+    BOOST_TEST( PairSet::Second(PairSet::Key(7, 3)) == 7 );
+    BOOST_TEST( set.Insert(PairSet::Key(1, 2)) );
+    BOOST_TEST( !set.Insert(PairSet::Key(2, 1)) );
+    BOOST_TEST( set.Contains(PairSet::Key(1, 2)) );
+    BOOST_TEST( set.Erase(PairSet::Key(1, 2)) );
+    BOOST_TEST( !set.Erase(PairSet::Key(1, 2)) );
+    BOOST_TEST( set.Empty() );
+
+    // Does the set agree with a sorted reference through many changes?
+    SPDLOG_TRACE("Test PairSet Matches Reference");
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<std::uint32_t> id(0, 60);
+    std::vector<std::uint64_t> reference;
+    for (int step = 0; step < 20000; step++)
+    {
+        std::uint64_t key = PairSet::Key(id(rng), id(rng));
+        auto it = std::find(reference.begin(), reference.end(), key);
+        if (step % 3 == 0)
+        {
+            BOOST_TEST( set.Erase(key) == (it != reference.end()) );
+            if (it != reference.end()) reference.erase(it);
+        }
+        else
+        {
+            BOOST_TEST( set.Insert(key) == (it == reference.end()) );
+            if (it == reference.end()) reference.push_back(key);
+        }
+    }
+    std::vector<std::uint64_t> keys = set.Keys();
+    std::sort(keys.begin(), keys.end());
+    std::sort(reference.begin(), reference.end());
+    BOOST_TEST( (keys == reference) );
+    for (std::uint64_t key : reference)
+    {
+        BOOST_TEST( set.Contains(key) );
+    }
+
+    SPDLOG_TRACE("Test PairSet EraseIf");
+    set.EraseIf([](std::uint64_t key) { return PairSet::First(key) < 30; });
+    for (std::uint64_t key : reference)
+    {
+        BOOST_TEST( set.Contains(key) == (PairSet::First(key) >= 30) );
+    }
+    set.Clear();
+    BOOST_TEST( set.Size() == 0 );
+    BOOST_TEST( !set.Contains(reference.back()) );
+}
+
+// Sanity tests for the SweepAndPruneBroadphase
+BOOST_AUTO_TEST_CASE( SweepAndPrune_Tests )
+{
+    BruteForceBroadphase brute;
+    for (SweepAxes axes : {SweepAxes::Both, SweepAxes::X, SweepAxes::Y})
+    {
+        SPDLOG_TRACE("Test Sweep And Prune Matches Brute Force");
+        std::vector<BroadphaseProxy> proxies = RandomProxies(600, 13);
+        proxies.push_back({600, {0, 0, 10, 10}, CollisionFilter()});
+        proxies.push_back({601, {10, 0, 20, 10}, CollisionFilter()});
+        proxies.push_back({602, {std::nan(""), 0, 1, 1}, CollisionFilter()});
+        SweepAndPruneBroadphase sap(axes);
+        BOOST_TEST( (sap.GetAxes() == axes) );
+        BOOST_TEST( (OverlappingPairs(sap, proxies) == OverlappingPairs(brute, proxies)) );
+
+        // Does a scene that stands still need no swaps?
+        SPDLOG_TRACE("Test Sweep And Prune Static Scene");
+        BOOST_TEST( (OverlappingPairs(sap, proxies) == OverlappingPairs(brute, proxies)) );
+        BOOST_TEST( sap.GetSwapCount() == 0 );
+
+        // Are pairs kept right as colliders move, appear and disappear?
+        SPDLOG_TRACE("Test Sweep And Prune Incremental Updates");
+        std::mt19937 rng(17);
+        std::uniform_real_distribution<double> step(-6.0, 6.0);
+        Entity next = 1000;
+        for (int frame = 0; frame < 20; frame++)
+        {
+            for (BroadphaseProxy& proxy : proxies)
+            {
+                double dx = step(rng), dy = step(rng);
+                proxy.bounds = {proxy.bounds.minX + dx, proxy.bounds.minY + dy,
+                    proxy.bounds.maxX + dx, proxy.bounds.maxY + dy};
+            }
+            proxies.erase(proxies.begin() + frame * 11);
+            BroadphaseProxy added = proxies[frame];
+            added.entity = next++;
+            proxies.push_back(added);
+            BOOST_TEST( (OverlappingPairs(sap, proxies) == OverlappingPairs(brute, proxies)) );
+        }
+        BOOST_TEST( sap.GetSwapCount() > 0 );
+        BOOST_TEST( sap.GetSwapCount() < proxies.size() * 20 );
+
+        // Do boxes that end up exactly touching stop overlapping?
+        SPDLOG_TRACE("Test Sweep And Prune Touching Boxes");
+        proxies.push_back({2000, {0, 0, 10, 10}, CollisionFilter()});
+        proxies.push_back({2001, {5, 5, 15, 15}, CollisionFilter()});
+        BOOST_TEST( (OverlappingPairs(sap, proxies) == OverlappingPairs(brute, proxies)) );
+        proxies.back().bounds = {10, 10, 20, 20};
+        BOOST_TEST( (OverlappingPairs(sap, proxies) == OverlappingPairs(brute, proxies)) );
+        proxies.back().bounds = {9, 9, 19, 19};
+        BOOST_TEST( (OverlappingPairs(sap, proxies) == OverlappingPairs(brute, proxies)) );
+    }
+}
+
+// Sanity tests for the Narrowphase kernels
+BOOST_AUTO_TEST_CASE( Narrowphase_Tests )
+{
+    SPDLOG_TRACE("Test Collision Sides");
+    AABB box{0, 0, 10, 10};
+    BOOST_TEST( CollisionSides(box, {-5, 2, 1, 8}) == COLLISION_LEFT );
+    BOOST_TEST( CollisionSides(box, {9, 2, 15, 8}) == COLLISION_RIGHT );
+    BOOST_TEST( CollisionSides(box, {2, 8, 8, 20}) == COLLISION_TOP );
+    BOOST_TEST( CollisionSides(box, {2, -3, 8, 1}) == COLLISION_BOTTOM );
+    BOOST_TEST( CollisionSides(box, {-1, -1, 1, 1}) == (COLLISION_LEFT | COLLISION_BOTTOM) );
+    BOOST_TEST( CollisionSides(box, {10, 0, 20, 10}) == 0 );
+    BOOST_TEST( MirrorSides(COLLISION_LEFT | COLLISION_TOP) == (COLLISION_RIGHT | COLLISION_BOTTOM) );
+    BOOST_TEST( MirrorSides(MirrorSides(COLLISION_RIGHT)) == COLLISION_RIGHT );
+    AABB other{-5, 2, 1, 8};
+    BOOST_TEST( CollisionSides(other, box) == MirrorSides(CollisionSides(box, other)) );
+
+    // Does every instruction set give the same masks?
+    SPDLOG_TRACE("Test Narrowphase SIMD Levels Agree");
+    std::vector<BroadphaseProxy> proxies = RandomProxies(300, 19);
+    proxies[7].bounds.minX = std::nan("");
+    std::vector<std::uint32_t> candidates(Narrowphase::MASK_BITS);
+    Narrowphase narrowphase;
+    narrowphase.SetBounds(proxies);
+    BOOST_TEST( (narrowphase.GetSimdLevel() <= Narrowphase::BestSimdLevel()) );
+    for (std::uint32_t box = 0; box < proxies.size(); box++)
+    {
+        for (std::size_t k = 0; k < candidates.size(); k++)
+        {
+            candidates[k] = static_cast<std::uint32_t>((box * 31 + k * 7) % proxies.size());
+        }
+
+        std::size_t count = box % (Narrowphase::MASK_BITS + 1);
+        std::uint32_t expected = 0;
+        for (std::size_t k = 0; k < count; k++)
+        {
+            expected |= static_cast<std::uint32_t>(proxies[box].bounds.Overlaps(proxies[candidates[k]].bounds)) << k;
+        }
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2})
+        {
+            narrowphase.SetSimdLevel(level);
+            BOOST_TEST( narrowphase.OverlapMask(box, candidates.data(), count) == expected );
+        }
+    }
+
+    // Does a run over candidate pairs keep exactly the overlapping ones?
+    SPDLOG_TRACE("Test Narrowphase Run");
+    BruteForceBroadphase brute;
+    std::vector<BroadphasePair> expected = OverlappingPairs(brute, proxies);
+    std::vector<BroadphasePair> pairs;
+    for (std::uint32_t first = 0; first < 100; first++)
+    {
+        for (std::uint32_t second = first + 1; second < proxies.size(); second++)
+        {
+            pairs.push_back({first, second});
+        }
+    }
+    std::vector<Contact> contacts;
+    narrowphase.Run(pairs, contacts);
+    std::size_t found = 0;
+    for (const Contact& contact : contacts)
+    {
+        BOOST_TEST( proxies[contact.first].bounds.Overlaps(proxies[contact.second].bounds) );
+        BOOST_TEST( contact.sides == CollisionSides(proxies[contact.first].bounds, proxies[contact.second].bounds) );
+        BOOST_TEST( contact.sides != 0 );
+        found++;
+    }
+    BOOST_TEST( found == static_cast<std::size_t>(std::count_if(expected.begin(), expected.end(),
+        [](const BroadphasePair& pair) { return pair.first < 100; })) );
+}
+
+// Sanity tests swapping the CollisionSystem's Broadphase
+BOOST_FIXTURE_TEST_CASE( CollisionBroadphase_Tests, Collision_Fixture )
+{
+    SPDLOG_TRACE("Test Broadphases Give Identical Collisions");
+    std::vector<Entity> entities;
+    for (const BroadphaseProxy& proxy : RandomProxies(400, 11))
+    {
+        entities.push_back(AddBox(proxy.bounds.minX, proxy.bounds.minY,
+            proxy.bounds.maxX - proxy.bounds.minX, proxy.bounds.maxY - proxy.bounds.minY));
+    }
+
+    auto snapshot = [&]()
+    {
+        std::vector<std::vector<std::pair<Entity, int>>> hits;
+        for (Entity e : entities)
+        {
+            hits.emplace_back();
+            for (const Collision& collision : system->ContactsOf(e))
+            {
+                hits.back().emplace_back(collision.ent_collided, collision.collision_pos);
+            }
+        }
+        return hits;
+    };
+
+    system->Update();
+    auto hashed = snapshot();
+    system->SetBroadphase(std::make_unique<BruteForceBroadphase>());
+    system->SetBroadphase(nullptr);
+    system->Update();
+    BOOST_TEST( (snapshot() == hashed) );
+    system->SetBroadphase(std::make_unique<AABBTreeBroadphase>());
+    system->Update();
+    BOOST_TEST( (snapshot() == hashed) );
+    system->SetBroadphase(std::make_unique<SweepAndPruneBroadphase>());
+    system->Update();
+    BOOST_TEST( (snapshot() == hashed) );
+}
+
+// Sanity tests for collision on several threads
+BOOST_FIXTURE_TEST_CASE( ParallelCollision_Tests, Collision_Fixture )
+{
+    SPDLOG_TRACE("Test Parallel Pair Search Matches FindPairs");
+    std::vector<BroadphaseProxy> proxies = RandomProxies(3000, 59);
+    SpatialHashBroadphase hash(16.0);
+    hash.Update(proxies);
+    std::vector<BroadphasePair> serial;
+    hash.FindPairs(serial);
+    BOOST_TEST( !serial.empty() );
+    for (std::size_t workers : {0, 1, 3})
+    {
+        ThreadPool pool(workers);
+        std::vector<BroadphasePair> parallel;
+        hash.ParallelFindPairs(pool, parallel);
+        BOOST_TEST( (parallel == serial) );
+    }
+
+    SPDLOG_TRACE("Test Collisions Don't Depend On Thread Count");
+    Coordinator* c = Coordinator::Get();
+    for (std::size_t i = 0; i < proxies.size(); i++)
+    {
+        const AABB& bounds = proxies[i].bounds;
+        Entity e = AddBox(bounds.minX, bounds.minY, bounds.maxX - bounds.minX, bounds.maxY - bounds.minY);
+        c->GetComponent<RectangleCollider>(e).isStatic = i % 5 == 0;
+    }
+
+    c->SetWorkerCount(0);
+    system->Update();
+    std::vector<Entity> owners = system->GetContacts().GetOwners();
+    std::vector<std::pair<Entity, int>> collisions;
+    for (const Collision& collision : system->GetContacts().GetCollisions())
+    {
+        collisions.emplace_back(collision.ent_collided, collision.collision_pos);
+    }
+    std::vector<CollisionEvent> entered = system->GetEnterEvents();
+    BOOST_TEST( collisions.size() > CollisionSystem::PAIRS_PER_TASK );
+
+    for (std::size_t workers : {1, 3})
+    {
+        c->SetWorkerCount(workers);
+        system->Update();
+        BOOST_TEST( (system->GetContacts().GetOwners() == owners) );
+        std::vector<std::pair<Entity, int>> found;
+        for (const Collision& collision : system->GetContacts().GetCollisions())
+        {
+            found.emplace_back(collision.ent_collided, collision.collision_pos);
+        }
+        BOOST_TEST( (found == collisions) );
+
+        // Every pair was already touching, and stays in the same order
+        BOOST_TEST( system->GetEnterEvents().empty() );
+        const std::vector<CollisionEvent>& stayed = system->GetStayEvents();
+        BOOST_REQUIRE( stayed.size() == entered.size() );
+        for (std::size_t i = 0; i < stayed.size(); i++)
+        {
+            BOOST_TEST( stayed[i].first == entered[i].first );
+            BOOST_TEST( stayed[i].second == entered[i].second );
+            BOOST_TEST( stayed[i].sides == entered[i].sides );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
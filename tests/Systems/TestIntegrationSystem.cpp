@@ -0,0 +1,125 @@
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <vector>
+
+#include <ECS/Roc_ECS.hpp>
+
+struct Integration_Fixture
+{
+    Integration_Fixture()
+    {
+        Coordinator* c = Coordinator::Get();
+        c->Init();
+        c->RegisterComponent<Transform>();
+        c->RegisterComponent<Velocity>();
+        c->RegisterComponent<Gravity>();
+        system = c->RegisterSystem<IntegrationSystem>();
+        c->SetSystemSignature<IntegrationSystem>(system->GetSignature());
+    }
+    ~Integration_Fixture()
+    {
+        Coordinator::DeleteCoordinator();
+    }
+
+    std::shared_ptr<IntegrationSystem> system;
+};
+
+BOOST_AUTO_TEST_SUITE( System_Tests )
+
+// Sanity tests for the IntegrationSystem
+BOOST_FIXTURE_TEST_CASE( IntegrationSystem_Tests, Integration_Fixture )
+{
+    SPDLOG_TRACE("Test Bodies Move With Their Velocity");
+    Coordinator* c = Coordinator::Get();
+    system->SetTimestep(0.5);
+    system->SetTimestep(0);
+    system->SetTimestep(std::nan(""));
+    BOOST_TEST( system->GetTimestep() == 0.5 );
+
+    Velocity v;
+    v.x = 2;
+    v.y = -4;
+    Entity drifting = c->CreateEntities(1, Transform(), v).front();
+    Gravity g;
+    g.gravity = 10;
+    Entity falling = c->CreateEntities(1, Transform(), Velocity(), g).front();
+    Entity still = c->CreateEntities(1, Transform(), g).front();
+    c->GetComponent<Transform>(still).y = 7;
+
+    system->Update();
+    BOOST_TEST( c->GetComponent<Transform>(drifting).x == 1 );
+    BOOST_TEST( c->GetComponent<Transform>(drifting).y == -2 );
+    BOOST_TEST( c->GetComponent<Velocity>(drifting).y == -4 );
+
+    // Semi-implicit: the velocity changes first, then moves the body
+    SPDLOG_TRACE("Test Gravity Pulls Down");
+    BOOST_TEST( c->GetComponent<Velocity>(falling).y == -5 );
+    BOOST_TEST( c->GetComponent<Transform>(falling).y == -2.5 );
+    system->Step();
+    BOOST_TEST( c->GetComponent<Velocity>(falling).y == -10 );
+    BOOST_TEST( c->GetComponent<Transform>(falling).y == -7.5 );
+    BOOST_TEST( c->GetComponent<Transform>(falling).x == 0 );
+    BOOST_TEST( c->GetComponent<Transform>(still).y == 7 );
+
+    SPDLOG_TRACE("Test Fixed Steps");
+    system->SetTimestep(0.25);
+    BOOST_TEST( system->Advance(0.625) == 2u );
+    BOOST_TEST( system->GetInterpolation() == 0.5 );
+    BOOST_TEST( system->Advance(0.125) == 1u );
+    BOOST_TEST( system->GetInterpolation() == 0.0 );
+    BOOST_TEST( system->Advance(-1) == 0u );
+    BOOST_TEST( system->Advance(std::nan("")) == 0u );
+    BOOST_TEST( c->GetComponent<Transform>(drifting).x == 3.5 );
+
+    // A long stall only catches up so far
+    BOOST_TEST( system->Advance(100.1) == IntegrationSystem::MAX_STEPS_PER_ADVANCE );
+    BOOST_TEST( system->GetInterpolation() >= 0.0 );
+    BOOST_TEST( system->GetInterpolation() < 1.0 );
+    BOOST_TEST( c->GetComponent<Transform>(drifting).x == 7.5 );
+
+    SPDLOG_TRACE("Test RunSystems Steps Once");
+    c->RunSystems();
+    BOOST_TEST( c->GetComponent<Transform>(drifting).x == 8 );
+}
+
+// Sanity tests for the batch kernels
+BOOST_AUTO_TEST_CASE( IntegrationKernels_Tests )
+{
+    SPDLOG_TRACE("Test Batches Match One Body At A Time");
+    Transform t;
+    BOOST_TEST( &t.y == &t.x + 1 );
+
+    std::vector<Transform> transforms(37);
+    std::vector<Velocity> velocities(37);
+    std::vector<Gravity> gravities(37);
+    for (std::size_t i = 0; i < transforms.size(); i++)
+    {
+        transforms[i].x = 0.1 * i;
+        transforms[i].y = -0.3 * i;
+        transforms[i].z = 5;
+        velocities[i].x = 1.0 / (i + 1);
+        velocities[i].y = 0.7 * i;
+        gravities[i].gravity = i % 2 == 0 ? 9.81 : 0;
+    }
+    std::vector<Transform> expected = transforms;
+    std::vector<Velocity> expectedVelocities = velocities;
+    const double dt = 1.0 / 60.0;
+    for (std::size_t i = 0; i < transforms.size(); i++)
+    {
+        expectedVelocities[i].y -= gravities[i].gravity * dt;
+        expected[i].x += expectedVelocities[i].x * dt;
+        expected[i].y += expectedVelocities[i].y * dt;
+    }
+
+    IntegrationSystem::ApplyGravity(velocities.data(), gravities.data(), velocities.size(), dt);
+    IntegrationSystem::ApplyVelocity(transforms.data(), velocities.data(), transforms.size(), dt);
+    for (std::size_t i = 0; i < transforms.size(); i++)
+    {
+        BOOST_TEST( velocities[i].y == expectedVelocities[i].y );
+        BOOST_TEST( transforms[i].x == expected[i].x );
+        BOOST_TEST( transforms[i].y == expected[i].y );
+        BOOST_TEST( transforms[i].z == 5 );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,4 +1,9 @@
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
 
 #include <ECS/Roc_ECS.hpp>
 
@@ -23,6 +28,60 @@ struct ECS_Fixture
     }
 };
 
+// Systems with declared accesses, for the scheduler tests
+struct ReadTransformSystem : public System
+{
+    std::atomic<int>* meeting = nullptr;
+    bool met = false;
+
+    void Update() override
+    {
+        // Wait (briefly) for another System to be running at the same time
+        if (meeting == nullptr) return;
+        (*meeting)++;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (*meeting < 2 && std::chrono::steady_clock::now() < deadline) {}
+        met = *meeting >= 2;
+    }
+    SystemAccess GetAccess() override
+    {
+        SystemAccess access;
+        access.reads.set(Coordinator::Get()->GetComponentType<Transform>());
+        return access;
+    }
+    Signature GetSignature() override { return Signature(); }
+};
+
+struct ReadTransformSystem2 : public ReadTransformSystem {};
+
+struct WriteTransformSystem : public System
+{
+    int runs = 0;
+
+    void Update() override
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        runs++;
+    }
+    SystemAccess GetAccess() override
+    {
+        SystemAccess access;
+        access.writes.set(Coordinator::Get()->GetComponentType<Transform>());
+        return access;
+    }
+    Signature GetSignature() override { return Signature(); }
+};
+
+struct WriteGravitySystem : public WriteTransformSystem
+{
+    SystemAccess GetAccess() override
+    {
+        SystemAccess access;
+        access.writes.set(Coordinator::Get()->GetComponentType<Gravity>());
+        return access;
+    }
+};
+
 // LOGGER TESTS
 
 BOOST_AUTO_TEST_SUITE( ECS_Tests )
@@ -61,6 +120,52 @@ BOOST_FIXTURE_TEST_CASE( EntityCommands_Tests, ECS_Fixture )
 }
 
 
+// Sanity tests generational Entity handles
+BOOST_FIXTURE_TEST_CASE( EntityHandle_Tests, ECS_Fixture )
+{
+    SPDLOG_TRACE("Test Living Entities Are Alive");
+    Coordinator* c = Coordinator::Get();
+    Entity e1 = c->GetEntity("test_ent");
+    Entity e2 = c->GetEntity("test_entity2");
+    BOOST_TEST( c->IsAlive(e1) );
+    BOOST_TEST( c->IsAlive(e2) );
+    BOOST_TEST( !c->IsAlive(MAX_ENTITIES) );
+
+    // Does a handle go stale once its Entity is destroyed?
+    SPDLOG_TRACE("Test Destroyed Entity Handle Is Stale");
+    c->AddComponent<Gravity>(e2, Gravity());
+    c->DestroyEntity("test_entity2");
+    BOOST_TEST( !c->IsAlive(e2) );
+    BOOST_TEST( c->TryGetComponent<Gravity>(e2) == nullptr );
+
+    // Does the stale handle stay stale once its index is reused?
+    SPDLOG_TRACE("Test Stale Handle After Index Reuse");
+    for (Entity i = 2; i < MAX_ENTITIES; i++)
+    {
+        c->CreateEntity("filler_" + std::to_string(i));
+    }
+    Entity reused = c->CreateEntity("reused");
+    BOOST_TEST( EntityIndex(reused) == EntityIndex(e2) );
+    BOOST_TEST( reused != e2 );
+    BOOST_TEST( c->IsAlive(reused) );
+    BOOST_TEST( !c->IsAlive(e2) );
+
+    // Do stale handles miss the new Entity's Components?
+    SPDLOG_TRACE("Test Stale Handle Can't Touch New Components");
+    Gravity g; g.gravity = 1.0;
+    BOOST_TEST( c->AddComponent<Gravity>(reused, g) );
+    BOOST_TEST( !c->AddComponent<Gravity>(e2, Gravity()) );
+    BOOST_TEST( c->TryGetComponent<Gravity>(e2) == nullptr );
+    BOOST_CHECK_THROW( c->GetComponent<Gravity>(e2), std::runtime_error );
+    BOOST_TEST( !c->RemoveComponent<Gravity>(e2) );
+    BOOST_TEST( fabs(c->TryGetComponent<Gravity>(reused)->gravity - 1.0) < EPSILON );
+
+    // Does TryGetComponent report missing and unregistered Components?
+    SPDLOG_TRACE("Test TryGetComponent Without Component");
+    BOOST_TEST( c->TryGetComponent<Transform>(reused) == nullptr );
+    BOOST_TEST( c->TryGetComponent<RectangleCollider>(reused) == nullptr );
+}
+
 // Sanity tests Component-related features of the ECS
 BOOST_FIXTURE_TEST_CASE( ComponentCommands_Tests, ECS_Fixture )
 {
@@ -80,6 +185,12 @@ BOOST_FIXTURE_TEST_CASE( ComponentCommands_Tests, ECS_Fixture )
     BOOST_CHECK_THROW( c->GetComponent<Gravity>(c->GetEntity("test_entity2")),
                        std::runtime_error );
 
+    // Do registered and unregistered components report the right type?
+    SPDLOG_TRACE("Test Component Types");
+    BOOST_TEST( c->GetComponentType<Gravity>() != c->GetComponentType<Transform>() );
+    BOOST_TEST( c->GetComponentType<Gravity>() < MAX_COMPONENTS );
+    BOOST_TEST( c->GetComponentType<RectangleCollider>() == MAX_COMPONENTS );
+
     // Does adding a component that doesn't exist (to any entity, real or not)
     // result in a fail?
     SPDLOG_TRACE("Test Add Unloaded Component to any Entity");
@@ -93,6 +204,126 @@ BOOST_FIXTURE_TEST_CASE( ComponentCommands_Tests, ECS_Fixture )
     BOOST_TEST( c->RemoveComponent<Gravity>(c->GetEntity("test_ent")) );
     BOOST_CHECK_THROW( c->GetComponent<Gravity>(c->GetEntity("test_ent")),
                        std::runtime_error );
+
+    // Does removing a component keep the other entities' components intact?
+    SPDLOG_TRACE("Test Removing Component Keeps Packed Components Intact");
+    Gravity g1; g1.gravity = 1.0;
+    Gravity g2; g2.gravity = 2.0;
+    Entity e3 = c->CreateEntity("test_entity3");
+    BOOST_TEST( c->AddComponent<Gravity>(c->GetEntity("test_ent"), g1) );
+    BOOST_TEST( c->AddComponent<Gravity>(c->GetEntity("test_entity2"), g2) );
+    BOOST_TEST( c->AddComponent<Gravity>(e3, Gravity()) );
+    BOOST_TEST( c->RemoveComponent<Gravity>(c->GetEntity("test_ent")) );
+    BOOST_TEST( fabs(c->GetComponent<Gravity>(c->GetEntity("test_entity2")).gravity - 2.0) < EPSILON );
+    BOOST_TEST( fabs(c->GetComponent<Gravity>(e3).gravity - 9.81) < EPSILON );
+    BOOST_TEST( !c->RemoveComponent<Gravity>(c->GetEntity("test_ent")) );
+
+    // Can a component's properties be set from text?
+    SPDLOG_TRACE("Test Set Component Property From Text");
+    BOOST_TEST( c->SetComponentPropertyFromText(e3, "Gravity", "gravity", Property(3.0)) );
+    BOOST_TEST( fabs(c->GetComponent<Gravity>(e3).gravity - 3.0) < EPSILON );
+    BOOST_TEST( !c->SetComponentPropertyFromText(e3, "Gravity", "DNE", Property(3.0)) );
+    BOOST_TEST( !c->SetComponentPropertyFromText(e3, "DNE", "gravity", Property(3.0)) );
+}
+
+// Sanity tests iterating Components through a View
+BOOST_FIXTURE_TEST_CASE( ViewCommands_Tests, ECS_Fixture )
+{
+    SPDLOG_TRACE("Test View Visits Only Entities With Every Component");
+    Coordinator* c = Coordinator::Get();
+    Entity e1 = c->GetEntity("test_ent");
+    Entity e2 = c->GetEntity("test_entity2");
+    Entity e3 = c->CreateEntity("test_entity3");
+    c->AddComponent<Transform>(e1, Transform());
+    c->AddComponent<Transform>(e2, Transform());
+    c->AddComponent<Transform>(e3, Transform());
+    c->AddComponent<Gravity>(e3, Gravity());
+
+    int visited = 0;
+    c->View<Transform, Gravity>().ForEach([&](Entity e, Transform& t, Gravity& g)
+    {
+        BOOST_TEST( (e == e1 || e == e3) );
+        t.y -= g.gravity;
+        visited++;
+    });
+    BOOST_TEST( visited == 2 );
+    BOOST_TEST( fabs(c->GetComponent<Transform>(e3).y + 9.81) < EPSILON );
+    BOOST_TEST( fabs(c->GetComponent<Transform>(e2).y) < EPSILON );
+
+    SPDLOG_TRACE("Test View Over Unregistered Component Is Empty");
+    visited = 0;
+    c->View<Transform, RectangleCollider>().ForEach([&](Entity, Transform&, RectangleCollider&) { visited++; });
+    BOOST_TEST( visited == 0 );
+}
+
+// Sanity tests the archetype storage backend on its own
+BOOST_AUTO_TEST_CASE( ArchetypeManager_Tests )
+{
+    SPDLOG_TRACE("Test Archetype Components Survive Table Moves");
+    ArchetypeManager m;
+    BOOST_TEST( m.RegisterComponent<Transform>() );
+    BOOST_TEST( m.RegisterComponent<Gravity>() );
+    BOOST_TEST( !m.RegisterComponent<Gravity>() );
+
+    for (Entity e = 0; e < 3; e++)
+    {
+        Transform t; t.x = e;
+        BOOST_TEST( m.AddComponent<Transform>(e, t) );
+    }
+    Gravity g; g.gravity = 2.0;
+    BOOST_TEST( m.AddComponent<Gravity>(0, g) );
+    BOOST_TEST( !m.AddComponent<Gravity>(0, g) );
+    BOOST_TEST( m.GetComponent<Transform>(0).x == 0.0 );
+    BOOST_TEST( m.GetComponent<Gravity>(0).gravity == 2.0 );
+    BOOST_TEST( m.GetComponent<Transform>(2).x == 2.0 );
+
+    SPDLOG_TRACE("Test Archetype View Visits Matching Tables");
+    int visited = 0;
+    m.View<Transform>(nullptr).ForEach([&](Entity, Transform&) { visited++; });
+    BOOST_TEST( visited == 3 );
+    visited = 0;
+    m.View<Transform, Gravity>(nullptr).ForEach([&](Entity e, Transform&, Gravity&) { BOOST_TEST( e == 0 ); visited++; });
+    BOOST_TEST( visited == 1 );
+
+    SPDLOG_TRACE("Test Archetype Remove and Destroy");
+    BOOST_TEST( m.RemoveComponent<Transform>(0) );
+    BOOST_TEST( !m.RemoveComponent<Transform>(0) );
+    BOOST_TEST( m.GetComponent<Gravity>(0).gravity == 2.0 );
+    BOOST_CHECK_THROW( m.GetComponent<Transform>(0), std::runtime_error );
+    m.EntityDestroyed(1);
+    BOOST_CHECK_THROW( m.GetComponent<Transform>(1), std::runtime_error );
+    BOOST_TEST( m.GetComponent<Transform>(2).x == 2.0 );
+}
+
+// Sanity tests the container Systems keep their Entities in
+BOOST_AUTO_TEST_CASE( EntitySet_Tests )
+{
+    SPDLOG_TRACE("Test EntitySet Insert/Erase");
+    EntitySet set;
+    BOOST_TEST( set.insert(7) );
+    BOOST_TEST( set.insert(3) );
+    BOOST_TEST( set.insert(4000) );
+    BOOST_TEST( !set.insert(3) );
+    BOOST_TEST( set.size() == 3 );
+    BOOST_TEST( set.erase(7) == 1 );
+    BOOST_TEST( set.erase(7) == 0 );
+    BOOST_TEST( !set.contains(7) );
+    BOOST_TEST( set.contains(3) );
+    BOOST_TEST( set.contains(4000) );
+
+    SPDLOG_TRACE("Test EntitySet Ordering by Another Set");
+    SparseSet order;
+    order.Insert(4000);
+    order.Insert(3);
+    set.SortBy(order);
+    BOOST_TEST( set[0] == 4000 );
+    BOOST_TEST( set[1] == 3 );
+    BOOST_TEST( set.erase(4000) == 1 );
+    BOOST_TEST( set[0] == 3 );
+
+    set.clear();
+    BOOST_TEST( set.empty() );
+    BOOST_TEST( !set.contains(3) );
 }
 
 BOOST_FIXTURE_TEST_CASE( SystemCommands_Tests, ECS_Fixture )
@@ -119,8 +350,372 @@ BOOST_FIXTURE_TEST_CASE( SystemCommands_Tests, ECS_Fixture )
     BOOST_CHECK_NO_THROW( c->AddComponent<RectangleCollider>(c->GetEntity("test_ent"), RectangleCollider()) );
     BOOST_CHECK_NO_THROW( c->AddComponent<Transform>(c->GetEntity("test_ent"), Transform()) );
     BOOST_CHECK( c->GetSystem<CollisionSystem>()->mEntities.size() == 1 );
+
+    // Does a System with a Signature only pick up entities that match it?
+    SPDLOG_TRACE("Test System Signature Filters Entities");
+    BOOST_TEST( c->SetSystemSignature<CollisionSystem>(sysptr->GetSignature()) );
+    BOOST_CHECK_NO_THROW( c->AddComponent<Transform>(c->GetEntity("test_entity2"), Transform()) );
+    BOOST_CHECK( c->GetSystem<CollisionSystem>()->mEntities.size() == 1 );
+    BOOST_TEST( c->RemoveComponent<Gravity>(c->GetEntity("test_ent")) );
+    BOOST_CHECK( c->GetSystem<CollisionSystem>()->mEntities.size() == 1 );
+    BOOST_TEST( c->RemoveComponent<Transform>(c->GetEntity("test_ent")) );
+    BOOST_CHECK( c->GetSystem<CollisionSystem>()->mEntities.size() == 0 );
+
+    // Does destroying an entity remove it from the System?
+    SPDLOG_TRACE("Test Destroying Entity Removes it from System");
+    BOOST_CHECK_NO_THROW( c->AddComponent<Transform>(c->GetEntity("test_ent"), Transform()) );
+    BOOST_CHECK( c->GetSystem<CollisionSystem>()->mEntities.size() == 1 );
+    c->DestroyEntity("test_ent");
+    BOOST_CHECK( c->GetSystem<CollisionSystem>()->mEntities.size() == 0 );
+}
+
+// Sanity tests creating and destroying Entities in batches
+BOOST_FIXTURE_TEST_CASE( BatchEntity_Tests, ECS_Fixture )
+{
+    SPDLOG_TRACE("Test Batch Created Entities Get Prototype Components");
+    Coordinator* c = Coordinator::Get();
+    BOOST_CHECK_THROW( c->CreateEntities(1, RectangleCollider()), std::runtime_error );
+    BOOST_TEST( c->RegisterComponent<RectangleCollider>() );
+    auto sysptr = c->RegisterSystem<CollisionSystem>();
+    BOOST_TEST( c->SetSystemSignature<CollisionSystem>(sysptr->GetSignature()) );
+
+    Gravity g; g.gravity = 2.0;
+    std::vector<Entity> wave = c->CreateEntities(100, Transform(), RectangleCollider(), g);
+    BOOST_TEST( wave.size() == 100 );
+    BOOST_TEST( c->IsAlive(wave.back()) );
+    BOOST_TEST( fabs(c->GetComponent<Gravity>(wave[42]).gravity - 2.0) < EPSILON );
+    BOOST_TEST( c->TryGetComponent<Transform>(wave[99]) != nullptr );
+
+    // Are batch created Entities picked up by matching Systems only?
+    SPDLOG_TRACE("Test Batch Created Entities Join Systems");
+    BOOST_TEST( sysptr->mEntities.size() == 100 );
+    std::vector<Entity> plain = c->CreateEntities(10, Transform());
+    BOOST_TEST( plain.size() == 10 );
+    BOOST_TEST( sysptr->mEntities.size() == 100 );
+    BOOST_TEST( c->CreateEntities(5).size() == 5 );
+
+    // Do batch created Entities behave like any other?
+    SPDLOG_TRACE("Test Batch Created Entities Take Single Changes");
+    BOOST_TEST( c->AddComponent<RectangleCollider>(plain[0], RectangleCollider()) );
+    BOOST_TEST( sysptr->mEntities.size() == 101 );
+    BOOST_TEST( c->RemoveComponent<Transform>(wave[0]) );
+    BOOST_TEST( sysptr->mEntities.size() == 100 );
+
+    // Does the batch fail as a whole past the Entity limit?
+    SPDLOG_TRACE("Test Batch Creation Past Entity Limit");
+    BOOST_TEST( c->CreateEntities(MAX_ENTITIES).empty() );
+
+    // Does destroying a batch remove its Entities everywhere?
+    SPDLOG_TRACE("Test Batch Destroy");
+    std::vector<Entity> half(wave.begin(), wave.begin() + 50);
+    half.push_back(half.front());
+    c->DestroyEntities(half);
+    BOOST_TEST( !c->IsAlive(wave[0]) );
+    BOOST_TEST( c->IsAlive(wave[50]) );
+    BOOST_TEST( sysptr->mEntities.size() == 51 );
+    BOOST_TEST( c->TryGetComponent<Gravity>(wave[10]) == nullptr );
+    BOOST_TEST( fabs(c->GetComponent<Gravity>(wave[60]).gravity - 2.0) < EPSILON );
+
+    // Does destroying everything leave room to fill the world again?
+    SPDLOG_TRACE("Test Destroy All Then Refill");
+    c->DestroyAllEntities();
+    BOOST_TEST( sysptr->mEntities.size() == 0 );
+    BOOST_TEST( !c->IsAlive(wave[99]) );
+    BOOST_TEST( c->CreateEntities(MAX_ENTITIES, Transform()).size() == MAX_ENTITIES );
+}
+
+
+// Sanity tests clearing the whole world at once
+BOOST_FIXTURE_TEST_CASE( WorldClear_Tests, ECS_Fixture )
+{
+    SPDLOG_TRACE("Test Destroy All Empties Components and Systems");
+    Coordinator* c = Coordinator::Get();
+    BOOST_TEST( c->RegisterComponent<RectangleCollider>() );
+    auto sysptr = c->RegisterSystem<CollisionSystem>();
+    BOOST_TEST( c->SetSystemSignature<CollisionSystem>(sysptr->GetSignature()) );
+    Entity named = c->GetEntity("test_ent");
+    std::vector<Entity> level = c->CreateEntities(MAX_ENTITIES - 2, Transform(), RectangleCollider());
+    BOOST_TEST( level.size() == MAX_ENTITIES - 2 );
+
+    c->DestroyAllEntities();
+    BOOST_TEST( sysptr->mEntities.empty() );
+    BOOST_TEST( !c->IsAlive(named) );
+    BOOST_TEST( !c->IsAlive(level.back()) );
+    BOOST_TEST( c->GetEntity("test_ent") == MAX_ENTITIES );
+    BOOST_TEST( c->TryGetComponent<Gravity>(named) == nullptr );
+    std::size_t visited = 0;
+    c->View<Transform>().ForEach([&](Entity, Transform&) { visited++; });
+    BOOST_TEST( visited == 0 );
+
+    // Can a cleared world be filled all the way up again?
+    SPDLOG_TRACE("Test Refilling a Cleared World");
+    Entity first = c->CreateEntity("test_ent");
+    BOOST_TEST( EntityIndex(first) == EntityIndex(named) );
+    BOOST_TEST( first != named );
+    BOOST_TEST( c->AddComponent<Transform>(first, Transform()) );
+    BOOST_TEST( c->AddComponent<RectangleCollider>(first, RectangleCollider()) );
+    BOOST_TEST( sysptr->mEntities.size() == 1 );
+    BOOST_TEST( c->CreateEntities(MAX_ENTITIES - 1, Gravity()).size() == MAX_ENTITIES - 1 );
+    BOOST_TEST( c->CreateEntity("one_too_many") == MAX_ENTITIES );
 }
 
+// Sanity tests deferring structural changes through a CommandBuffer
+BOOST_FIXTURE_TEST_CASE( CommandBuffer_Tests, ECS_Fixture )
+{
+    SPDLOG_TRACE("Test Commands Recorded During Iteration Wait For Sync");
+    Coordinator* c = Coordinator::Get();
+    BOOST_TEST( c->RegisterComponent<RectangleCollider>() );
+    auto sysptr = c->RegisterSystem<CollisionSystem>();
+    BOOST_TEST( c->SetSystemSignature<CollisionSystem>(sysptr->GetSignature()) );
+    Entity e1 = c->GetEntity("test_ent");
+    Entity e2 = c->GetEntity("test_entity2");
+    c->AddComponent<Transform>(e1, Transform());
+    c->AddComponent<Transform>(e2, Transform());
 
+    CommandBuffer commands;
+    BOOST_TEST( commands.Empty() );
+    Entity spawned = MAX_ENTITIES;
+    c->View<Transform>().ForEach([&](Entity e, Transform&)
+    {
+        commands.AddComponent<RectangleCollider>(e, RectangleCollider());
+        if (e == e2)
+        {
+            commands.DestroyEntity(e);
+            spawned = commands.CreateEntity();
+            commands.AddComponent<Gravity>(spawned, Gravity());
+        }
+    });
+    BOOST_TEST( !commands.Empty() );
+    BOOST_TEST( CommandBuffer::IsPlaceholder(spawned) );
+    BOOST_TEST( !c->IsAlive(spawned) );
+    BOOST_TEST( c->IsAlive(e2) );
+    BOOST_TEST( sysptr->mEntities.size() == 0 );
+
+    // Does applying the buffer make every change and update Systems?
+    SPDLOG_TRACE("Test Applying Commands");
+    c->ApplyCommands(commands);
+    BOOST_TEST( commands.Empty() );
+    BOOST_TEST( !c->IsAlive(e2) );
+    BOOST_TEST( c->TryGetComponent<RectangleCollider>(e1) != nullptr );
+    BOOST_TEST( sysptr->mEntities.size() == 1 );
+    BOOST_TEST( sysptr->mEntities.contains(e1) );
+    std::size_t gravities = 0;
+    c->View<Gravity>().ForEach([&](Entity, Gravity&) { gravities++; });
+    BOOST_TEST( gravities == 2 );
+
+    // Do commands apply in the order recorded, and bad commands get skipped?
+    SPDLOG_TRACE("Test Command Order and Failed Commands");
+    Transform moved;
+    moved.x = 5;
+    commands.AddComponent<Gravity>(e1, Gravity());
+    commands.RemoveComponent<RectangleCollider>(e1);
+    commands.AddComponent<Gravity>(e2, Gravity());
+    commands.RemoveComponent<Transform>(e1);
+    commands.AddComponent<Transform>(e1, moved);
+    commands.RemoveComponent<Gravity>(e1);
+    BOOST_CHECK_NO_THROW( c->ApplyCommands(commands) );
+    BOOST_TEST( c->TryGetComponent<RectangleCollider>(e1) == nullptr );
+    BOOST_TEST( c->TryGetComponent<Transform>(e1) != nullptr );
+    BOOST_TEST( c->GetComponent<Transform>(e1).x == 5 );
+    BOOST_TEST( c->TryGetComponent<Gravity>(e1) == nullptr );
+    BOOST_TEST( sysptr->mEntities.size() == 0 );
+
+    // Can several threads record into one buffer at once?
+    SPDLOG_TRACE("Test Recording From Several Threads");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&commands]()
+        {
+            for (int i = 0; i < 100; i++)
+            {
+                Entity e = commands.CreateEntity();
+                commands.AddComponent<Transform>(e, Transform());
+                commands.AddComponent<RectangleCollider>(e, RectangleCollider());
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    c->ApplyCommands(commands);
+    BOOST_TEST( sysptr->mEntities.size() == 400 );
+}
+
+// Sanity tests the ThreadPool and TaskGroup
+BOOST_AUTO_TEST_CASE( ThreadPool_Tests )
+{
+    SPDLOG_TRACE("Test TaskGroup Runs Every Task");
+    ThreadPool pool(3);
+    BOOST_TEST( pool.Concurrency() == 4 );
+    std::atomic<int> count{0};
+    {
+        TaskGroup group(pool);
+        for (int i = 0; i < 1000; i++)
+        {
+            group.Run([&count]() { count++; });
+        }
+        group.Wait();
+    }
+    BOOST_TEST( count == 1000 );
+
+    // Can tasks wait on tasks of their own without deadlocking?
+    SPDLOG_TRACE("Test Nested TaskGroups");
+    count = 0;
+    TaskGroup outer(pool);
+    for (int i = 0; i < 8; i++)
+    {
+        outer.Run([&pool, &count]()
+        {
+            TaskGroup inner(pool);
+            for (int j = 0; j < 8; j++)
+            {
+                inner.Run([&count]() { count++; });
+            }
+            inner.Wait();
+        });
+    }
+    outer.Wait();
+    BOOST_TEST( count == 64 );
+
+    // Do exceptions thrown by tasks come back from Wait()?
+    SPDLOG_TRACE("Test TaskGroup Rethrows");
+    TaskGroup failing(pool);
+    failing.Run([]() { throw std::runtime_error("task failed"); });
+    BOOST_CHECK_THROW( failing.Wait(), std::runtime_error );
+
+    // Does a pool without workers run tasks on the waiting thread?
+    SPDLOG_TRACE("Test ThreadPool Without Workers");
+    ThreadPool inline_pool(0);
+    TaskGroup group(inline_pool);
+    group.Run([&count]() { count = -1; });
+    group.Wait();
+    BOOST_TEST( count == -1 );
+}
+
+// Sanity tests running Systems through the scheduler
+BOOST_FIXTURE_TEST_CASE( SystemScheduler_Tests, ECS_Fixture )
+{
+    SPDLOG_TRACE("Test Scheduler Orders Conflicting Systems");
+    Coordinator* c = Coordinator::Get();
+    c->SetWorkerCount(2);
+    auto read1 = c->RegisterSystem<ReadTransformSystem>();
+    auto write = c->RegisterSystem<WriteTransformSystem>();
+    auto read2 = c->RegisterSystem<ReadTransformSystem2>();
+    auto gravity = c->RegisterSystem<WriteGravitySystem>();
+    c->RunSystems();
+    BOOST_TEST( write->runs == 1 );
+    BOOST_TEST( (c->SystemDependsOn<WriteTransformSystem, ReadTransformSystem>()) );
+    BOOST_TEST( (c->SystemDependsOn<ReadTransformSystem2, WriteTransformSystem>()) );
+    BOOST_TEST( !(c->SystemDependsOn<ReadTransformSystem2, ReadTransformSystem>()) );
+    BOOST_TEST( !(c->SystemDependsOn<WriteGravitySystem, WriteTransformSystem>()) );
+
+    // Do explicit orderings add edges without flipping unrelated conflicts, and are cycles refused?
+    SPDLOG_TRACE("Test Explicit System Ordering");
+    BOOST_TEST( (c->AddSystemOrdering<WriteGravitySystem, ReadTransformSystem>()) );
+    BOOST_TEST( !(c->AddSystemOrdering<ReadTransformSystem, WriteGravitySystem>()) );
+    c->RunSystems();
+    BOOST_TEST( (c->SystemDependsOn<ReadTransformSystem, WriteGravitySystem>()) );
+    BOOST_TEST( (c->SystemDependsOn<WriteTransformSystem, ReadTransformSystem>()) );
+    BOOST_TEST( !(c->SystemDependsOn<ReadTransformSystem, WriteTransformSystem>()) );
+    BOOST_TEST( (c->SystemDependsOn<ReadTransformSystem2, WriteTransformSystem>()) );
+
+    // Do Systems that don't conflict actually run at the same time?
+    SPDLOG_TRACE("Test Non-Conflicting Systems Run Concurrently");
+    std::atomic<int> meeting{0};
+    read1->meeting = &meeting;
+    read2->meeting = &meeting;
+    BOOST_TEST( (c->AddSystemOrdering<WriteTransformSystem, WriteGravitySystem>()) );
+    c->RunSystems();
+    BOOST_TEST( read1->met );
+    BOOST_TEST( read2->met );
+    read1->meeting = nullptr;
+    read2->meeting = nullptr;
+
+    // Are frame and per-System timings recorded?
+    SPDLOG_TRACE("Test System Timings");
+    c->RunSystems();
+    BOOST_TEST( (c->GetSystemTime<WriteTransformSystem>() >= std::chrono::milliseconds(1)) );
+    BOOST_TEST( (c->GetFrameTimings().frame >= c->GetSystemTime<WriteGravitySystem>()) );
+    BOOST_TEST( c->GetFrameTimings().systems.size() == 4 );
+    BOOST_TEST( gravity->runs == 4 );
+}
+
+// Sanity tests for chunked parallel iteration
+BOOST_FIXTURE_TEST_CASE( ParallelForEach_Tests, ECS_Fixture )
+{
+    SPDLOG_TRACE("Test ParallelForEach Visits Every Entity Once");
+    Coordinator* c = Coordinator::Get();
+    c->SetWorkerCount(3);
+    Gravity g;
+    std::vector<Entity> wave = c->CreateEntities(3000, Transform(), g);
+    std::vector<std::atomic<int>> visits(MAX_ENTITIES);
+    c->ParallelForEach<Transform, Gravity>([&visits](Entity e, Transform& t, Gravity&)
+    {
+        visits[EntityIndex(e)]++;
+        t.x = 1;
+    }, 100);
+    for (Entity e : wave)
+    {
+        BOOST_TEST( visits[EntityIndex(e)] == 1 );
+        BOOST_TEST( c->GetComponent<Transform>(e).x == 1 );
+    }
+    BOOST_TEST( visits[EntityIndex(c->GetEntity("test_ent"))] == 0 );
+
+    // Are chunks whole cache lines, and the same whatever the thread count?
+    SPDLOG_TRACE("Test ParallelFor Chunk Boundaries");
+    BOOST_TEST( (CacheLineElements<Entity, Transform>()) == 16 );
+    BOOST_TEST( AlignGrain(100, 16) == 112 );
+    BOOST_TEST( AlignGrain(0, 16) == 16 );
+    for (std::size_t workers : {0, 1, 3})
+    {
+        ThreadPool pool(workers);
+        std::mutex mutex;
+        std::vector<std::pair<std::size_t, std::size_t>> chunks;
+        ParallelFor(pool, 1000, 112, [&](std::size_t begin, std::size_t end)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            chunks.emplace_back(begin, end);
+        });
+        std::sort(chunks.begin(), chunks.end());
+        BOOST_TEST( chunks.size() == 9 );
+        BOOST_TEST( chunks.front().second == 112 );
+        BOOST_TEST( chunks.back().first == 896 );
+        BOOST_TEST( chunks.back().second == 1000 );
+    }
+
+    SPDLOG_TRACE("Test ParallelCollect Keeps Results In Order");
+    std::vector<std::size_t> expected;
+    for (std::size_t i = 0; i < 1000; i++)
+    {
+        if (i % 3 != 0)
+        {
+            expected.push_back(i);
+        }
+    }
+    for (std::size_t workers : {0, 1, 3})
+    {
+        ThreadPool pool(workers);
+        std::vector<std::vector<std::size_t>> buffers;
+        std::vector<std::size_t> results{7};
+        ParallelCollect(pool, 1000, 64, buffers, results,
+            [](std::size_t begin, std::size_t end, std::vector<std::size_t>& found)
+            {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    if (i % 3 != 0)
+                    {
+                        found.push_back(i);
+                    }
+                }
+            });
+        BOOST_REQUIRE( results.size() == expected.size() + 1 );
+        BOOST_TEST( results.front() == 7u );
+        BOOST_TEST( std::equal(expected.begin(), expected.end(), results.begin() + 1) );
+        BOOST_TEST( std::all_of(buffers.begin(), buffers.end(),
+            [](const std::vector<std::size_t>& buffer) { return buffer.empty(); }) );
+    }
+}
 
 BOOST_AUTO_TEST_SUITE_END()